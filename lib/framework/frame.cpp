@@ -46,6 +46,7 @@
  */
 
 static bool mousewarp = false;
+static HEADLESS_MODE headlessMode = HEADLESS_OFF;
 
 uint32_t selectedPlayer = 0;  /**< Current player */
 uint32_t realSelectedPlayer = 0;
@@ -144,6 +145,16 @@ bool getMouseWarp()
 	return mousewarp;
 }
 
+void setHeadlessMode(HEADLESS_MODE mode)
+{
+	headlessMode = mode;
+}
+
+HEADLESS_MODE getHeadlessMode()
+{
+	return headlessMode;
+}
+
 PHYSFS_file* openLoadFile(const char* fileName, bool hard_fail)
 {
 	PHYSFS_file* fileHandle = PHYSFS_openRead(fileName);
@@ -119,6 +119,24 @@ extern int getFramerateLimit(void);
  */
 extern void frameUpdate(void);
 
+/// Ways to run without a window, graphics or sound, such as for dedicated servers and AI games.
+enum HEADLESS_MODE
+{
+	HEADLESS_OFF,       ///< Normal game, with a window.
+	HEADLESS_REALTIME,  ///< No window, and the game time runs at real time.
+	HEADLESS_FAST       ///< No window, and the game ticks as fast as possible.
+};
+
+/** Set by the backend before creating the window, since it must know whether to create one. */
+extern void setHeadlessMode(HEADLESS_MODE mode);
+extern HEADLESS_MODE getHeadlessMode(void);
+
+/** Returns true if there is no window, so nothing must be drawn. */
+static inline bool isHeadless(void)
+{
+	return getHeadlessMode() != HEADLESS_OFF;
+}
+
 /** Returns the current frame we're on - used to establish whats on screen. */
 extern UDWORD frameGetFrameNumber(void);
 
@@ -0,0 +1,139 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2013  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include <stdlib.h>
+
+/* Allow frame header files to be singly included */
+#define FRAME_LIB_INCLUDE
+
+#include "types.h"
+#include "debug.h"
+#include "objectpool.h"
+
+#include <algorithm>
+#include <new>
+
+// Slots are a multiple of this, so that each object is as aligned as memory from malloc would be.
+static const size_t slotAlignment = 16;
+
+ObjectPool *ObjectPool::firstPool = NULL;
+
+ObjectPool::ObjectPool(char const *name, size_t objectSize, unsigned objectsPerSlab_)
+	: poolName(name)
+	, slotSize((std::max(objectSize, sizeof(FreeObject)) + slotAlignment - 1) & ~(slotAlignment - 1))
+	, objectsPerSlab(std::max(objectsPerSlab_, 1u))
+	, freeList(NULL)
+	, live(0)
+	, peak(0)
+	, nextPool(firstPool)
+{
+	// Pools are usually static, and constructed before main, so must not use the debug system here.
+	firstPool = this;
+}
+
+ObjectPool::~ObjectPool()
+{
+	for (ObjectPool **pool = &firstPool; *pool != NULL; pool = &(*pool)->nextPool)
+	{
+		if (*pool == this)
+		{
+			*pool = nextPool;
+			break;
+		}
+	}
+	for (unsigned n = 0; n < slabs.size(); ++n)
+	{
+		::free(slabs[n]);
+	}
+	for (unsigned n = 0; n < oversized.size(); ++n)
+	{
+		::free(oversized[n]);
+	}
+}
+
+void ObjectPool::addSlab()
+{
+	char *slab = (char *)malloc(slotSize*objectsPerSlab);
+	if (slab == NULL)
+	{
+		debug(LOG_FATAL, "Out of memory allocating %u objects for the %s pool.", objectsPerSlab, poolName);
+		throw std::bad_alloc();
+	}
+	slabs.push_back(slab);
+
+	// Link the new slots in address order, so that objects allocated together are next to each other in memory.
+	for (unsigned n = objectsPerSlab; n-- > 0; )
+	{
+		FreeObject *object = (FreeObject *)(slab + n*slotSize);
+		object->next = freeList;
+		freeList = object;
+	}
+}
+
+void *ObjectPool::allocate(size_t size)
+{
+	if (size > slotSize)
+	{
+		// Probably a class derived from the pooled one, without a pool of its own. Still give it enough memory.
+		ASSERT(false, "Allocating %u bytes from the %s pool, which only has %u byte slots.", (unsigned)size, poolName, (unsigned)slotSize);
+		void *object = malloc(size);
+		if (object == NULL)
+		{
+			debug(LOG_FATAL, "Out of memory allocating a %u byte object for the %s pool.", (unsigned)size, poolName);
+			throw std::bad_alloc();
+		}
+		oversized.push_back(object);
+		++live;
+		peak = std::max(peak, live);
+		return object;
+	}
+	if (freeList == NULL)
+	{
+		addSlab();
+	}
+	FreeObject *object = freeList;
+	freeList = object->next;
+	++live;
+	peak = std::max(peak, live);
+	return object;
+}
+
+void ObjectPool::free(void *object)
+{
+	if (object == NULL)
+	{
+		return;
+	}
+	ASSERT_OR_RETURN(, live != 0, "Freeing more objects than were allocated from the %s pool.", poolName);
+	if (!oversized.empty())
+	{
+		std::vector<void *>::iterator i = std::find(oversized.begin(), oversized.end(), object);
+		if (i != oversized.end())
+		{
+			oversized.erase(i);
+			::free(object);
+			--live;
+			return;
+		}
+	}
+	FreeObject *freeObject = (FreeObject *)object;
+	freeObject->next = freeList;
+	freeList = freeObject;
+	--live;
+}
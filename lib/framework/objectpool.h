@@ -0,0 +1,75 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2013  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Fixed size object pools.
+ */
+
+#ifndef __INCLUDED_LIB_FRAMEWORK_OBJECTPOOL_H__
+#define __INCLUDED_LIB_FRAMEWORK_OBJECTPOOL_H__
+
+#include "types.h"
+
+#include <vector>
+
+/// Hands out memory for objects of a single type. Memory is taken from the system a slab of many objects at a time, freed objects
+/// go on a free list to be reused, and slabs are only returned to the system when the pool is destroyed, so objects never move.
+/// Not thread safe, use each pool from one thread only.
+class ObjectPool
+{
+public:
+	ObjectPool(char const *name, size_t objectSize, unsigned objectsPerSlab = 256);
+	~ObjectPool();
+
+	void *allocate(size_t size);  ///< Returns memory for one object, size should be at most the objectSize given to the constructor.
+	void free(void *object);      ///< Puts the object back on the free list, does nothing if object is NULL.
+
+	char const *name() const { return poolName; }
+	unsigned liveCount() const { return live; }  ///< Number of objects currently allocated.
+	unsigned peakCount() const { return peak; }  ///< Highest number of objects allocated at once.
+	unsigned capacity() const { return slabs.size()*objectsPerSlab; }
+
+	/// All pools in existence, for showing statistics.
+	static ObjectPool *first() { return firstPool; }
+	ObjectPool *next() const { return nextPool; }
+
+private:
+	ObjectPool(ObjectPool const &);             // Non-copyable.
+	ObjectPool &operator =(ObjectPool const &);  // Non-copyable.
+
+	void addSlab();
+
+	struct FreeObject
+	{
+		FreeObject *next;
+	};
+
+	char const *poolName;
+	size_t slotSize;
+	unsigned objectsPerSlab;
+	std::vector<char *> slabs;
+	std::vector<void *> oversized;  ///< Objects too big for a slot, which were allocated with malloc instead.
+	FreeObject *freeList;
+	unsigned live;
+	unsigned peak;
+
+	ObjectPool *nextPool;
+	static ObjectPool *firstPool;
+};
+
+#endif // __INCLUDED_LIB_FRAMEWORK_OBJECTPOOL_H__
@@ -25,11 +25,495 @@
 // Get platform defines before checking for them.
 // Qt headers MUST come before platform specific stuff!
 #include "wzconfig.h"
+#include "crc.h"
+#include "wzapp.h"
 
-WzConfig::WzConfig(const QString &name, WzConfig::warning warning, QObject *parent)
-	: WzConfigHack(name, (int)warning), m_settings(QString("wz::") + name, QSettings::IniFormat, parent), m_overrides()
+#include <QtCore/QBuffer>
+#include <QtCore/QDataStream>
+#include <deque>
+
+// Binary files start with binaryMagic and the version, followed by one chunk per group. Each chunk is stored as its size and CRC, followed by the
+// group name, the number of keys and the keys and values, all written with QDataStream. Chunks with a bad CRC are skipped, instead of failing the whole file.
+// In compressed files, written by the background thread, each chunk is compressed with qCompress before taking the CRC.
+// In typed files, names are stored as UTF-8, and each value as a BinaryValueType followed by the value, so that numbers and vectors are stored as
+// numbers. Older files stored names as QStrings and values as QVariants, with vectors as lists of strings, and can still be read.
+static const char binaryMagic[8] = {'W', 'Z', 'B', 'I', 'N', 'C', 'F', 'G'};
+static const quint32 variantBinaryVersion = 1;
+static const quint32 compressedVariantBinaryVersion = 2;
+static const quint32 binaryVersion = 3;
+static const quint32 compressedBinaryVersion = 4;
+static const QDataStream::Version binaryStreamVersion = QDataStream::Qt_4_6;
+
+enum BinaryValueType
+{
+	BINARY_VARIANT,     ///< Anything else, as a QVariant.
+	BINARY_INT,         ///< qint32.
+	BINARY_UINT,        ///< quint32.
+	BINARY_LONGLONG,    ///< qint64.
+	BINARY_DOUBLE,      ///< double.
+	BINARY_BOOL,        ///< quint8.
+	BINARY_STRING,      ///< UTF-8 QByteArray.
+	BINARY_STRINGLIST,  ///< quint32 count, followed by UTF-8 QByteArrays.
+	BINARY_VECTOR2I,    ///< 2 qint32s.
+	BINARY_VECTOR3I,    ///< 3 qint32s.
+	BINARY_VECTOR3F     ///< 3 floats.
+};
+
+static void writeBinaryName(QDataStream &out, const QString &name)
+{
+	out << name.toUtf8();
+}
+
+static QString readBinaryName(QDataStream &in)
+{
+	QByteArray utf8;
+	in >> utf8;
+	return QString::fromUtf8(utf8.constData(), utf8.size());
+}
+
+static void writeBinaryValue(QDataStream &out, const QVariant &value)
+{
+	int type = value.userType();
+	if (type == QVariant::Int)
+	{
+		out << quint8(BINARY_INT) << qint32(value.toInt());
+	}
+	else if (type == QVariant::UInt)
+	{
+		out << quint8(BINARY_UINT) << quint32(value.toUInt());
+	}
+	else if (type == QVariant::LongLong)
+	{
+		out << quint8(BINARY_LONGLONG) << qint64(value.toLongLong());
+	}
+	else if (type == QVariant::Double)
+	{
+		out << quint8(BINARY_DOUBLE) << value.toDouble();
+	}
+	else if (type == QVariant::Bool)
+	{
+		out << quint8(BINARY_BOOL) << quint8(value.toBool());
+	}
+	else if (type == QVariant::String)
+	{
+		out << quint8(BINARY_STRING);
+		writeBinaryName(out, value.toString());
+	}
+	else if (type == QVariant::StringList)
+	{
+		QStringList list = value.toStringList();
+		out << quint8(BINARY_STRINGLIST) << quint32(list.size());
+		for (int i = 0; i < list.size(); ++i)
+		{
+			writeBinaryName(out, list[i]);
+		}
+	}
+	else if (type == qMetaTypeId<Vector2i>())
+	{
+		Vector2i v = value.value<Vector2i>();
+		out << quint8(BINARY_VECTOR2I) << qint32(v.x) << qint32(v.y);
+	}
+	else if (type == qMetaTypeId<Vector3i>())
+	{
+		Vector3i v = value.value<Vector3i>();
+		out << quint8(BINARY_VECTOR3I) << qint32(v.x) << qint32(v.y) << qint32(v.z);
+	}
+	else if (type == qMetaTypeId<Vector3f>())
+	{
+		Vector3f v = value.value<Vector3f>();
+		out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+		out << quint8(BINARY_VECTOR3F) << v.x << v.y << v.z;
+		out.setFloatingPointPrecision(QDataStream::DoublePrecision);
+	}
+	else
+	{
+		out << quint8(BINARY_VARIANT) << value;
+	}
+}
+
+static QVariant readBinaryValue(QDataStream &in)
+{
+	quint8 type = BINARY_VARIANT;
+	in >> type;
+	switch (type)
+	{
+		case BINARY_VARIANT:    { QVariant v; in >> v; return v; }
+		case BINARY_INT:        { qint32 v = 0; in >> v; return QVariant(int(v)); }
+		case BINARY_UINT:       { quint32 v = 0; in >> v; return QVariant(uint(v)); }
+		case BINARY_LONGLONG:   { qint64 v = 0; in >> v; return QVariant(qlonglong(v)); }
+		case BINARY_DOUBLE:     { double v = 0; in >> v; return QVariant(v); }
+		case BINARY_BOOL:       { quint8 v = 0; in >> v; return QVariant(v != 0); }
+		case BINARY_STRING:     return QVariant(readBinaryName(in));
+		case BINARY_STRINGLIST:
+		{
+			quint32 size = 0;
+			in >> size;
+			QStringList list;
+			for (quint32 i = 0; i < size && in.status() == QDataStream::Ok; ++i)
+			{
+				list.push_back(readBinaryName(in));
+			}
+			return QVariant(list);
+		}
+		case BINARY_VECTOR2I:   { qint32 x = 0, y = 0; in >> x >> y; return QVariant::fromValue(Vector2i(x, y)); }
+		case BINARY_VECTOR3I:   { qint32 x = 0, y = 0, z = 0; in >> x >> y >> z; return QVariant::fromValue(Vector3i(x, y, z)); }
+		case BINARY_VECTOR3F:
+		{
+			float x = 0, y = 0, z = 0;
+			in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+			in >> x >> y >> z;
+			in.setFloatingPointPrecision(QDataStream::DoublePrecision);
+			return QVariant::fromValue(Vector3f(x, y, z));
+		}
+	}
+	in.setStatus(QDataStream::ReadCorruptData);
+	return QVariant();
+}
+
+/// Returns the part of key before the first '/', or an empty string if key is not in a group.
+static QString keyGroup(const QString &key)
+{
+	int slash = key.indexOf('/');
+	return slash == -1? QString() : key.left(slash);
+}
+
+static bool writeBinaryFile(QIODevice &device, const QSettings::SettingsMap &map, bool compress)
+{
+	QDataStream out(&device);
+	out.setVersion(binaryStreamVersion);
+	out.writeRawData(binaryMagic, sizeof(binaryMagic));
+	out << (compress? compressedBinaryVersion : binaryVersion);
+
+	// The keys are sorted, so all the keys of a group are next to each other.
+	QSettings::SettingsMap::const_iterator i = map.constBegin();
+	while (i != map.constEnd())
+	{
+		QString group = keyGroup(i.key());
+		int prefixLength = group.isEmpty()? 0 : group.length() + 1;
+		quint32 numKeys = 0;
+		QSettings::SettingsMap::const_iterator end;
+		for (end = i; end != map.constEnd() && keyGroup(end.key()) == group; ++end)
+		{
+			++numKeys;
+		}
+
+		QByteArray chunk;
+		QDataStream chunkOut(&chunk, QIODevice::WriteOnly);
+		chunkOut.setVersion(binaryStreamVersion);
+		writeBinaryName(chunkOut, group);
+		chunkOut << numKeys;
+		for (; i != end; ++i)
+		{
+			writeBinaryName(chunkOut, i.key().mid(prefixLength));
+			writeBinaryValue(chunkOut, i.value());
+		}
+		if (compress)
+		{
+			chunk = qCompress(chunk);
+		}
+
+		out << quint32(chunk.size()) << quint32(crcSum(0x00000000, chunk.constData(), chunk.size()));
+		out.writeRawData(chunk.constData(), chunk.size());
+	}
+	return out.status() == QDataStream::Ok;
+}
+
+static bool writeBinaryFile(QIODevice &device, const QSettings::SettingsMap &map)
+{
+	return writeBinaryFile(device, map, false);
+}
+
+static bool readBinaryFile(QIODevice &device, QSettings::SettingsMap &map)
+{
+	QByteArray data = device.readAll();
+	if (data.isEmpty())
+	{
+		return true;  // Newly created file.
+	}
+
+	QDataStream in(data);
+	in.setVersion(binaryStreamVersion);
+	char magic[sizeof(binaryMagic)];
+	quint32 version = 0;
+	if (in.readRawData(magic, sizeof(magic)) != sizeof(magic) || memcmp(magic, binaryMagic, sizeof(magic)) != 0 || (in >> version, version < variantBinaryVersion || version > compressedBinaryVersion))
+	{
+		debug(LOG_ERROR, "Not a binary settings file, or unsupported version %u.", version);
+		return false;
+	}
+
+	while (!in.atEnd())
+	{
+		quint32 size = 0, crc = 0;
+		in >> size >> crc;
+		qint64 offset = in.device()->pos();
+		if (in.status() != QDataStream::Ok || size > data.size() - offset)
+		{
+			debug(LOG_ERROR, "Binary settings file is truncated.");
+			return false;
+		}
+		in.skipRawData(size);
+
+		QByteArray chunk = QByteArray::fromRawData(data.constData() + offset, size);
+		if (crcSum(0x00000000, chunk.constData(), chunk.size()) != crc)
+		{
+			debug(LOG_ERROR, "Skipping corrupt chunk at offset %d of binary settings file.", (int)offset);
+			continue;
+		}
+		if (version == compressedVariantBinaryVersion || version == compressedBinaryVersion)
+		{
+			chunk = qUncompress(chunk);
+		}
+
+		QDataStream chunkIn(chunk);
+		chunkIn.setVersion(binaryStreamVersion);
+		bool typed = version >= binaryVersion;
+		QString group;
+		quint32 numKeys = 0;
+		if (typed)
+		{
+			group = readBinaryName(chunkIn);
+		}
+		else
+		{
+			chunkIn >> group;
+		}
+		chunkIn >> numKeys;
+		QString prefix = group.isEmpty()? QString() : group + '/';
+		for (quint32 n = 0; n < numKeys && chunkIn.status() == QDataStream::Ok; ++n)
+		{
+			QString key;
+			QVariant value;
+			if (typed)
+			{
+				key = readBinaryName(chunkIn);
+				value = readBinaryValue(chunkIn);
+			}
+			else
+			{
+				chunkIn >> key >> value;
+			}
+			map.insert(prefix + key, value);
+		}
+		if (chunkIn.status() != QDataStream::Ok)
+		{
+			debug(LOG_ERROR, "Bad chunk \"%s\" in binary settings file.", group.toUtf8().constData());
+		}
+	}
+	return true;
+}
+
+// The background writer. WzConfigs with BinaryFileInBackground hand their values over to backgroundQueue when destroyed,
+// so the main thread only pays for building the map, not for serialising, compressing and writing it.
+// saveFileInBackground queues files which are already serialised, so that they are only copied on the main thread.
+struct BackgroundWrite
+{
+	QString name;
+	QSettings::SettingsMap map;
+	QByteArray data;                    ///< Written as is, if raw.
+	bool raw;
+};
+
+static WZ_THREAD *backgroundThread = NULL;
+static WZ_MUTEX *backgroundMutex = NULL;
+static WZ_SEMAPHORE *backgroundQueueSemaphore = NULL;  ///< Posted once per queued write, and once more to stop the thread.
+static WZ_SEMAPHORE *backgroundIdleSemaphore = NULL;   ///< Posted when the queue becomes empty while waitForBackgroundWrites is waiting.
+static std::deque<BackgroundWrite> backgroundQueue;    ///< Writes not yet finished. The front is being written.
+static QStringList backgroundFailures;                 ///< Files which could not be written, since the failures were last taken.
+static bool backgroundWaiting = false;
+static bool backgroundStop = false;
+
+static bool writeInBackground(const BackgroundWrite &write)
+{
+	QBuffer buffer;
+	if (!write.raw)
+	{
+		buffer.open(QIODevice::WriteOnly);
+		if (!writeBinaryFile(buffer, write.map, true))
+		{
+			debug(LOG_ERROR, "Could not serialise \"%s\"", write.name.toUtf8().constData());
+			return false;
+		}
+	}
+
+	PHYSFS_file *fileHandle = PHYSFS_openWrite(write.name.toUtf8().constData());
+	if (fileHandle == NULL)
+	{
+		debug(LOG_ERROR, "%s could not be created: %s", write.name.toUtf8().constData(), PHYSFS_getLastError());
+		return false;
+	}
+	const QByteArray &data = write.raw? write.data : buffer.data();
+	bool written = data.isEmpty() || PHYSFS_write(fileHandle, data.constData(), data.size(), 1) == 1;
+	if (!written)
+	{
+		debug(LOG_ERROR, "Could not write \"%s\": %s", write.name.toUtf8().constData(), PHYSFS_getLastError());
+	}
+	if (!PHYSFS_close(fileHandle))
+	{
+		debug(LOG_ERROR, "Error closing \"%s\": %s", write.name.toUtf8().constData(), PHYSFS_getLastError());
+		written = false;
+	}
+	return written;
+}
+
+static int backgroundThreadFunc(void *)
+{
+	for (;;)
+	{
+		wzSemaphoreWait(backgroundQueueSemaphore);
+		wzMutexLock(backgroundMutex);
+		if (backgroundStop)
+		{
+			wzMutexUnlock(backgroundMutex);
+			return 0;
+		}
+		BackgroundWrite &write = backgroundQueue.front();  // Only this thread pops, so the reference stays valid while unlocked.
+		wzMutexUnlock(backgroundMutex);
+
+		bool written = writeInBackground(write);
+
+		wzMutexLock(backgroundMutex);
+		if (!written)
+		{
+			backgroundFailures.push_back(write.name);
+		}
+		backgroundQueue.pop_front();
+		if (backgroundQueue.empty() && backgroundWaiting)
+		{
+			backgroundWaiting = false;
+			wzSemaphorePost(backgroundIdleSemaphore);
+		}
+		wzMutexUnlock(backgroundMutex);
+	}
+}
+
+static void queueBackgroundWrite(const QString &name, QSettings::SettingsMap &map, const QByteArray &data, bool raw)
+{
+	if (backgroundThread == NULL)
+	{
+		backgroundMutex = wzMutexCreate();
+		backgroundQueueSemaphore = wzSemaphoreCreate(0);
+		backgroundIdleSemaphore = wzSemaphoreCreate(0);
+		backgroundStop = false;
+		backgroundThread = wzThreadCreate(backgroundThreadFunc, NULL);
+		wzThreadStart(backgroundThread);
+	}
+
+	wzMutexLock(backgroundMutex);
+	backgroundQueue.push_back(BackgroundWrite());
+	backgroundQueue.back().name = name;
+	backgroundQueue.back().map = map;  // Implicitly shared, so no copy.
+	backgroundQueue.back().data = data;
+	backgroundQueue.back().raw = raw;
+	map.clear();
+	wzMutexUnlock(backgroundMutex);
+	wzSemaphorePost(backgroundQueueSemaphore);
+}
+
+void WzConfig::saveFileInBackground(const QString &name, const QByteArray &data)
+{
+	QSettings::SettingsMap noMap;
+	queueBackgroundWrite(name, noMap, data, true);
+}
+
+QStringList WzConfig::takeBackgroundWriteFailures()
+{
+	if (backgroundThread == NULL)
+	{
+		return QStringList();
+	}
+
+	wzMutexLock(backgroundMutex);
+	QStringList failures = backgroundFailures;
+	backgroundFailures.clear();
+	wzMutexUnlock(backgroundMutex);
+	return failures;
+}
+
+bool WzConfig::waitForBackgroundWrites()
+{
+	if (backgroundThread == NULL)
+	{
+		return true;
+	}
+
+	wzMutexLock(backgroundMutex);
+	bool wait = !backgroundQueue.empty();
+	backgroundWaiting = wait;
+	wzMutexUnlock(backgroundMutex);
+	if (wait)
+	{
+		wzSemaphoreWait(backgroundIdleSemaphore);
+	}
+
+	QStringList failures = takeBackgroundWriteFailures();
+	for (int i = 0; i < failures.size(); ++i)
+	{
+		debug(LOG_ERROR, "\"%s\" was not saved", failures[i].toUtf8().constData());
+	}
+	return failures.isEmpty();
+}
+
+bool WzConfig::shutdownBackgroundWrites()
+{
+	if (backgroundThread == NULL)
+	{
+		return true;
+	}
+
+	bool written = waitForBackgroundWrites();
+	wzMutexLock(backgroundMutex);
+	backgroundStop = true;
+	wzMutexUnlock(backgroundMutex);
+	wzSemaphorePost(backgroundQueueSemaphore);
+	wzThreadJoin(backgroundThread);
+	backgroundThread = NULL;
+	wzSemaphoreDestroy(backgroundIdleSemaphore);
+	wzSemaphoreDestroy(backgroundQueueSemaphore);
+	wzMutexDestroy(backgroundMutex);
+	return written;
+}
+
+/// Returns the format to use for name, detecting binary files, so that both old INI files and binary files can be read.
+static QSettings::Format settingsFormat(const QString &name, WzConfig::warning warning, WzConfig::fileFormat format)
+{
+	if (warning == WzConfig::ReadAndWrite && format != WzConfig::IniFile)
+	{
+		return WzConfig::binaryFormat();
+	}
+
+	bool isBinary = false;
+	PHYSFS_file *fileHandle = PHYSFS_openRead(name.toUtf8().constData());
+	if (fileHandle != NULL)
+	{
+		char magic[sizeof(binaryMagic)];
+		isBinary = PHYSFS_read(fileHandle, magic, 1, sizeof(magic)) == sizeof(magic) && memcmp(magic, binaryMagic, sizeof(magic)) == 0;
+		PHYSFS_close(fileHandle);
+	}
+	return isBinary? WzConfig::binaryFormat() : QSettings::IniFormat;
+}
+
+QSettings::Format WzConfig::binaryFormat()
+{
+	static const QSettings::Format format = QSettings::registerFormat("wzb", readBinaryFile, writeBinaryFile);
+	return format;
+}
+
+WzConfig::WzConfig(const QString &name, WzConfig::warning warning, WzConfig::fileFormat format, QObject *parent)
+	: WzConfigHack(name, format == BinaryFileInBackground? 1 : (int)warning, warning == ReadAndWrite && format == BinaryFile)
+	, m_settings(NULL)
+	, m_overrides()
+	, m_name(name)
+	, m_inBackground(format == BinaryFileInBackground)
+	, m_binary(true)
 {
-	if (m_settings.status() != QSettings::NoError && (warning != ReadOnly || PHYSFS_exists(name.toUtf8().constData())))
+	ASSERT(!m_inBackground || warning == ReadAndWrite, "Can only write \"%s\" in the background", name.toUtf8().constData());
+	if (m_inBackground)
+	{
+		return;  // Values only go to m_buffer, and overrides only change what is read.
+	}
+	m_settings = new QSettings(QString("wz::") + name, settingsFormat(name, warning, format), parent);
+	m_binary = m_settings->format() == binaryFormat();
+	if (m_settings->status() != QSettings::NoError && (warning != ReadOnly || PHYSFS_exists(name.toUtf8().constData())))
 	{
 		debug(LOG_FATAL, "Could not open \"%s\"", name.toUtf8().constData());
 	}
@@ -55,9 +539,19 @@ WzConfig::WzConfig(const QString &name, WzConfig::warning warning, QObject *pare
 	PHYSFS_freeList(diffList);
 }
 
+WzConfig::~WzConfig()
+{
+	if (m_inBackground)
+	{
+		queueBackgroundWrite(m_name, m_buffer, QByteArray(), false);
+	}
+	delete m_settings;
+}
+
 QStringList WzConfig::childGroups() const
 {
-	QStringList ret(m_settings.childGroups());
+	ASSERT_OR_RETURN(QStringList(), !m_inBackground, "Can't list groups of \"%s\" while writing it in the background", m_name.toUtf8().constData());
+	QStringList ret(m_settings->childGroups());
 	int i,j;
 	QStringList keys(m_overrides.keys());
 	QString group = slashedGroup();
@@ -79,7 +573,8 @@ QStringList WzConfig::childGroups() const
 
 QStringList WzConfig::childKeys() const
 {
-	QStringList ret(m_settings.childKeys());
+	ASSERT_OR_RETURN(QStringList(), !m_inBackground, "Can't list keys of \"%s\" while writing it in the background", m_name.toUtf8().constData());
+	QStringList ret(m_settings->childKeys());
 	int i;
 	QStringList keys(m_overrides.keys());
 	QString group = slashedGroup();
@@ -99,24 +594,38 @@ QStringList WzConfig::childKeys() const
 
 bool WzConfig::contains(const QString &key) const
 {
+	if (m_inBackground)
+	{
+		return m_buffer.contains(slashedGroup() + key);
+	}
 	if (m_overrides.contains(slashedGroup() + key))
 	{
 		return true;
 	}
-	return m_settings.contains(key);
+	return m_settings->contains(key);
 }
 
 QVariant WzConfig::value(const QString &key, const QVariant &defaultValue) const
 {
+	if (m_inBackground)
+	{
+		return m_buffer.value(slashedGroup() + key, defaultValue);
+	}
 	if (m_overrides.contains(slashedGroup() + key))
 	{
 		return m_overrides.value(slashedGroup() + key);
 	}
-	return m_settings.value(key,defaultValue);
+	return m_settings->value(key,defaultValue);
 }
 
+// In binary files, vectors are stored as numbers. INI files keep them as readable lists, which is also what older binary files have.
 void WzConfig::setVector3f(const QString &name, const Vector3f &v)
 {
+	if (m_binary)
+	{
+		setValue(name, QVariant::fromValue(v));
+		return;
+	}
 	QStringList l;
 	l.push_back(QString::number(v.x));
 	l.push_back(QString::number(v.y));
@@ -128,7 +637,12 @@ Vector3f WzConfig::vector3f(const QString &name)
 {
 	Vector3f r(0.0, 0.0, 0.0);
 	if (!contains(name)) return r;
-	QStringList v = value(name).toStringList();
+	QVariant value = this->value(name);
+	if (value.userType() == qMetaTypeId<Vector3f>())
+	{
+		return value.value<Vector3f>();
+	}
+	QStringList v = value.toStringList();
 	ASSERT(v.size() == 3, "Bad list of %s", name.toUtf8().constData());
 	r.x = v[0].toDouble();
 	r.y = v[1].toDouble();
@@ -138,6 +652,11 @@ Vector3f WzConfig::vector3f(const QString &name)
 
 void WzConfig::setVector3i(const QString &name, const Vector3i &v)
 {
+	if (m_binary)
+	{
+		setValue(name, QVariant::fromValue(v));
+		return;
+	}
 	QStringList l;
 	l.push_back(QString::number(v.x));
 	l.push_back(QString::number(v.y));
@@ -149,7 +668,12 @@ Vector3i WzConfig::vector3i(const QString &name)
 {
 	Vector3i r(0, 0, 0);
 	if (!contains(name)) return r;
-	QStringList v = value(name).toStringList();
+	QVariant value = this->value(name);
+	if (value.userType() == qMetaTypeId<Vector3i>())
+	{
+		return value.value<Vector3i>();
+	}
+	QStringList v = value.toStringList();
 	ASSERT(v.size() == 3, "Bad list of %s", name.toUtf8().constData());
 	r.x = v[0].toInt();
 	r.y = v[1].toInt();
@@ -159,6 +683,11 @@ Vector3i WzConfig::vector3i(const QString &name)
 
 void WzConfig::setVector2i(const QString &name, const Vector2i &v)
 {
+	if (m_binary)
+	{
+		setValue(name, QVariant::fromValue(v));
+		return;
+	}
 	QStringList l;
 	l.push_back(QString::number(v.x));
 	l.push_back(QString::number(v.y));
@@ -169,7 +698,12 @@ Vector2i WzConfig::vector2i(const QString &name)
 {
 	Vector2i r(0, 0);
 	if (!contains(name)) return r;
-	QStringList v = value(name).toStringList();
+	QVariant value = this->value(name);
+	if (value.userType() == qMetaTypeId<Vector2i>())
+	{
+		return value.value<Vector2i>();
+	}
+	QStringList v = value.toStringList();
 	ASSERT(v.size() == 2, "Bad list of %s", name.toUtf8().constData());
 	r.x = v[0].toInt();
 	r.y = v[1].toInt();
@@ -29,14 +29,19 @@
 #include "lib/framework/frame.h"
 #include "lib/framework/vector.h"
 
+// So that binary files can store vectors as numbers.
+Q_DECLARE_METATYPE(Vector2i)
+Q_DECLARE_METATYPE(Vector3i)
+Q_DECLARE_METATYPE(Vector3f)
+
 // QSettings is totally the wrong class to use for this, but it is so shiny!
 // The amount of hacks needed are escalating. So clearly Something Needs To Be Done.
 class WzConfigHack
 {
 public:
-	WzConfigHack(const QString &fileName, int readOnly)
+	WzConfigHack(const QString &fileName, int readOnly, bool truncate = false)
 	{
-		if (readOnly == 1 || PHYSFS_exists(fileName.toUtf8().constData())) return;
+		if (readOnly == 1 || (!truncate && PHYSFS_exists(fileName.toUtf8().constData()))) return;
 		if (readOnly == 0)
 		{
 			PHYSFS_file *fileHandle = PHYSFS_openWrite(fileName.toUtf8().constData());
@@ -53,19 +58,40 @@ public:
 class WzConfig : private WzConfigHack
 {
 private:
-	QSettings m_settings;
+	QSettings *m_settings;              ///< NULL if m_inBackground, since the file may still be being written by an earlier WzConfig.
 	QMap<QString,QVariant> m_overrides;
+	QString m_name;
+	bool m_inBackground;
+	bool m_binary;                      ///< Vectors are stored as numbers, not lists of strings.
+	QSettings::SettingsMap m_buffer;    ///< Values to write, if m_inBackground. Handed over to the background thread when destroyed.
+	QStringList m_bufferGroups;         ///< Groups begun, if m_inBackground.
 	
 	QString slashedGroup() const 
 	{
-		if (m_settings.group() == "") 
+		if (group() == "") 
 			return "";
-		return m_settings.group()+"/";
+		return group()+"/";
 	}
 
 public:
 	enum warning { ReadAndWrite, ReadOnly, ReadOnlyAndRequired };
-	WzConfig(const QString &name, WzConfig::warning warning = ReadAndWrite, QObject *parent = 0);
+	/// Which format to write. Reading always detects the format of the file.
+	/// BinaryFile truncates the file, so should only be used for files which are written all at once, such as savegames.
+	/// BinaryFileInBackground only keeps the values in memory, and leaves compressing and writing them to a background thread when the
+	/// WzConfig is destroyed. Only setting and reading values and groups may be used, and the file does not exist until waitForBackgroundWrites returns.
+	enum fileFormat { IniFile, BinaryFile, BinaryFileInBackground };
+	WzConfig(const QString &name, WzConfig::warning warning = ReadAndWrite, WzConfig::fileFormat format = IniFile, QObject *parent = 0);
+	~WzConfig();
+
+	static QSettings::Format binaryFormat();  ///< The QSettings format used for BinaryFile.
+	/// Writes data to name on the background thread, like saveFile. The file does not exist until waitForBackgroundWrites returns.
+	static void saveFileInBackground(const QString &name, const QByteArray &data);
+	/// Waits until all background files are written. Call before reading or deleting them.
+	/// Returns false, and logs the names, if any background file could not be written since the failures were last taken.
+	static bool waitForBackgroundWrites();
+	/// Returns the names of the background files which could not be written since the failures were last taken, without waiting.
+	static QStringList takeBackgroundWriteFailures();
+	static bool shutdownBackgroundWrites();   ///< Waits for the background writes and stops the background thread. Returns false like waitForBackgroundWrites.
 
 	Vector3f vector3f(const QString &name);
 	void setVector3f(const QString &name, const Vector3f &v);
@@ -81,31 +107,46 @@ public:
 
 	void beginGroup(const QString &prefix)
 	{
-		m_settings.beginGroup(prefix);
+		if (m_inBackground)
+		{
+			m_bufferGroups.push_back(prefix);
+			return;
+		}
+		m_settings->beginGroup(prefix);
 	}
 	void endGroup()
 	{
-		m_settings.endGroup();
+		if (m_inBackground)
+		{
+			m_bufferGroups.pop_back();
+			return;
+		}
+		m_settings->endGroup();
 	}
 	QString fileName() const
 	{
-		return m_settings.fileName();
+		return m_inBackground? m_name : m_settings->fileName();
 	}
 	bool isWritable() const
 	{
-		return m_settings.isWritable();
+		return m_inBackground || m_settings->isWritable();
 	}
 	void setValue(const QString &key, const QVariant &value) 
 	{
-		m_settings.setValue(key,value);
+		if (m_inBackground)
+		{
+			m_buffer.insert(slashedGroup() + key, value);
+			return;
+		}
+		m_settings->setValue(key,value);
 	}
 	QSettings::Status status() const
 	{
-		return m_settings.status();
+		return m_inBackground? QSettings::NoError : m_settings->status();
 	}
-	QString group()
+	QString group() const
 	{
-		return m_settings.group();
+		return m_inBackground? m_bufferGroups.join("/") : m_settings->group();
 	}
 };
 
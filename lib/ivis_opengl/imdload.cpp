@@ -96,7 +96,10 @@ static void iV_IMDRelease(iIMDShape *s)
 			free(s->shadowEdgeList);
 			s->shadowEdgeList = NULL;
 		}
-		glDeleteBuffers(VBO_COUNT, s->buffers);
+		if (!isHeadless())
+		{
+			glDeleteBuffers(VBO_COUNT, s->buffers);
+		}
 		// shader deleted later, if any
 		d = s->next;
 		delete s;
@@ -749,6 +752,12 @@ static iIMDShape *_imd_load_level(const char **ppFileData, const char *FileDataE
 	}
 
 	// FINALLY, massage the data into what can stream directly to OpenGL
+	if (isHeadless())
+	{
+		// Keep the shape data, for the game logic, but make no buffers.
+		*ppFileData = pFileData;
+		return s;
+	}
 	glGenBuffers(VBO_COUNT, s->buffers);
 	vertexCount = 0;
 	for (int k = 0; k < MAX(1, s->numFrames); k++)
@@ -73,6 +73,10 @@ static Vector2i makePieImage(IMAGEFILE *imageFile, unsigned id, PIERECT *dest =
 
 GFX::GFX(GFXTYPE type, GLenum drawType, int coordsPerVertex) : mType(type), mdrawType(drawType), mCoordsPerVertex(coordsPerVertex), mSize(0)
 {
+	if (isHeadless())
+	{
+		return;  // No GL objects to make.
+	}
 	glGenBuffers(VBO_MINIMAL, mBuffers);
 	if (type == GFX_TEXTURE)
 	{
@@ -100,6 +104,13 @@ void GFX::loadTexture(const char *filename, GLenum filter)
 void GFX::makeTexture(int width, int height, GLenum filter, GLenum format, const GLvoid *image)
 {
 	ASSERT(mType == GFX_TEXTURE, "Wrong GFX type");
+	mWidth = width;
+	mHeight = height;
+	mFormat = format;
+	if (isHeadless())
+	{
+		return;
+	}
 	pie_SetTexturePage(TEXPAGE_EXTERN);
 	glBindTexture(GL_TEXTURE_2D, mTexture);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, format, GL_UNSIGNED_BYTE, image);
@@ -107,9 +118,6 @@ void GFX::makeTexture(int width, int height, GLenum filter, GLenum format, const
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	mWidth = width;
-	mHeight = height;
-	mFormat = format;
 }
 
 void GFX::updateTexture(const void *image, int width, int height)
@@ -117,6 +125,10 @@ void GFX::updateTexture(const void *image, int width, int height)
 	ASSERT(mType == GFX_TEXTURE, "Wrong GFX type");
 	if (width == -1) width = mWidth;
 	if (height == -1) height = mHeight;
+	if (isHeadless())
+	{
+		return;
+	}
 	pie_SetTexturePage(TEXPAGE_EXTERN);
 	glBindTexture(GL_TEXTURE_2D, mTexture);
 	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, mFormat, GL_UNSIGNED_BYTE, image);
@@ -124,6 +136,11 @@ void GFX::updateTexture(const void *image, int width, int height)
 
 void GFX::buffers(int vertices, const GLvoid *vertBuf, const GLvoid *auxBuf)
 {
+	mSize = vertices;
+	if (isHeadless())
+	{
+		return;
+	}
 	glBindBuffer(GL_ARRAY_BUFFER, mBuffers[VBO_VERTEX]);
 	glBufferData(GL_ARRAY_BUFFER, vertices * mCoordsPerVertex * sizeof(GLfloat), vertBuf, GL_STATIC_DRAW);
 	if (mType == GFX_TEXTURE)
@@ -138,11 +155,14 @@ void GFX::buffers(int vertices, const GLvoid *vertBuf, const GLvoid *auxBuf)
 		glBufferData(GL_ARRAY_BUFFER, vertices * 4 * sizeof(GLbyte), auxBuf, GL_STATIC_DRAW);
 	}
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	mSize = vertices;
 }
 
 void GFX::draw()
 {
+	if (isHeadless())
+	{
+		return;
+	}
 	if (mType == GFX_TEXTURE)
 	{
 		pie_SetTexturePage(TEXPAGE_EXTERN);
@@ -173,6 +193,10 @@ void GFX::draw()
 
 GFX::~GFX()
 {
+	if (isHeadless())
+	{
+		return;
+	}
 	glDeleteBuffers(VBO_MINIMAL, mBuffers);
 	if (mType == GFX_TEXTURE)
 	{
@@ -182,6 +206,10 @@ GFX::~GFX()
 
 void iV_Line(int x0, int y0, int x1, int y1, PIELIGHT colour)
 {
+	if (isHeadless())
+	{
+		return;
+	}
 	pie_SetTexturePage(TEXPAGE_NONE);
 
 	glColor4ubv(colour.vector);
@@ -196,6 +224,10 @@ void iV_Line(int x0, int y0, int x1, int y1, PIELIGHT colour)
  */
 static void pie_DrawRect(float x0, float y0, float x1, float y1, PIELIGHT colour)
 {
+	if (isHeadless())
+	{
+		return;
+	}
 	glColor4ubv(colour.vector);
 	glBegin(GL_TRIANGLE_STRIP);
 		glVertex2f(x0, y0);
@@ -217,6 +249,10 @@ void iV_ShadowBox(int x0, int y0, int x1, int y1, int pad, PIELIGHT first, PIELI
 
 void iV_Box2(int x0,int y0, int x1, int y1, PIELIGHT first, PIELIGHT second)
 {
+	if (isHeadless())
+	{
+		return;
+	}
 	pie_SetTexturePage(TEXPAGE_NONE);
 
 	glColor4ubv(first.vector);
@@ -271,6 +307,10 @@ static bool assertValidImage(IMAGEFILE *imageFile, unsigned id)
 
 static void pie_DrawImage(IMAGEFILE *imageFile, int id, Vector2i size, const PIERECT *dest, PIELIGHT colour = WZCOL_WHITE)
 {
+	if (isHeadless())
+	{
+		return;
+	}
 	ImageDef const &image2 = imageFile->imageDefs[id];
 	GLuint texPage = imageFile->pages[image2.TPageID].id;
 	GLfloat invTextureSize = 1.f / imageFile->pages[image2.TPageID].size;
@@ -312,6 +352,10 @@ static Vector2i makePieImage(IMAGEFILE *imageFile, unsigned id, PIERECT *dest, i
 
 void iV_DrawImage2(const QString &filename, float x, float y, float width, float height)
 {
+	if (isHeadless())
+	{
+		return;
+	}
 	ImageDef *image = iV_GetImage(filename, x, y);
 	const GLfloat invTextureSize = image->invTextureSize;
 	const int tu = image->Tu;
@@ -459,6 +503,10 @@ void pie_DownLoadRadar(UDWORD *buffer)
 /** Display radar texture using the given height and width, depending on zoom level. */
 void pie_RenderRadar()
 {
+	if (isHeadless())
+	{
+		return;
+	}
 	pie_SetRendMode(REND_ALPHA);
 	glColor4ubv(WZCOL_WHITE.vector); // hack
 	radarGfx->draw();
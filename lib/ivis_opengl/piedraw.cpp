@@ -77,6 +77,10 @@ void pie_InitLighting()
 
 void pie_SetupLighting()
 {
+	if (isHeadless())
+	{
+		return;
+	}
 	glLightModelfv(GL_LIGHT_MODEL_AMBIENT, lighting0[LIGHT_EMISSIVE]);
 	glLightModeli(GL_LIGHT_MODEL_LOCAL_VIEWER, GL_FALSE);
 	glLightfv(GL_LIGHT0, GL_AMBIENT, lighting0[LIGHT_AMBIENT]);
@@ -101,6 +105,10 @@ void pie_BeginLighting(const Vector3f *light)
 {
 	const float pos[4] = { light->x, light->y, light->z, 0.0f };
 
+	if (isHeadless())
+	{
+		return;
+	}
 	glLightfv(GL_LIGHT0, GL_POSITION, pos);
 }
 
@@ -404,6 +412,11 @@ void pie_CleanUp( void )
 
 void pie_Draw3DShape(iIMDShape *shape, int frame, int team, PIELIGHT colour, int pieFlag, int pieFlagData)
 {
+	if (isHeadless())
+	{
+		return;  // Nothing would ever empty the queues.
+	}
+
 	pieCount++;
 
 	ASSERT(frame >= 0, "Negative frame %d", frame);
@@ -528,6 +541,11 @@ static void pie_DrawShadows(void)
 
 void pie_RemainingPasses(void)
 {
+	if (isHeadless())
+	{
+		return;
+	}
+
 	GL_DEBUG("Remaining passes - shadows");
 	glEnable(GL_LIGHT0);
 	// Draw shadows
@@ -85,6 +85,10 @@ void pie_DrawViewingWindow()
 
 void pie_TransColouredTriangle(Vector3f *vrt, PIELIGHT c)
 {
+	if (isHeadless())
+	{
+		return;
+	}
 	UDWORD i;
 
 	pie_SetTexturePage(TEXPAGE_NONE);
@@ -124,6 +128,10 @@ void pie_Skybox_Init()
 void pie_Skybox_Texture(const char *filename)
 {
 	skyboxGfx->loadTexture(filename);
+	if (isHeadless())
+	{
+		return;
+	}
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 }
 
@@ -134,6 +142,10 @@ void pie_Skybox_Shutdown()
 
 void pie_DrawSkybox(float scale)
 {
+	if (isHeadless())
+	{
+		return;
+	}
 	glPushAttrib(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT | GL_ENABLE_BIT | GL_FOG_BIT);
 	// no use in updating the depth buffer
 	glDepthMask(GL_FALSE);
@@ -415,6 +415,9 @@ void pie_SetGeometricOffset(int x, int y)
 void pie_MatInit(void)
 {
 	psMatrix = &aMatrixStack[0];
-	glLoadIdentity();
+	if (!isHeadless())
+	{
+		glLoadIdentity();
+	}
 }
 
@@ -53,7 +53,11 @@ bool pie_Initialise(void)
 	pie_TexInit();
 
 	/* Find texture compression extension */
-	if (GLEW_ARB_texture_compression && wz_texture_compression != GL_RGBA)
+	if (isHeadless())
+	{
+		wz_texture_compression = GL_RGBA;
+	}
+	else if (GLEW_ARB_texture_compression && wz_texture_compression != GL_RGBA)
 	{
 		debug(LOG_TEXTURE, "Texture compression: Yes");
 		wz_texture_compression = GL_COMPRESSED_RGBA_ARB;
@@ -75,7 +79,10 @@ bool pie_Initialise(void)
 	rendSurface.clip.right	= pie_GetVideoBufferWidth();
 	rendSurface.clip.bottom	= pie_GetVideoBufferHeight();
 
-	pie_SetDefaultStates();
+	if (!isHeadless())
+	{
+		pie_SetDefaultStates();
+	}
 	debug(LOG_3D, "xcentre %d; ycentre %d", rendSurface.xcentre, rendSurface.ycentre);
 
 	return true;
@@ -93,6 +100,11 @@ void pie_ScreenFlip(int clearMode)
 {
 	GLbitfield clearFlags = 0;
 
+	if (isHeadless())
+	{
+		return;
+	}
+
 	screenDoDumpToDiskIfRequired();
 	wzScreenFlip();
 	wzPerfFrame();
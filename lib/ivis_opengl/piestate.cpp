@@ -212,6 +212,10 @@ static void getLocs(SHADER_PROGRAM *program)
 
 void pie_FreeShaders()
 {
+	if (isHeadless())
+	{
+		return;
+	}
 	while (shaderProgram.size() > SHADER_MAX)
 	{
 		SHADER_PROGRAM program = shaderProgram.takeLast();
@@ -325,6 +329,12 @@ bool pie_LoadShaders()
 	SHADER_PROGRAM program;
 	int result;
 
+	if (isHeadless())
+	{
+		currentShaderMode = SHADER_NONE;
+		return true;  // Nothing will be drawn.
+	}
+
 	// Load some basic shaders
 	memset(&program, 0, sizeof(program));
 	shaderProgram.append(program);
@@ -345,6 +355,10 @@ bool pie_LoadShaders()
 
 void pie_DeactivateShader(void)
 {
+	if (isHeadless())
+	{
+		return;
+	}
 	currentShaderMode = SHADER_NONE;
 	glUseProgram(0);
 }
@@ -375,6 +389,11 @@ void pie_ActivateShader(int shaderMode, iIMDShape* shape, PIELIGHT teamcolour, P
 	int normalpage = shape->normalpage;
 	int specularpage = shape->specularpage;
 	GLfloat colour4f[4];
+	if (isHeadless())
+	{
+		return;
+	}
+
 	SHADER_PROGRAM program = shaderProgram[shaderMode];
 
 	if (shaderMode != currentShaderMode)
@@ -435,6 +454,10 @@ void pie_ActivateShader(int shaderMode, iIMDShape* shape, PIELIGHT teamcolour, P
 
 void pie_SetDepthBufferStatus(DEPTH_MODE depthMode)
 {
+	if (isHeadless())
+	{
+		return;
+	}
 	switch(depthMode)
 	{
 		case DEPTH_CMP_LEQ_WRT_ON:
@@ -459,6 +482,10 @@ void pie_SetDepthBufferStatus(DEPTH_MODE depthMode)
 /// Negative values are closer to the screen
 void pie_SetDepthOffset(float offset)
 {
+	if (isHeadless())
+	{
+		return;
+	}
 	if(offset == 0.0f)
 	{
 		glDisable (GL_POLYGON_OFFSET_FILL);
@@ -473,6 +500,10 @@ void pie_SetDepthOffset(float offset)
 /// Set the OpenGL fog start and end
 void pie_UpdateFogDistance(float begin, float end)
 {
+	if (isHeadless())
+	{
+		return;
+	}
 	glFogf(GL_FOG_START, begin);
 	glFogf(GL_FOG_END, end);
 }
@@ -486,7 +517,7 @@ void pie_SetFogStatus(bool val)
 {
 	float fog_colour[4];
 
-	if (rendStates.fogEnabled)
+	if (rendStates.fogEnabled && !isHeadless())
 	{
 		//fog enabled so toggle if required
 		if (rendStates.fog != val)
@@ -526,6 +557,10 @@ void pie_SetFogStatus(bool val)
  */
 void pie_SetTexturePage(SDWORD num)
 {
+	if (isHeadless())
+	{
+		return;
+	}
 	// Only bind textures when they're not bound already
 	if (num != rendStates.texPage)
 	{
@@ -551,6 +586,10 @@ void pie_SetTexturePage(SDWORD num)
 
 void pie_SetRendMode(REND_MODE rendMode)
 {
+	if (isHeadless())
+	{
+		return;
+	}
 	if (rendMode != rendStates.rendMode)
 	{
 		rendStates.rendMode = rendMode;
@@ -591,6 +630,10 @@ void pie_SetRendMode(REND_MODE rendMode)
 bool _glerrors(const char *function, const char *file, int line)
 {
 	bool ret = false;
+	if (isHeadless())
+	{
+		return ret;
+	}
 	GLenum err = glGetError();
 	while (err != GL_NO_ERROR)
 	{
@@ -98,6 +98,16 @@ bool screenInitialise()
 	GLint glMaxTUs;
 	GLenum err;
 
+	if (isHeadless())
+	{
+		// No GL context, only make the objects that the rest of the game expects to exist.
+		screenWidth = MAX(screenWidth, 640);
+		screenHeight = MAX(screenHeight, 480);
+		pie_Skybox_Init();
+		backdropGfx = new GFX(GFX_TEXTURE, GL_TRIANGLE_STRIP, 2);
+		return true;
+	}
+
 	glErrors();
 
 	err = glewInit();
@@ -367,8 +377,11 @@ void screenShutDown(void)
 
 	delete backdropGfx;
 
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-	glErrors();
+	if (!isHeadless())
+	{
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+		glErrors();
+	}
 }
 
 /// Display a random backdrop from files in dirname starting with basename.
@@ -420,6 +433,11 @@ bool screen_GetBackDrop(void)
 
 void screen_Display()
 {
+	if (isHeadless())
+	{
+		return;
+	}
+
 	pie_SetDepthBufferStatus(DEPTH_CMP_ALWAYS_WRT_OFF);
 
 	// Draw backdrop
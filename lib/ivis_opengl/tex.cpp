@@ -57,7 +57,11 @@ int pie_NumberOfPages()
 int pie_ReserveTexture(const char *name)
 {
 	iTexPage tex;
-	glGenTextures(1, &tex.id);
+	tex.id = 0;
+	if (!isHeadless())
+	{
+		glGenTextures(1, &tex.id);
+	}
 	sstrcpy(tex.name, name);
 	_TEX_PAGE.append(tex);
 	return _TEX_PAGE.size() - 1;
@@ -71,7 +75,11 @@ int pie_AddTexPage(iV_Image *s, const char* filename, bool gameTexture, int page
 	{
 		iTexPage tex;
 		page = _TEX_PAGE.size();
-		glGenTextures(1, &tex.id);
+		tex.id = 0;
+		if (!isHeadless())
+		{
+			glGenTextures(1, &tex.id);
+		}
 		sstrcpy(tex.name, filename);
 		_TEX_PAGE.append(tex);
 	}
@@ -82,6 +90,14 @@ int pie_AddTexPage(iV_Image *s, const char* filename, bool gameTexture, int page
 	}
 	debug(LOG_TEXTURE, "%s page=%d", filename, page);
 
+	if (isHeadless())
+	{
+		// Keep the page, so that lookups by name still work, but there is nothing to upload to.
+		free(s->bmp);
+		s->bmp = NULL;
+		return page;
+	}
+
 	pie_SetTexturePage(page);
 
 	if (gameTexture) // this is a game texture, use texture compression
@@ -225,7 +241,7 @@ void pie_TexShutDown(void)
 {
 	// TODO, lazy deletions for faster loading of next level
 	debug(LOG_TEXTURE, "Cleaning out %u textures", _TEX_PAGE.size());
-	int _TEX_INDEX = _TEX_PAGE.size() - 1;
+	int _TEX_INDEX = isHeadless()? 0 : _TEX_PAGE.size() - 1;
 	while (_TEX_INDEX > 0)
 	{
 		glDeleteTextures(1, &_TEX_PAGE[_TEX_INDEX--].id);
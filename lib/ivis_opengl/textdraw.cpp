@@ -201,6 +201,11 @@ static void iV_initializeGLC(void)
 
 void iV_TextInit()
 {
+	if (isHeadless())
+	{
+		iV_SetFont(font_regular);
+		return;  // GLC needs a GL context.
+	}
 	iV_initializeGLC();
 	iV_SetFont(font_regular);
 
@@ -306,11 +311,21 @@ static inline float getGLCPointToPixel(float point_width)
 	return pixel_width;
 }
 
+/// Without GLC, headless mode estimates text sizes from the font size. Only the layout of windows that nobody sees depends on it.
+static inline unsigned int headlessTextWidth(size_t length)
+{
+	return (unsigned int)(length * font_size / 2);
+}
+
 unsigned int iV_GetTextWidth(const char* string)
 {
 	float boundingbox[8];
 	float pixel_width, point_width;
 
+	if (isHeadless())
+	{
+		return headlessTextWidth(strlen(string));
+	}
 	glcMeasureString(GL_FALSE, string);
 	if (!glcGetStringMetric(GLC_BOUNDS, boundingbox))
 	{
@@ -328,6 +343,10 @@ unsigned int iV_GetCountedTextWidth(const char* string, size_t string_length)
 	float boundingbox[8];
 	float pixel_width, point_width;
 
+	if (isHeadless())
+	{
+		return headlessTextWidth(string_length);
+	}
 	glcMeasureCountedString(GL_FALSE, string_length, string);
 	if (!glcGetStringMetric(GLC_BOUNDS, boundingbox))
 	{
@@ -345,6 +364,10 @@ unsigned int iV_GetTextHeight(const char* string)
 	float boundingbox[8];
 	float pixel_height, point_height;
 
+	if (isHeadless())
+	{
+		return (unsigned int)font_size;
+	}
 	glcMeasureString(GL_FALSE, string);
 	if (!glcGetStringMetric(GLC_BOUNDS, boundingbox))
 	{
@@ -362,6 +385,10 @@ unsigned int iV_GetCharWidth(uint32_t charCode)
 	float boundingbox[8];
 	float pixel_width, point_width;
 
+	if (isHeadless())
+	{
+		return headlessTextWidth(1);
+	}
 	if (!glcGetCharMetric(charCode, GLC_BOUNDS, boundingbox))
 	{
 		debug(LOG_ERROR, "Couldn't retrieve a bounding box for the character code %u", charCode);
@@ -378,6 +405,10 @@ int iV_GetTextLineSize()
 	float boundingbox[8];
 	float pixel_height, point_height;
 
+	if (isHeadless())
+	{
+		return (int)(font_size * 5 / 4);
+	}
 	if (!glcGetMaxCharMetric(GLC_BOUNDS, boundingbox))
 	{
 		debug(LOG_ERROR, "Couldn't retrieve a bounding box for the character");
@@ -409,6 +440,10 @@ int iV_GetTextAboveBase(void)
 	float boundingbox[8];
 	float pixel_height, point_height;
 
+	if (isHeadless())
+	{
+		return (int)-font_size;
+	}
 	if (!glcGetMaxCharMetric(GLC_BOUNDS, boundingbox))
 	{
 		debug(LOG_ERROR, "Couldn't retrieve a bounding box for the character");
@@ -428,6 +463,10 @@ int iV_GetTextBelowBase(void)
 	float boundingbox[8];
 	float pixel_height, point_height;
 
+	if (isHeadless())
+	{
+		return (int)(font_size / 4);
+	}
 	if (!glcGetMaxCharMetric(GLC_BOUNDS, boundingbox))
 	{
 		debug(LOG_ERROR, "Couldn't retrieve a bounding box for the character");
@@ -599,6 +638,10 @@ void iV_DrawTextRotated(const char* string, float XPos, float YPos, float rotati
 {
 	GLint matrix_mode = 0;
 	ASSERT_OR_RETURN( , string, "Couldn't render string!");
+	if (isHeadless())
+	{
+		return;
+	}
 	pie_SetTexturePage(TEXPAGE_EXTERN);
 
 	glGetIntegerv(GL_MATRIX_MODE, &matrix_mode);
@@ -39,6 +39,7 @@
 
 #include "netplay.h"
 #include "netlog.h"
+#include "netreplay.h"
 #include "netsocket.h"
 
 #include <miniupnpc/miniwget.h>
@@ -106,6 +107,7 @@ struct NETSTATS  // data regarding the last one second or so.
 	Statistic       rawBytes;               // Number of actual bytes, in about 1 sec.
 	Statistic       uncompressedBytes;      // Number of bytes sent, before compression, in about 1 sec.
 	Statistic       packets;                // Number of calls to writeAll, in about 1 sec.
+	Statistic       serializedBytes;        // Number of bytes serialised, in about 1 sec. Broadcasts are only serialised once, then compressed for each client.
 };
 
 struct NET_PLAYER_DATA
@@ -173,7 +175,7 @@ unsigned NET_PlayerConnectionStatus[CONNECTIONSTATUS_NORMAL][MAX_PLAYERS];
 **/
 static char const *versionString = version_getVersionString();
 static int NETCODE_VERSION_MAJOR = 7;
-static int NETCODE_VERSION_MINOR = 0;
+static int NETCODE_VERSION_MINOR = 1;
 
 bool NETisCorrectVersion(uint32_t game_version_major, uint32_t game_version_minor)
 {
@@ -1251,6 +1253,7 @@ unsigned NETgetStatistic(NetStatisticType type, bool sent, bool isTotal)
 		case NetStatisticRawBytes:          statsType = &NETSTATS::rawBytes;          break;
 		case NetStatisticUncompressedBytes: statsType = &NETSTATS::uncompressedBytes; break;
 		case NetStatisticPackets:           statsType = &NETSTATS::packets;           break;
+		case NetStatisticSerializedBytes:   statsType = &NETSTATS::serializedBytes;   break;
 		default: ASSERT(false, " "); return 0;
 	}
 
@@ -1270,6 +1273,18 @@ unsigned NETgetStatistic(NetStatisticType type, bool sent, bool isTotal)
 }
 
 
+/// Borrows the buffer left over from the last message sent, so that sending does not allocate every time. Still works
+/// if NETsend gets called again while sending, such as when a write fails and a client gets disconnected.
+struct NetSendBuffer
+{
+	NetSendBuffer() { data.swap(spare); data.clear(); }
+	~NetSendBuffer() { data.swap(spare); }
+
+	std::vector<uint8_t> data;
+	static std::vector<uint8_t> spare;
+};
+std::vector<uint8_t> NetSendBuffer::spare;
+
 // ////////////////////////////////////////////////////////////////////////
 // Send a message to a player, option to guarantee message
 bool NETsend(NETQUEUE queue, NetMessage const *message)
@@ -1304,6 +1319,14 @@ bool NETsend(NETQUEUE queue, NetMessage const *message)
 
 	if (NetPlay.isHost)
 	{
+		// Serialise the message once, even if broadcasting. Each socket has its own compression stream, so the
+		// message still gets compressed once per client.
+		NetSendBuffer buffer;
+		std::vector<uint8_t> &rawData = buffer.data;
+		message->rawDataAppendToVector(rawData);
+		const ssize_t rawLen = rawData.size();
+		nStats.serializedBytes.sent += rawLen;
+
 		int firstPlayer = player == NET_ALL_PLAYERS ? 0                         : player;
 		int lastPlayer  = player == NET_ALL_PLAYERS ? MAX_CONNECTED_PLAYERS - 1 : player;
 		for (player = firstPlayer; player <= lastPlayer; ++player)
@@ -1311,11 +1334,8 @@ bool NETsend(NETQUEUE queue, NetMessage const *message)
 			// We are the host, send directly to player.
 			if (sockets[player] != NULL && player != queue.exclude)
 			{
-				uint8_t *rawData = message->rawDataDup();
-				ssize_t rawLen   = message->rawLen();
 				size_t compressedRawLen;
-				result = writeAll(sockets[player], rawData, rawLen, &compressedRawLen);
-				delete[] rawData;  // Done with the data.
+				result = writeAll(sockets[player], &rawData[0], rawLen, &compressedRawLen);
 
 				if (result == rawLen)
 				{
@@ -1342,11 +1362,14 @@ bool NETsend(NETQUEUE queue, NetMessage const *message)
 		// We are a client, send directly to player, who happens to be the host.
 		if (bsocket)
 		{
-			uint8_t *rawData = message->rawDataDup();
-			ssize_t rawLen   = message->rawLen();
+			NetSendBuffer buffer;
+			std::vector<uint8_t> &rawData = buffer.data;
+			message->rawDataAppendToVector(rawData);
+			const ssize_t rawLen = rawData.size();
+			nStats.serializedBytes.sent += rawLen;
+
 			size_t compressedRawLen;
-			result = writeAll(bsocket, rawData, rawLen, &compressedRawLen);
-			delete[] rawData;  // Done with the data.
+			result = writeAll(bsocket, &rawData[0], rawLen, &compressedRawLen);
 
 			if (result == rawLen)
 			{
@@ -1868,12 +1891,24 @@ bool NETrecvGame(NETQUEUE *queue, uint8_t *type)
 		*queue = NETgameQueue(current);
 		while (!checkPlayerGameTime(current))  // Check for any messages that are scheduled to be read now.
 		{
+			if (!NETisMessageReady(*queue) && NETreplayIsLoading())
+			{
+				// Feed the recorded messages into the game queues, until this player has a message. Messages for other players are processed later, in the recorded order.
+				NetMessage message;
+				uint8_t player;
+				while (!NETisMessageReady(*queue) && NETreplayLoadNetMessage(&message, &player))
+				{
+					ASSERT_OR_RETURN(false, player < MAX_PLAYERS, "Bad player %u in replay.", player);
+					NETinsertMessageFromNet(NETgameQueue(player), &message);
+				}
+			}
 			if (!NETisMessageReady(*queue))
 			{
 				return false;  // Still waiting for messages from this player, and all players should process messages in the same order. Will have to freeze the game while waiting.
 			}
 
 			*type = NETgetMessage(*queue)->type;
+			NETreplaySaveNetMessage(NETgetMessage(*queue), current);
 
 			if (*type == GAME_GAME_TIME)
 			{
@@ -3295,6 +3330,141 @@ struct SyncDebugIntList : public SyncDebugEntry
 	unsigned numInts;
 };
 
+/// Sets argTypes[n] to 'i' or 's', if the n'th argument of str is an int (%d, %u, %X, %c, ...) or a string (%s), and returns the number of arguments.
+/// Returns -1 if str takes any other type of argument, such as floats or pointers, or if it takes more than 40 arguments.
+static int syncDebugArgTypes(char const *str, char *argTypes)
+{
+	int count = 0;
+	for (char const *c = str; *c != '\0'; ++c)
+	{
+		if (*c != '%')
+		{
+			continue;
+		}
+		++c;
+		if (*c == '%')
+		{
+			continue;  // Literal '%'.
+		}
+		c += strspn(c, "-+ #0123456789.");  // Flags, width and precision. ('*' is not supported.)
+		size_t lenModifier = strspn(c, "h");  // short and char arguments are promoted to int.
+		c += lenModifier;
+		if (count >= 40 || *c == '\0')
+		{
+			return -1;
+		}
+		if (strchr("diouxXc", *c) != NULL)
+		{
+			argTypes[count++] = 'i';
+		}
+		else if (*c == 's' && lenModifier == 0)
+		{
+			argTypes[count++] = 's';
+		}
+		else
+		{
+			return -1;
+		}
+	}
+	return count;
+}
+
+/// A string which never changes, such as a function name or format string.
+struct SyncDebugConstantString
+{
+	char const *string;
+	uint32_t    crc;           ///< CRC of the string, in network byte order.
+	int         numArgs;       ///< Return value of syncDebugArgTypes().
+	char        argTypes[40];
+};
+
+/// Returns information about str. Cached by address, since the same strings are checksummed every tick.
+static SyncDebugConstantString const &syncDebugConstantString(char const *str)
+{
+	static SyncDebugConstantString cache[251];
+	SyncDebugConstantString &entry = cache[(uintptr_t)str % ARRAY_SIZE(cache)];
+	if (entry.string != str)
+	{
+		entry.string = str;
+		entry.crc = htonl(crcSum(0x00000000, str, strlen(str) + 1));
+		entry.numArgs = syncDebugArgTypes(str, entry.argTypes);
+	}
+	return entry;
+}
+
+struct SyncDebugFormat : public SyncDebugEntry
+{
+	// Each argument is stored as an int, or for %s arguments, as the offset of the string in argChars.
+	void set(uint32_t &crc, char const *f, char const *fmt, char const *argTypes, int const *args, unsigned num, char const *argChars)
+	{
+		function = f;
+		format = fmt;
+		numArgs = num;
+		uint32_t stringCrcs[2] = {syncDebugConstantString(function).crc, syncDebugConstantString(format).crc};
+		crc = crcSum(crc, stringCrcs, sizeof(stringCrcs));
+		for (unsigned n = 0; n < numArgs; ++n)
+		{
+			if (argTypes[n] == 's')
+			{
+				char const *str = argChars + args[n];
+				crc = crcSum(crc, str, strlen(str) + 1);
+			}
+			else
+			{
+				uint32_t valueBytes = htonl(args[n]);
+				crc = crcSum(crc, &valueBytes, 4);
+			}
+		}
+	}
+	int snprint(char *buf, size_t bufSize, int const *&args, char const *argChars) const
+	{
+		int const *arg = args;
+		args += numArgs;
+
+		size_t index = snprintf(buf, bufSize, "[%s] ", function);
+		char const *c = format;
+		while (*c != '\0' && index < bufSize)
+		{
+			size_t len = strcspn(c, "%");
+			if (len == 0 && c[1] == '%')
+			{
+				index += snprintf(buf + index, bufSize - index, "%%");  // Literal '%'.
+				c += 2;
+				continue;
+			}
+			if (len != 0)
+			{
+				index += snprintf(buf + index, bufSize - index, "%.*s", (int)len, c);
+				c += len;
+				continue;
+			}
+
+			// Format a single argument, using the conversion specification from the format string.
+			char spec[32];
+			len = 1 + strspn(c + 1, "-+ #0123456789.h") + 1;
+			sstrcpy(spec, c);
+			spec[MIN(len, sizeof(spec) - 1)] = '\0';
+			if (c[len - 1] == 's')
+			{
+				index += snprintf(buf + index, bufSize - index, spec, argChars + *arg++);
+			}
+			else
+			{
+				index += snprintf(buf + index, bufSize - index, spec, *arg++);
+			}
+			c += len;
+		}
+		if (index < bufSize)
+		{
+			index += snprintf(buf + index, bufSize - index, "\n");
+		}
+		return index;
+	}
+
+	char const *format;
+	unsigned numArgs;
+};
+
 struct SyncDebugLog
 {
 	SyncDebugLog() : time(0), crc(0x00000000) {}
@@ -3307,8 +3477,10 @@ struct SyncDebugLog
 		strings.clear();
 		valueChanges.clear();
 		intLists.clear();
+		formats.clear();
 		chars.clear();
 		ints.clear();
+		formatChars.clear();
 	}
 	void string(char const *f, char const *s)
 	{
@@ -3339,11 +3511,37 @@ struct SyncDebugLog
 		intLists.back().set(crc, f, s, buf, num);
 		log.push_back('i');
 	}
+	void formatArgs(char const *f, char const *fmt, char const *argTypes, unsigned num, va_list ap)
+	{
+		size_t offset = ints.size();
+		ints.resize(ints.size() + num);
+		int *buf = num == 0? NULL : &ints[offset];
+		for (unsigned n = 0; n < num; ++n)
+		{
+			if (argTypes[n] == 's')
+			{
+				char const *str = va_arg(ap, char const *);
+				str = str != NULL? str : "(null)";
+				buf[n] = formatChars.size();
+				formatChars.insert(formatChars.end(), str, str + strlen(str) + 1);
+			}
+			else
+			{
+				buf[n] = va_arg(ap, int);
+			}
+		}
+
+		formats.resize(formats.size() + 1);
+		formats.back().set(crc, f, fmt, argTypes, buf, num, formatChars.empty()? NULL : &formatChars[0]);
+		log.push_back('f');
+	}
 	int snprint(char *buf, size_t bufSize)
 	{
 		SyncDebugString const *stringPtr = strings.empty()? NULL : &strings[0];  // .empty() check, since &strings[0] is undefined if strings is empty(), even if it's likely to work, anyway.
 		SyncDebugValueChange const *valueChangePtr = valueChanges.empty()? NULL : &valueChanges[0];
 		SyncDebugIntList const *intListPtr = intLists.empty()? NULL : &intLists[0];
+		SyncDebugFormat const *formatPtr = formats.empty()? NULL : &formats[0];
+		char const *formatCharPtr = formatChars.empty()? NULL : &formatChars[0];
 		char const *charPtr = chars.empty()? NULL : &chars[0];
 		int const *intPtr = ints.empty()? NULL : &ints[0];
 
@@ -3362,6 +3560,9 @@ struct SyncDebugLog
 				case 'i':
 					index += intListPtr++->snprint(buf + index, bufSize - index, intPtr);
 					break;
+				case 'f':
+					index += formatPtr++->snprint(buf + index, bufSize - index, intPtr, formatCharPtr);
+					break;
 				default:
 					abort();
 					break;
@@ -3398,9 +3599,11 @@ private:
 	std::vector<SyncDebugString> strings;
 	std::vector<SyncDebugValueChange> valueChanges;
 	std::vector<SyncDebugIntList> intLists;
+	std::vector<SyncDebugFormat> formats;
 
 	std::vector<char> chars;
-	std::vector<int> ints;
+	std::vector<int> ints;         ///< Used by both intLists and formats.
+	std::vector<char> formatChars; ///< %s arguments of formats.
 
 private:
 	SyncDebugLog(SyncDebugLog const &)/* = delete*/;
@@ -3424,13 +3627,22 @@ void _syncDebug(const char *function, const char *str, ...)
 #endif
 
 	va_list ap;
-	char outputBuffer[MAX_LEN_LOG_LINE];
-
 	va_start(ap, str);
-	vssprintf(outputBuffer, str, ap);
-	va_end(ap);
 
-	syncDebugLog[syncDebugNext].string(function, outputBuffer);
+	// Store and checksum the raw arguments, if possible. They are only formatted if there is a desynch.
+	SyncDebugConstantString const &format = syncDebugConstantString(str);
+	if (format.numArgs >= 0)
+	{
+		syncDebugLog[syncDebugNext].formatArgs(function, str, format.argTypes, format.numArgs, ap);
+	}
+	else
+	{
+		char outputBuffer[MAX_LEN_LOG_LINE];
+		vssprintf(outputBuffer, str, ap);
+		syncDebugLog[syncDebugNext].string(function, outputBuffer);
+	}
+
+	va_end(ap);
 }
 
 void _syncDebugIntList(const char *function, const char *str, int *ints, size_t numInts)
@@ -100,35 +100,71 @@ bool decode_uint32_t(uint8_t b, uint32_t &v, unsigned n)
 	return !isLastByte;
 }
 
-uint8_t *NetMessage::rawDataDup() const
+size_t NetMessage::rawLen() const
 {
-	unsigned encodedLengthOfSize = encodedlength_uint32_t(data.size());
+	return 1 + encodedlength_uint32_t(data.size()) + data.size();
+}
 
-	uint8_t *ret = new uint8_t[1 + encodedLengthOfSize + data.size()];
+void NetMessage::rawDataAppendToVector(std::vector<uint8_t> &output) const
+{
+	unsigned encodedLengthOfSize = encodedlength_uint32_t(data.size());
 
-	ret[0] = type;
+	output.push_back(type);
 
 	uint32_t len = data.size();
 	for (unsigned n = 0; n < encodedLengthOfSize; ++n)
 	{
-		encode_uint32_t(ret[n + 1], len, n);
+		uint8_t b;
+		encode_uint32_t(b, len, n);
+		output.push_back(b);
 	}
 
-	std::copy(data.begin(), data.end(), ret + 1 + encodedLengthOfSize);
-	return ret;
+	output.insert(output.end(), data.begin(), data.end());
 }
 
-size_t NetMessage::rawLen() const
-{
-	return 1 + encodedlength_uint32_t(data.size()) + data.size();
-}
+// Slots whose data buffer grew beyond this are released when popped, so that a single huge message doesn't pin its memory forever.
+static const size_t maxRecycledMessageCapacity = 65536;
 
 NetQueue::NetQueue()
 	: canGetMessagesForNet(true)
 	, canGetMessages(true)
+	, pushSeq(0)
+	, dataSeq(0)
+	, messageSeq(0)
+	, oldSeq(0)
+{}
+
+NetMessage &NetQueue::pushSlot(const NetMessage *copyFrom)
 {
-	dataPos = messages.end();
-	messagePos = messages.end();
+	unsigned used = pushSeq - oldSeq;
+	if (used == ring.size())
+	{
+		// Ring is full, so double it. Only happens until the ring is large enough for the traffic.
+		std::vector<NetMessage> newRing(std::max<size_t>(ring.size()*2, 16));
+		NetMessage &newSlot = newRing[pushSeq & (newRing.size() - 1)];
+		if (copyFrom != NULL)
+		{
+			newSlot = *copyFrom;  // Copy before moving the old slots, in case copyFrom points into our own ring.
+		}
+		for (unsigned seq = oldSeq; seq != pushSeq; ++seq)
+		{
+			NetMessage &dst = newRing[seq & (newRing.size() - 1)];
+			dst.type = slot(seq).type;
+			dst.data.swap(slot(seq).data);
+		}
+		ring.swap(newRing);
+		++pushSeq;
+		return newSlot;
+	}
+
+	NetMessage &newSlot = slot(pushSeq);
+	if (copyFrom != NULL)
+	{
+		newSlot.type = copyFrom->type;
+		newSlot.data.assign(copyFrom->data.begin(), copyFrom->data.end());  // Reuses the old capacity of the slot.
+	}
+	++pushSeq;
+	return newSlot;
 }
 
 void NetQueue::writeRawData(const uint8_t *netData, size_t netLen)
@@ -159,8 +195,9 @@ void NetQueue::writeRawData(const uint8_t *netData, size_t netLen)
 			break;  // Don't have a whole message ready yet.
 		}
 
-		messages.push_front(NetMessage(type));
-		messages.front().data.assign(buffer.begin() + used + headerLen, buffer.begin() + used + headerLen + len);
+		NetMessage &message = pushSlot(NULL);
+		message.type = type;
+		message.data.assign(buffer.begin() + used + headerLen, buffer.begin() + used + headerLen + len);
 		used += headerLen + len;
 	}
 
@@ -175,36 +212,25 @@ void NetQueue::setWillNeverGetMessagesForNet()
 
 unsigned NetQueue::numMessagesForNet() const
 {
-	unsigned count = 0;
-	if (canGetMessagesForNet)
-	{
-		for (List::iterator i = dataPos; i != messages.begin(); --i)
-		{
-			++count;
-		}
-	}
-
-	return count;
+	return canGetMessagesForNet? pushSeq - dataSeq : 0;
 }
 
 const NetMessage &NetQueue::getMessageForNet() const
 {
 	ASSERT(canGetMessagesForNet, "Wrong NetQueue type for getMessageForNet.");
-	ASSERT(dataPos != messages.begin(), "No message to get!");
+	ASSERT(dataSeq != pushSeq, "No message to get!");
 
 	// Return the message.
-	List::iterator i = dataPos;
-	--i;
-	return *i;
+	return slot(dataSeq);
 }
 
 void NetQueue::popMessageForNet()
 {
 	ASSERT(canGetMessagesForNet, "Wrong NetQueue type for popMessageForNet.");
-	ASSERT(dataPos != messages.begin(), "No message to pop!");
+	ASSERT(dataSeq != pushSeq, "No message to pop!");
 
 	// Pop the message.
-	--dataPos;
+	++dataSeq;
 
 	// Recycle old data.
 	popOldMessages();
@@ -212,7 +238,7 @@ void NetQueue::popMessageForNet()
 
 void NetQueue::pushMessage(const NetMessage &message)
 {
-	messages.push_front(message);
+	pushSlot(&message);
 }
 
 void NetQueue::setWillNeverGetMessages()
@@ -223,27 +249,25 @@ void NetQueue::setWillNeverGetMessages()
 bool NetQueue::haveMessage() const
 {
 	ASSERT(canGetMessages, "Wrong NetQueue type for haveMessage.");
-	return messagePos != messages.begin();
+	return messageSeq != pushSeq;
 }
 
 const NetMessage &NetQueue::getMessage() const
 {
 	ASSERT(canGetMessages, "Wrong NetQueue type for getMessage.");
-	ASSERT(messagePos != messages.begin(), "No message to get!");
+	ASSERT(messageSeq != pushSeq, "No message to get!");
 
 	// Return the message.
-	List::iterator i = messagePos;
-	--i;
-	return *i;
+	return slot(messageSeq);
 }
 
 void NetQueue::popMessage()
 {
 	ASSERT(canGetMessages, "Wrong NetQueue type for popMessage.");
-	ASSERT(messagePos != messages.begin(), "No message to pop!");
+	ASSERT(messageSeq != pushSeq, "No message to pop!");
 
 	// Pop the message.
-	--messagePos;
+	++messageSeq;
 
 	// Recycle old data.
 	popOldMessages();
@@ -253,27 +277,21 @@ void NetQueue::popOldMessages()
 {
 	if (!canGetMessagesForNet)
 	{
-		dataPos = messages.begin();
+		dataSeq = pushSeq;
 	}
 	if (!canGetMessages)
 	{
-		messagePos = messages.begin();
+		messageSeq = pushSeq;
 	}
 
-	List::iterator i = messages.end();
-	while (i != dataPos && i != messagePos)
+	// Messages before both dataSeq and messageSeq are no longer needed.
+	unsigned newOldSeq = pushSeq - dataSeq > pushSeq - messageSeq? dataSeq : messageSeq;
+	for (; oldSeq != newOldSeq; ++oldSeq)
 	{
-		--i;
-	}
-
-	if (i == dataPos)
-	{
-		dataPos = messages.end();  // Old iterator will become invalid.
-	}
-	if (i == messagePos)
-	{
-		messagePos = messages.end();  // Old iterator will become invalid.
+		NetMessage &old = slot(oldSeq);
+		if (old.data.capacity() > maxRecycledMessageCapacity)
+		{
+			std::vector<uint8_t>().swap(old.data);
+		}
 	}
-
-	messages.erase(i, messages.end());
 }
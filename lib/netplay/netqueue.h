@@ -45,8 +45,8 @@ class NetMessage
 {
 public:
 	NetMessage(uint8_t type_ = 0xFF) : type(type_) {}
-	uint8_t *rawDataDup() const;  ///< Returns data compatible with NetQueue::writeRawData(). Must be delete[]d.
-	size_t rawLen() const;        ///< Returns the length of the return value of rawDataDup().
+	size_t rawLen() const;        ///< Returns the length of the data appended by rawDataAppendToVector().
+	void rawDataAppendToVector(std::vector<uint8_t> &output) const;  ///< Appends data compatible with NetQueue::writeRawData() to output, so buffers can be reused.
 	uint8_t type;
 	std::vector<uint8_t> data;
 };
@@ -102,6 +102,9 @@ public:
 
 private:
 	void popOldMessages();                                             ///< Pops any messages that are no longer needed.
+	NetMessage &slot(unsigned seq) { return ring[seq & (ring.size() - 1)]; }              ///< Returns the ring slot holding message number seq.
+	const NetMessage &slot(unsigned seq) const { return ring[seq & (ring.size() - 1)]; }  ///< Returns the ring slot holding message number seq.
+	NetMessage &pushSlot(const NetMessage *copyFrom);                  ///< Makes room for one more message, and returns its (recycled) slot.
 
 	// Disable copy constructor and assignment operator.
 	NetQueue(const NetQueue &);         // TODO When switching to C++0x, use "= delete" notation.
@@ -110,10 +113,13 @@ private:
 	bool canGetMessagesForNet;                                         ///< True if we will send the messages over the network, false if we don't.
 	bool canGetMessages;                                               ///< True if we will get the messages, false if we don't use them ourselves.
 
-	typedef std::list<NetMessage> List;
-	List::iterator                dataPos;                             ///< Last message which was sent over the network.
-	List::iterator                messagePos;                          ///< Last message which was popped.
-	List                          messages;                            ///< List of messages. Messages are added to the front and read from the back.
+	// Messages are numbered in the order they were pushed, and stored in a ring of slots. Popped slots keep their data buffers, so that once the ring
+	// has grown large enough, pushing and popping messages does not allocate memory. The sequence numbers may wrap, only differences are compared.
+	unsigned                      pushSeq;                             ///< Number of the next message to be pushed.
+	unsigned                      dataSeq;                             ///< Number of the next message to be sent over the network.
+	unsigned                      messageSeq;                          ///< Number of the next message to be returned by getMessage().
+	unsigned                      oldSeq;                              ///< Number of the oldest message which is still stored.
+	std::vector<NetMessage>       ring;                                ///< Message slots, size is zero or a power of 2.
 	std::vector<uint8_t>          incompleteReceivedMessageData;       ///< Data from network which has not yet formed an entire message.
 };
 
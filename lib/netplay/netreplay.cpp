@@ -0,0 +1,243 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2013  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/**
+ * @file netreplay.cpp
+ *
+ * Replay files.
+ */
+
+#include "netreplay.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+// File format:
+//   "WZRP", version (uint32_t), settings length (uint32_t), settings.
+//   For each message: player (uint8_t), followed by the message, as in NetMessage::rawDataAppendToVector().
+//   End marker: player 0xFF.
+// Integers in the header are big endian.
+
+static const char replayMagic[4] = {'W', 'Z', 'R', 'P'};
+static const uint32_t replayVersion = 1;
+static const uint8_t replayEndMarker = 0xFF;
+static const size_t replayFlushSize = 65536;  ///< Write to the file in chunks of about this size.
+
+static FILE *saveFile = NULL;
+static std::vector<uint8_t> saveBuffer;
+
+static bool loading = false;
+static std::vector<uint8_t> loadData;
+static size_t loadPos = 0;
+static bool loadEnded = false;
+
+static void appendUint32(std::vector<uint8_t> &out, uint32_t v)
+{
+	out.push_back(v>>24);
+	out.push_back(v>>16);
+	out.push_back(v>>8);
+	out.push_back(v);
+}
+
+static bool readUint32(uint32_t *v)
+{
+	if (loadData.size() - loadPos < 4)
+	{
+		return false;
+	}
+	*v = loadData[loadPos]<<24 | loadData[loadPos + 1]<<16 | loadData[loadPos + 2]<<8 | loadData[loadPos + 3];
+	loadPos += 4;
+	return true;
+}
+
+static bool flushSaveBuffer()
+{
+	if (!saveBuffer.empty() && fwrite(&saveBuffer[0], 1, saveBuffer.size(), saveFile) != saveBuffer.size())
+	{
+		debug(LOG_ERROR, "Could not write replay: %s", strerror(errno));
+		return false;
+	}
+	saveBuffer.clear();
+	return true;
+}
+
+bool NETreplaySaveStart(const char *fileName, std::vector<uint8_t> const &settings)
+{
+	NETreplaySaveStop();
+
+	saveFile = fopen(fileName, "wb");
+	if (saveFile == NULL)
+	{
+		debug(LOG_ERROR, "Could not open \"%s\" for writing: %s", fileName, strerror(errno));
+		return false;
+	}
+
+	saveBuffer.assign(replayMagic, replayMagic + sizeof(replayMagic));
+	appendUint32(saveBuffer, replayVersion);
+	appendUint32(saveBuffer, settings.size());
+	saveBuffer.insert(saveBuffer.end(), settings.begin(), settings.end());
+
+	debug(LOG_NET, "Recording replay to \"%s\".", fileName);
+	return true;
+}
+
+void NETreplaySaveNetMessage(NetMessage const *message, uint8_t player)
+{
+	if (saveFile == NULL)
+	{
+		return;
+	}
+
+	saveBuffer.push_back(player);
+	message->rawDataAppendToVector(saveBuffer);
+	if (saveBuffer.size() >= replayFlushSize)
+	{
+		flushSaveBuffer();
+	}
+}
+
+bool NETreplaySaveStop()
+{
+	if (saveFile == NULL)
+	{
+		return false;
+	}
+
+	saveBuffer.push_back(replayEndMarker);
+	bool ok = flushSaveBuffer();
+	if (fclose(saveFile) != 0)
+	{
+		debug(LOG_ERROR, "Could not close replay: %s", strerror(errno));
+		ok = false;
+	}
+	saveFile = NULL;
+	std::vector<uint8_t>().swap(saveBuffer);
+
+	debug(LOG_NET, "Finished recording replay.");
+	return ok;
+}
+
+bool NETreplayLoadStart(const char *fileName, std::vector<uint8_t> &settings)
+{
+	NETreplayLoadStop();
+
+	FILE *file = fopen(fileName, "rb");
+	if (file == NULL)
+	{
+		debug(LOG_ERROR, "Could not open \"%s\" for reading: %s", fileName, strerror(errno));
+		return false;
+	}
+	uint8_t buffer[16384];
+	size_t len;
+	while ((len = fread(buffer, 1, sizeof(buffer), file)) != 0)
+	{
+		loadData.insert(loadData.end(), buffer, buffer + len);
+	}
+	fclose(file);
+
+	uint32_t version = 0, settingsLen = 0;
+	if (loadData.size() < sizeof(replayMagic) || memcmp(&loadData[0], replayMagic, sizeof(replayMagic)) != 0)
+	{
+		debug(LOG_ERROR, "\"%s\" is not a replay.", fileName);
+		NETreplayLoadStop();
+		return false;
+	}
+	loadPos = sizeof(replayMagic);
+	if (!readUint32(&version) || version != replayVersion)
+	{
+		debug(LOG_ERROR, "\"%s\" has unsupported replay version %u.", fileName, version);
+		NETreplayLoadStop();
+		return false;
+	}
+	if (!readUint32(&settingsLen) || loadData.size() - loadPos < settingsLen)
+	{
+		debug(LOG_ERROR, "\"%s\" is truncated.", fileName);
+		NETreplayLoadStop();
+		return false;
+	}
+	settings.assign(loadData.begin() + loadPos, loadData.begin() + loadPos + settingsLen);
+	loadPos += settingsLen;
+
+	loading = true;
+	debug(LOG_NET, "Playing back replay \"%s\".", fileName);
+	return true;
+}
+
+bool NETreplayLoadNetMessage(NetMessage *message, uint8_t *player)
+{
+	if (!loading || loadEnded)
+	{
+		return false;
+	}
+
+	// Need at least the player, message type and one byte of length.
+	if (loadData.size() - loadPos < 3 || loadData[loadPos] == replayEndMarker)
+	{
+		ASSERT(loadPos < loadData.size() && loadData[loadPos] == replayEndMarker, "Replay is truncated.");
+		loadEnded = true;
+		debug(LOG_NET, "Reached the end of the replay.");
+		return false;
+	}
+
+	*player = loadData[loadPos];
+	message->type = loadData[loadPos + 1];
+	size_t headerPos = loadPos + 2;
+
+	uint32_t len = 0;
+	bool moreBytes = true;
+	unsigned n;
+	for (n = 0; moreBytes && headerPos + n < loadData.size(); ++n)
+	{
+		moreBytes = decode_uint32_t(loadData[headerPos + n], len, n);
+	}
+	size_t dataPos = headerPos + n;
+	if (moreBytes || loadData.size() - dataPos < len)
+	{
+		ASSERT(false, "Replay is truncated.");
+		loadEnded = true;
+		return false;
+	}
+
+	message->data.assign(loadData.begin() + dataPos, loadData.begin() + dataPos + len);
+	loadPos = dataPos + len;
+	return true;
+}
+
+void NETreplayLoadStop()
+{
+	loading = false;
+	loadEnded = false;
+	loadPos = 0;
+	std::vector<uint8_t>().swap(loadData);
+}
+
+bool NETreplayIsSaving()
+{
+	return saveFile != NULL;
+}
+
+bool NETreplayIsLoading()
+{
+	return loading;
+}
+
+bool NETreplayHasEnded()
+{
+	return loading && loadEnded;
+}
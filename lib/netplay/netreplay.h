@@ -0,0 +1,46 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2013  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/**
+ * @file netreplay.h
+ *
+ * Records the game queue messages of a game to a file, and plays them back.
+ */
+#ifndef _NET_REPLAY_H_
+#define _NET_REPLAY_H_
+
+#include "netqueue.h"
+
+// A replay file starts with the game settings, as an opaque blob which the game fills in, followed by every game queue message,
+// in the order the messages were processed. Since all clients process the game queues in the same order, and the game state only
+// depends on the settings, the random seed (part of the settings) and the game queue messages, feeding the messages back in the
+// same order replays the game. The GAME_GAME_TIME messages mark the ticks, and carry the checksums used to detect desynchs.
+
+bool NETreplaySaveStart(const char *fileName, std::vector<uint8_t> const &settings);  ///< Starts recording to fileName.
+void NETreplaySaveNetMessage(NetMessage const *message, uint8_t player);               ///< Records a game queue message, when it is processed.
+bool NETreplaySaveStop();                                                              ///< Finishes and closes the file. Does nothing if not recording.
+
+bool NETreplayLoadStart(const char *fileName, std::vector<uint8_t> &settings);        ///< Starts playing back fileName, returning the settings it was recorded with.
+bool NETreplayLoadNetMessage(NetMessage *message, uint8_t *player);                    ///< Returns the next recorded message, or false at the end of the replay.
+void NETreplayLoadStop();                                                              ///< Forgets the replay. Does nothing if not playing back.
+
+bool NETreplayIsSaving();   ///< True if recording.
+bool NETreplayIsLoading();  ///< True if playing back. Game queue messages from the local player are then ignored, since the replay already contains them.
+bool NETreplayHasEnded();   ///< True if playing back, and all recorded messages have been returned.
+
+#endif //_NET_REPLAY_H_
@@ -39,6 +39,7 @@
 #include "nettypes.h"
 #include "netqueue.h"
 #include "netlog.h"
+#include "netreplay.h"
 #include "src/order.h"
 #include <cstring>
 
@@ -464,6 +465,13 @@ bool NETend()
 	// If we are encoding just return true
 	if (NETgetPacketDir() == PACKET_ENCODE)
 	{
+		if ((queueInfo.queueType == QUEUE_GAME || queueInfo.queueType == QUEUE_GAME_FORCED) && NETreplayIsLoading())
+		{
+			// The replay already contains the game queue messages, so ignore any new ones.
+			NETsetPacketDir(PACKET_INVALID);
+			return true;
+		}
+
 		// Push the message onto the list.
 		NetQueue *queue = sendQueue(queueInfo);
 		queue->pushMessage(message);
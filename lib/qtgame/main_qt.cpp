@@ -47,6 +47,11 @@ void wzMain(int &argc, char **argv)
 bool wzMain2(int antialiasing, bool fullscreen, bool vsync)
 {
 	debug(LOG_MAIN, "Qt initialization");
+	if (isHeadless())
+	{
+		debug(LOG_ERROR, "Headless mode needs the SDL backend.");
+		return false;
+	}
 	QGL::setPreferredPaintEngine(QPaintEngine::OpenGL); // Workaround for incorrect text rendering on nany platforms.
 
 	// Setting up OpenGL
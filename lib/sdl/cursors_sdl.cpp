@@ -1278,6 +1278,11 @@ void wzSetCursor(CURSOR cur)
 {
 	ASSERT(cur < CURSOR_MAX, "frameSetCursorFromRes: bad resource ID" );
 
+	if (isHeadless())
+	{
+		return;
+	}
+
 	//If we are already using this cursor then  return
 	if (cur != currentCursor)
         {
@@ -51,6 +51,8 @@ unsigned                screenWidth = 0;   // Declared in screen.h
 unsigned                screenHeight = 0;  // Declared in screen.h
 static unsigned         screenDepth = 0;
 static SDL_Surface *    screen = NULL;
+static uint32_t         headlessTicks = 0;     ///< The time in HEADLESS_FAST mode, advanced by one game tick per main loop.
+static bool             headlessQuit = false;  ///< There is no SDL event queue without a window, so wzQuit sets this instead.
 
 QCoreApplication *appPtr;
 
@@ -317,11 +319,19 @@ QList<QSize> wzAvailableResolutions()
 
 void wzShowMouse(bool visible)
 {
+	if (isHeadless())
+	{
+		return;
+	}
 	SDL_ShowCursor(visible ? SDL_ENABLE : SDL_DISABLE);
 }
 
 int wzGetTicks()
 {
+	if (getHeadlessMode() == HEADLESS_FAST)
+	{
+		return headlessTicks;
+	}
 	return SDL_GetTicks();
 }
 
@@ -332,21 +342,34 @@ void wzFatalDialog(char const*)
 
 void wzScreenFlip()
 {
+	if (isHeadless())
+	{
+		return;
+	}
 	SDL_GL_SwapBuffers();
 }
 
 void wzToggleFullscreen()
 {
+	if (isHeadless())
+	{
+		return;
+	}
 	SDL_WM_ToggleFullScreen(screen);
 }
 
 bool wzIsFullscreen()
 {
-	return screen->flags & SDL_FULLSCREEN;
+	return screen != NULL && (screen->flags & SDL_FULLSCREEN);
 }
 
 void wzQuit()
 {
+	if (isHeadless())
+	{
+		headlessQuit = true;
+		return;
+	}
 	// Create a quit event to halt game loop.
 	SDL_Event quitEvent;
 	quitEvent.type = SDL_QUIT;
@@ -355,11 +378,19 @@ void wzQuit()
 
 void wzGrabMouse()
 {
+	if (isHeadless())
+	{
+		return;
+	}
 	SDL_WM_GrabInput(SDL_GRAB_ON);
 }
 
 void wzReleaseMouse()
 {
+	if (isHeadless())
+	{
+		return;
+	}
 	SDL_WM_GrabInput(SDL_GRAB_OFF);
 }
 
@@ -1094,11 +1125,37 @@ void wzMain(int &argc, char **argv)
 {
 	initKeycodes();
 
-	appPtr = new QApplication(argc, argv);  // For Qt-script.
+	// Need to know about --headless before creating the QApplication, since a GUI QApplication needs a display.
+	// The rest of the option, realtime or fast, is parsed with the other options.
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strncmp(argv[i], "--headless", 10) == 0 && (argv[i][10] == '\0' || argv[i][10] == '='))
+		{
+			setHeadlessMode(HEADLESS_REALTIME);
+		}
+	}
+
+	appPtr = new QApplication(argc, argv, !isHeadless());  // For Qt-script.
 }
 
 bool wzMain2(int antialiasing, bool fullscreen, bool vsync)
 {
+	if (isHeadless())
+	{
+		// No window and no OpenGL context, only the timer.
+		if (SDL_Init(SDL_INIT_TIMER) != 0)
+		{
+			debug(LOG_ERROR, "Error: Could not initialise SDL (%s).\n", SDL_GetError());
+			return false;
+		}
+		// The interface is still laid out, even though it is never drawn, so give it a screen size.
+		screenWidth = MAX(pie_GetVideoBufferWidth(), 640);
+		screenHeight = MAX(pie_GetVideoBufferHeight(), 480);
+		pie_SetVideoBufferWidth(screenWidth);
+		pie_SetVideoBufferHeight(screenHeight);
+		return true;
+	}
+
 	//BEGIN **** Was in old frameInitialise. ****
 
 	if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) != 0)
@@ -1269,7 +1326,7 @@ void wzMain3()
 {
 	SDL_Event event;
 
-	while (true)
+	while (!headlessQuit)
 	{
 		/* Deal with any windows messages */
 		while (SDL_PollEvent(&event))
@@ -1302,12 +1359,24 @@ void wzMain3()
 
 		mainLoop();
 		inputNewFrame();
+
+		if (getHeadlessMode() == HEADLESS_FAST)
+		{
+			headlessTicks += GAME_TICKS_PER_UPDATE;  // Tick again on the next loop, instead of waiting for the real time to catch up.
+		}
+		else if (isHeadless())
+		{
+			SDL_Delay(1);  // Nothing waits for vsync, so don't spin.
+		}
 	}
 }
 
 void wzShutdown()
 {
-	sdlFreeCursors();
+	if (!isHeadless())
+	{
+		sdlFreeCursors();
+	}
 	SDL_Quit();
 	delete appPtr;
 	appPtr = NULL;
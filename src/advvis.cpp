@@ -51,10 +51,10 @@ void	avUpdateTiles( void )
 	{
 		maxLevel = psTile->illumination;
 
-		if (psTile->level > MIN_ILLUM || psTile->tileExploredBits & playermask)	// seen
+		if (psTile->level > MIN_ILLUM || mapTileVision(psTile)->tileExploredBits & playermask)	// seen
 		{
 			// If we are not omniscient, and we are not seeing the tile, and none of our allies see the tile...
-			if (!godMode && !(alliancebits[selectedPlayer] & (satuplinkbits | psTile->sensorBits)))
+			if (!godMode && !(alliancebits[selectedPlayer] & (satuplinkbits | mapTileVision(psTile)->sensorBits)))
 			{
 				maxLevel /= 2;
 			}
@@ -34,6 +34,8 @@
 #include "map.h"
 #include "projectile.h"
 
+#include <map>
+
 /* Weights used for target selection code,
  * target distance is used as 'common currency'
  */
@@ -77,6 +79,38 @@ PlayerMask alliancebits[MAX_PLAYER_SLOTS];
 /// A bitfield for the satellite uplink
 PlayerMask satuplinkbits;
 
+/// The parts of a target's attack weight, and of the checks made on it, which don't depend on the attacker and never change.
+struct AiTargetTerms
+{
+	int typeBonus;       ///< Some droid and structure types have higher priority.
+	uint8_t propulsion;  ///< PROPULSION_TYPE of a droid.
+	uint8_t size;        ///< BODY_SIZE of a droid, or STRUCT_STRENGTH of a structure.
+	bool transporter;    ///< A transporter or super transporter.
+	bool wall;           ///< A wall or wall corner.
+	bool damageable;     ///< A feature which can be damaged.
+};
+
+/// An object a player can fully see, which target selection for that player could consider, see aiTargetCandidates.
+struct AiTargetCandidate
+{
+	GridObject object;
+	bool allied;          ///< aiCheckAlliances(object.psObj->player, player)
+	AiTargetTerms terms;
+};
+
+struct AiTargetCandidateKey
+{
+	bool operator <(AiTargetCandidateKey const &b) const
+	{
+		return player != b.player ? player < b.player : grid < b.grid;
+	}
+	unsigned player;
+	GridSharedKey grid;
+};
+
+static std::vector<AiTargetCandidate> aiCandidates;                                         // Candidates found since the last aiInvalidateTargetCandidates.
+static std::map<AiTargetCandidateKey, std::pair<unsigned, unsigned> > aiCandidateSearches;  // Where in aiCandidates the candidates for each shared search are.
+
 static int aiDroidRange(DROID *psDroid, int weapon_slot)
 {
 	int32_t longRange;
@@ -150,10 +184,149 @@ bool aiInitialise(void)
 		}
 	}
 	satuplinkbits = 0;
+	aiInvalidateTargetCandidates();
 
 	return true;
 }
 
+void aiInvalidateTargetCandidates()
+{
+	aiCandidates.clear();
+	aiCandidateSearches.clear();
+}
+
+static AiTargetTerms aiTargetTerms(BASE_OBJECT *psTarget)
+{
+	AiTargetTerms terms = {0, 0, 0, false, false, false};  // Sensors/ecm droids, non-military structures get lower priority.
+
+	if (psTarget->type == OBJ_DROID)
+	{
+		DROID *psDroid = (DROID *)psTarget;
+
+		/* See if this type of a droid should be prioritized */
+		switch (psDroid->droidType)
+		{
+			case DROID_SENSOR:
+			case DROID_ECM:
+			case DROID_PERSON:
+			case DROID_TRANSPORTER:
+			case DROID_SUPERTRANSPORTER:
+			case DROID_DEFAULT:
+			case DROID_ANY:
+				break;
+
+			case DROID_CYBORG:
+			case DROID_WEAPON:
+			case DROID_CYBORG_SUPER:
+				terms.typeBonus = WEIGHT_WEAPON_DROIDS;
+				break;
+
+			case DROID_COMMAND:
+				terms.typeBonus = WEIGHT_COMMAND_DROIDS;
+				break;
+
+			case DROID_CONSTRUCT:
+			case DROID_REPAIR:
+			case DROID_CYBORG_CONSTRUCT:
+			case DROID_CYBORG_REPAIR:
+				terms.typeBonus = WEIGHT_SERVICE_DROIDS;
+				break;
+		}
+		terms.propulsion = (asPropulsionStats + psDroid->asBits[COMP_PROPULSION])->propulsionType;
+		terms.size = (asBodyStats + psDroid->asBits[COMP_BODY])->size;
+		terms.transporter = psDroid->droidType == DROID_TRANSPORTER || psDroid->droidType == DROID_SUPERTRANSPORTER;
+	}
+	else if (psTarget->type == OBJ_STRUCTURE)
+	{
+		STRUCTURE *psStruct = (STRUCTURE *)psTarget;
+
+		/* See if this type of a structure should be prioritized */
+		switch (psStruct->pStructureType->type)
+		{
+			case REF_DEFENSE:
+				terms.typeBonus = WEIGHT_WEAPON_STRUCT;
+				break;
+
+			case REF_RESOURCE_EXTRACTOR:
+				terms.typeBonus = WEIGHT_DERRICK_STRUCT;
+				break;
+
+			case REF_FACTORY:
+			case REF_CYBORG_FACTORY:
+			case REF_REPAIR_FACILITY:
+				terms.typeBonus = WEIGHT_MILITARY_STRUCT;
+				break;
+			default:
+				break;
+		}
+		terms.size = psStruct->pStructureType->strength;
+		terms.wall = psStruct->pStructureType->type == REF_WALL || psStruct->pStructureType->type == REF_WALLCORNER;
+	}
+	else if (psTarget->type == OBJ_FEATURE)
+	{
+		terms.damageable = ((FEATURE *)psTarget)->psStats->damageable;
+	}
+	return terms;
+}
+
+static AiTargetCandidate aiTargetCandidate(GridObject const &object, unsigned player)
+{
+	AiTargetCandidate candidate = {object, aiCheckAlliances(object.psObj->player, player), aiTargetTerms(object.psObj)};
+	return candidate;
+}
+
+/// Returns the objects which gridStartIterate(x, y, radius) would return, in the same order, except those player can't fully see.
+/// Nearby searches with similar radii share the filtering, see gridSharedKey, so visibility and alliances are checked when the
+/// candidates are found instead of when they are used. aiInvalidateTargetCandidates must be called whenever they change.
+static std::vector<AiTargetCandidate> const &aiTargetCandidates(unsigned player, int32_t x, int32_t y, uint32_t radius)
+{
+	static std::vector<AiTargetCandidate> found;  // static to avoid allocations.
+	found.clear();
+
+	GridSharedKey gridKey;
+	if (!gridSharedKey(gridKey, x, y, radius))
+	{
+		// Too big to share, so check the results of this search only.
+		static GridList gridList;  // static to avoid allocations.
+		gridList = gridStartIterate(x, y, radius);
+		for (GridIterator gi = gridList.begin(); gi != gridList.end(); ++gi)
+		{
+			if ((*gi)->visible[player] == UBYTE_MAX)
+			{
+				GridObject object = {*gi, removeZ((*gi)->pos)};
+				found.push_back(aiTargetCandidate(object, player));
+			}
+		}
+		return found;
+	}
+
+	AiTargetCandidateKey key = {player, gridKey};
+	std::map<AiTargetCandidateKey, std::pair<unsigned, unsigned> >::iterator search = aiCandidateSearches.find(key);
+	if (search == aiCandidateSearches.end())
+	{
+		unsigned count;
+		GridObject const *objects = gridSharedSearch(gridKey, &count);
+		unsigned begin = aiCandidates.size();
+		for (unsigned n = 0; n < count; ++n)
+		{
+			if (objects[n].psObj->visible[player] == UBYTE_MAX)
+			{
+				aiCandidates.push_back(aiTargetCandidate(objects[n], player));
+			}
+		}
+		search = aiCandidateSearches.insert(std::make_pair(key, std::make_pair(begin, (unsigned)aiCandidates.size()))).first;
+	}
+
+	for (unsigned n = search->second.first; n < search->second.second; ++n)
+	{
+		if (gridIsInSearch(aiCandidates[n].object, x, y, radius))
+		{
+			found.push_back(aiCandidates[n]);
+		}
+	}
+	return found;
+}
+
 /* Shutdown the AI system */
 bool aiShutdown(void)
 {
@@ -249,8 +422,8 @@ static BASE_OBJECT *aiSearchSensorTargets(BASE_OBJECT *psObj, int weapon_slot, W
 	return psTarget;
 }
 
-/* Calculates attack priority for a certain target */
-static SDWORD targetAttackWeight(BASE_OBJECT *psTarget, BASE_OBJECT *psAttacker, SDWORD weapon_slot)
+/* Calculates attack priority for a certain target, with terms from aiTargetTerms(psTarget) */
+static SDWORD targetAttackWeight(BASE_OBJECT *psTarget, AiTargetTerms const &terms, BASE_OBJECT *psAttacker, SDWORD weapon_slot)
 {
 	SDWORD			targetTypeBonus=0, damageRatio=0, attackWeight=0, noTarget=-1;
 	UDWORD			weaponSlot;
@@ -266,7 +439,7 @@ static SDWORD targetAttackWeight(BASE_OBJECT *psTarget, BASE_OBJECT *psAttacker,
 	}
 	ASSERT(psTarget != psAttacker, "targetAttackWeight: Wanted to evaluate the worth of attacking ourselves...");
 
-	targetTypeBonus = 0;			//Sensors/ecm droids, non-military structures get lower priority
+	targetTypeBonus = terms.typeBonus;
 
 	/* Get attacker weapon effect */
 	if(psAttacker->type == OBJ_DROID)
@@ -361,39 +534,9 @@ static SDWORD targetAttackWeight(BASE_OBJECT *psTarget, BASE_OBJECT *psAttacker,
 		}
 		assert(targetDroid->originalBody != 0); // Assert later so we get the info from above
 
-		/* See if this type of a droid should be prioritized */
-		switch (targetDroid->droidType)
-		{
-			case DROID_SENSOR:
-			case DROID_ECM:
-			case DROID_PERSON:
-			case DROID_TRANSPORTER:
-			case DROID_SUPERTRANSPORTER:
-			case DROID_DEFAULT:
-			case DROID_ANY:
-				break;
-
-			case DROID_CYBORG:
-			case DROID_WEAPON:
-			case DROID_CYBORG_SUPER:
-				targetTypeBonus = WEIGHT_WEAPON_DROIDS;
-				break;
-
-			case DROID_COMMAND:
-				targetTypeBonus = WEIGHT_COMMAND_DROIDS;
-				break;
-
-			case DROID_CONSTRUCT:
-			case DROID_REPAIR:
-			case DROID_CYBORG_CONSTRUCT:
-			case DROID_CYBORG_REPAIR:
-				targetTypeBonus = WEIGHT_SERVICE_DROIDS;
-				break;
-		}
-
 		/* Now calculate the overall weight */
-		attackWeight = asWeaponModifier[weaponEffect][(asPropulsionStats + targetDroid->asBits[COMP_PROPULSION])->propulsionType] // Our weapon's effect against target
-				+ asWeaponModifierBody[weaponEffect][(asBodyStats + targetDroid->asBits[COMP_BODY])->size]
+		attackWeight = asWeaponModifier[weaponEffect][terms.propulsion] // Our weapon's effect against target
+				+ asWeaponModifierBody[weaponEffect][terms.size]
 				+ WEIGHT_DIST_TILE_DROID * objSensorRange(psAttacker) / TILE_UNITS
 				- WEIGHT_DIST_TILE_DROID * dist/TILE_UNITS // farther droids are less attractive
 				+ WEIGHT_HEALTH_DROID * damageRatio/100 // we prefer damaged droids
@@ -414,28 +557,8 @@ static SDWORD targetAttackWeight(BASE_OBJECT *psTarget, BASE_OBJECT *psAttacker,
 		/* Calculate damage this target suffered */
 		damageRatio = 100 - 100*targetStructure->body / structureBody(targetStructure);
 
-		/* See if this type of a structure should be prioritized */
-		switch(targetStructure->pStructureType->type)
-		{
-			case REF_DEFENSE:
-				targetTypeBonus = WEIGHT_WEAPON_STRUCT;
-				break;
-
-			case REF_RESOURCE_EXTRACTOR:
-				targetTypeBonus = WEIGHT_DERRICK_STRUCT;
-				break;
-
-			case REF_FACTORY:
-			case REF_CYBORG_FACTORY:
-			case REF_REPAIR_FACILITY:
-				targetTypeBonus = WEIGHT_MILITARY_STRUCT;
-				break;
-			default:
-				break;
-		}
-
 		/* Now calculate the overall weight */
-		attackWeight = asStructStrengthModifier[weaponEffect][targetStructure->pStructureType->strength] // Our weapon's effect against target
+		attackWeight = asStructStrengthModifier[weaponEffect][terms.size] // Our weapon's effect against target
 				+ WEIGHT_DIST_TILE_STRUCT * objSensorRange(psAttacker) / TILE_UNITS
 				- WEIGHT_DIST_TILE_STRUCT * dist/TILE_UNITS // farther structs are less attractive
 				+ WEIGHT_HEALTH_STRUCT * damageRatio/100 // we prefer damaged structures
@@ -512,6 +635,16 @@ static SDWORD targetAttackWeight(BASE_OBJECT *psTarget, BASE_OBJECT *psAttacker,
 }
 
 
+/* Calculates attack priority for a certain target */
+static SDWORD targetAttackWeight(BASE_OBJECT *psTarget, BASE_OBJECT *psAttacker, SDWORD weapon_slot)
+{
+	if (psTarget == NULL)
+	{
+		return -1;
+	}
+	return targetAttackWeight(psTarget, aiTargetTerms(psTarget), psAttacker, weapon_slot);
+}
+
 // Find the best nearest target for a droid.
 // If extraRange is higher than zero, then this is the range it accepts for movement to target.
 // Returns integer representing target priority, -1 if failed
@@ -552,57 +685,59 @@ int aiBestNearestTarget(DROID *psDroid, BASE_OBJECT **ppsObj, int weapon_slot, i
 	// Range was previously 9*TILE_UNITS. Increasing this doesn't seem to help much, though. Not sure why.
 	int droidRange = std::min(aiDroidRange(psDroid, weapon_slot) + extraRange, objSensorRange(psDroid) + 6*TILE_UNITS);
 
-	static GridList gridList;  // static to avoid allocations.
-	gridList = gridStartIterate(psDroid->pos.x, psDroid->pos.y, droidRange);
-	for (GridIterator gi = gridList.begin(); gi != gridList.end(); ++gi)
+	static std::vector<AiTargetCandidate> candidates;  // static to avoid allocations.
+	candidates = aiTargetCandidates(psDroid->player, psDroid->pos.x, psDroid->pos.y, droidRange);  // Shared with nearby droids looking for targets this tick.
+	for (unsigned n = 0; n < candidates.size(); ++n)
 	{
 		BASE_OBJECT *friendlyObj = NULL;
-		BASE_OBJECT *targetInQuestion = *gi;
+		BASE_OBJECT *targetInQuestion = candidates[n].object.psObj;
+		AiTargetTerms targetTerms = candidates[n].terms;
 
-		/* This is a friendly unit, check if we can reuse its target */
-		if(aiCheckAlliances(targetInQuestion->player,psDroid->player))
+		/* This is a friendly unit, check if we can reuse its target. We can see what it is doing, since all candidates are fully visible. */
+		if (candidates[n].allied)
 		{
 			friendlyObj = targetInQuestion;
 			targetInQuestion = NULL;
 
-			/* Can we see what it is doing? */
-			if(friendlyObj->visible[psDroid->player] == UBYTE_MAX)
+			if(friendlyObj->type == OBJ_DROID)
 			{
-				if(friendlyObj->type == OBJ_DROID)
-				{
-					DROID	*friendlyDroid = (DROID *)friendlyObj;
+				DROID	*friendlyDroid = (DROID *)friendlyObj;
 
-					/* See if friendly droid has a target */
-					tempTarget = friendlyDroid->psActionTarget[0];
-					if(tempTarget && !tempTarget->died)
+				/* See if friendly droid has a target */
+				tempTarget = friendlyDroid->psActionTarget[0];
+				if(tempTarget && !tempTarget->died)
+				{
+					//make sure a weapon droid is targeting it
+					if(friendlyDroid->numWeaps > 0)
 					{
-						//make sure a weapon droid is targeting it
-						if(friendlyDroid->numWeaps > 0)
+						// make sure this target wasn't assigned explicitly to this droid
+						if (friendlyDroid->order.type != DORDER_ATTACK)
 						{
-							// make sure this target wasn't assigned explicitly to this droid
-							if (friendlyDroid->order.type != DORDER_ATTACK)
-							{
-								targetInQuestion = tempTarget;  //consider this target
-							}
+							targetInQuestion = tempTarget;  //consider this target
 						}
 					}
 				}
-				else if(friendlyObj->type == OBJ_STRUCTURE)
+			}
+			else if(friendlyObj->type == OBJ_STRUCTURE)
+			{
+				tempTarget = ((STRUCTURE*)friendlyObj)->psTarget[0];
+				if (tempTarget && !tempTarget->died)
 				{
-					tempTarget = ((STRUCTURE*)friendlyObj)->psTarget[0];
-					if (tempTarget && !tempTarget->died)
-					{
-						targetInQuestion = tempTarget;
-					}
+					targetInQuestion = tempTarget;
 				}
 			}
+
+			if (targetInQuestion != NULL)
+			{
+				targetTerms = aiTargetTerms(targetInQuestion);
+			}
 		}
 
 		if (targetInQuestion != NULL
 		    && targetInQuestion != psDroid  // in case friendly unit had me as target
 		    && (targetInQuestion->type == OBJ_DROID || targetInQuestion->type == OBJ_STRUCTURE || targetInQuestion->type == OBJ_FEATURE)
-		    && targetInQuestion->visible[psDroid->player] == UBYTE_MAX
-		    && !aiCheckAlliances(targetInQuestion->player,psDroid->player)
+		    && (friendlyObj == NULL  // Candidates are fully visible, and only allied candidates are friendly.
+		        || (targetInQuestion->visible[psDroid->player] == UBYTE_MAX && !aiCheckAlliances(targetInQuestion->player, psDroid->player)))
 		    && validTarget(psDroid, targetInQuestion, weapon_slot)
 		    && objPosDiffSq(psDroid, targetInQuestion) < droidRange*droidRange)
 		{
@@ -612,9 +747,7 @@ int aiBestNearestTarget(DROID *psDroid, BASE_OBJECT **ppsObj, int weapon_slot, i
 				if (bMultiPlayer)
 				{
 					// if not electronic then valid target
-					if (!electronic
-					    || (electronic
-					        && (((DROID *)targetInQuestion)->droidType != DROID_TRANSPORTER && ((DROID *)targetInQuestion)->droidType != DROID_SUPERTRANSPORTER)))
+					if (!electronic || !targetTerms.transporter)
 					{
 						//only a valid target if NOT a transporter
 						psTarget = targetInQuestion;
@@ -642,8 +775,7 @@ int aiBestNearestTarget(DROID *psDroid, BASE_OBJECT **ppsObj, int weapon_slot, i
 					// structure with weapons - go for this
 					psTarget = targetInQuestion;
 				}
-				else if ((psStruct->pStructureType->type != REF_WALL && psStruct->pStructureType->type != REF_WALLCORNER)
-				         || driveModeActive() || (bMultiPlayer && !isHumanPlayer(psDroid->player)))
+				else if (!targetTerms.wall || driveModeActive() || (bMultiPlayer && !isHumanPlayer(psDroid->player)))
 				{
 					psTarget = targetInQuestion;
 				}
@@ -651,7 +783,7 @@ int aiBestNearestTarget(DROID *psDroid, BASE_OBJECT **ppsObj, int weapon_slot, i
 			else if (targetInQuestion->type == OBJ_FEATURE
 			         && psDroid->lastFrustratedTime > 0
 			         && gameTime - psDroid->lastFrustratedTime < FRUSTRATED_TIME
-			         && ((FEATURE *)targetInQuestion)->psStats->damageable
+			         && targetTerms.damageable
 			         && psDroid->player != scavengerPlayer())  // hack to avoid scavs blowing up their nice feature walls
 			{
 				psTarget = targetInQuestion;
@@ -661,7 +793,7 @@ int aiBestNearestTarget(DROID *psDroid, BASE_OBJECT **ppsObj, int weapon_slot, i
 			/* Check if our weapon is most effective against this object */
 			if(psTarget != NULL && psTarget == targetInQuestion)		//was assigned?
 			{
-				newMod = targetAttackWeight(psTarget, (BASE_OBJECT *)psDroid, weapon_slot);
+				newMod = targetAttackWeight(psTarget, targetTerms, (BASE_OBJECT *)psDroid, weapon_slot);
 
 				/* Remember this one if it's our best target so far */
 				if( newMod >= 0 && (newMod > bestMod || bestTarget == NULL))
@@ -749,24 +881,6 @@ void aiObjectAddExpectedDamage(BASE_OBJECT *psObject, SDWORD damage)
 	}
 }
 
-// see if an object is a wall
-static bool aiObjIsWall(BASE_OBJECT *psObj)
-{
-	if (psObj->type != OBJ_STRUCTURE)
-	{
-		return false;
-	}
-
-	if ( ((STRUCTURE *)psObj)->pStructureType->type != REF_WALL &&
-		 ((STRUCTURE *)psObj)->pStructureType->type != REF_WALLCORNER )
-	{
-		return false;
-	}
-
-	return true;
-}
-
-
 /* See if there is a target in range */
 bool aiChooseTarget(BASE_OBJECT *psObj, BASE_OBJECT **ppsTarget, int weapon_slot, bool bUpdateTarget, UWORD *targetOrigin)
 {
@@ -893,18 +1007,18 @@ bool aiChooseTarget(BASE_OBJECT *psObj, BASE_OBJECT **ppsTarget, int weapon_slot
 				srange = objSensorRange(psObj);
 			}
 
-			static GridList gridList;  // static to avoid allocations.
-			gridList = gridStartIterate(psObj->pos.x, psObj->pos.y, srange);
-			for (GridIterator gi = gridList.begin(); gi != gridList.end(); ++gi)
+			static std::vector<AiTargetCandidate> candidates;  // static to avoid allocations.
+			candidates = aiTargetCandidates(psObj->player, psObj->pos.x, psObj->pos.y, srange);
+			for (unsigned n = 0; n < candidates.size(); ++n)
 			{
-				BASE_OBJECT *psCurr = *gi;
-				/* Check that it is a valid target */
+				BASE_OBJECT *psCurr = candidates[n].object.psObj;
+				/* Check that it is a valid target, candidates are all visible */
 				if (psCurr->type != OBJ_FEATURE && !psCurr->died
-				    && !aiCheckAlliances(psCurr->player, psObj->player)
-				    && validTarget(psObj, psCurr, weapon_slot) && psCurr->visible[psObj->player] == UBYTE_MAX
+				    && !candidates[n].allied
+				    && validTarget(psObj, psCurr, weapon_slot)
 				    && aiStructHasRange((STRUCTURE *)psObj, psCurr, weapon_slot))
 				{
-					int newTargetValue = targetAttackWeight(psCurr, psObj, weapon_slot);
+					int newTargetValue = targetAttackWeight(psCurr, candidates[n].terms, psObj, weapon_slot);
 					// See if in sensor range and visible
 					int distSq = objPosDiffSq(psCurr->pos, psObj->pos);
 					if (newTargetValue < targetValue || (newTargetValue == targetValue && distSq >= tarDist))
@@ -976,22 +1090,22 @@ bool aiChooseSensorTarget(BASE_OBJECT *psObj, BASE_OBJECT **ppsTarget)
 		BASE_OBJECT *   psTemp = NULL;
 		int		tarDist = SDWORD_MAX;
 
-		static GridList gridList;  // static to avoid allocations.
-		gridList = gridStartIterate(psObj->pos.x, psObj->pos.y, objSensorRange(psObj));
-		for (GridIterator gi = gridList.begin(); gi != gridList.end(); ++gi)
+		static std::vector<AiTargetCandidate> candidates;  // static to avoid allocations.
+		candidates = aiTargetCandidates(psObj->player, psObj->pos.x, psObj->pos.y, objSensorRange(psObj));
+		for (unsigned n = 0; n < candidates.size(); ++n)
 		{
-			BASE_OBJECT *psCurr = *gi;
+			BASE_OBJECT *psCurr = candidates[n].object.psObj;
 			// Don't target features or doomed/dead objects
 			if (psCurr->type != OBJ_FEATURE && !psCurr->died)
 			{
-				if (!aiCheckAlliances(psCurr->player,psObj->player) && !aiObjIsWall(psCurr))
+				if (!candidates[n].allied && !candidates[n].terms.wall)
 				{
-					// See if in sensor range and visible
+					// See if in sensor range, candidates are all visible
 					const int xdiff = psCurr->pos.x - psObj->pos.x;
 					const int ydiff = psCurr->pos.y - psObj->pos.y;
 					const unsigned int distSq = xdiff * xdiff + ydiff * ydiff;
 
-					if (distSq < radSquared && psCurr->visible[psObj->player] == UBYTE_MAX && distSq < tarDist)
+					if (distSq < radSquared && distSq < tarDist)
 					{
 						psTemp = psCurr;
 						tarDist = distSq;
@@ -57,6 +57,10 @@ bool aiInitialise(void);
 /* Shutdown the AI system */
 bool aiShutdown(void);
 
+/// Call whenever which objects players can fully see, who objects belong to or alliances change, since target selection filters the
+/// objects it considers on them when it first searches an area each tick. gridReset and processVisibility call it every tick.
+void aiInvalidateTargetCandidates(void);
+
 /* Initialise a droid structure for AI */
 //extern bool aiInitDroid(DROID *psDroid);
 
@@ -21,23 +21,29 @@
  *  A* based path finding
  *  See http://en.wikipedia.org/wiki/A*_search_algorithm for more information.
  *  How this works:
- *  * First time (in a given tick)  that some droid  wants to pathfind  to a particular
- *    destination,  the A*  algorithm from source to  destination is used.  The desired
- *    destination,  and the nearest  reachable point  to the  destination is saved in a
- *    Context.
- *  * Second time (in a given tick)  that some droid wants to  pathfind to a particular
- *    destination,  the appropriate  Context is found,  and the A* algorithm is used to
- *    find a path from the nearest reachable point to the destination  (which was saved
- *    earlier), to the source.
- *  * Subsequent times  (in a given tick) that some droid wants to pathfind to a parti-
- *    cular destination,  the path is looked up in appropriate Context.  If the path is
+ *  * First time (with a given blocking map)  that some droid wants to pathfind to a
+ *    particular destination, the A* algorithm from source to destination is used. The
+ *    desired destination,  and the nearest  reachable point to the destination is saved
+ *    in a Context.
+ *  * Second time (with a given blocking map)  that some droid wants to pathfind to a
+ *    particular destination,  the appropriate  Context is found,  and the A* algorithm
+ *    is used to find a path from the  nearest reachable point to the destination (which
+ *    was saved earlier), to the source.
+ *  * Subsequent times (with a given blocking map) that some droid wants to pathfind to
+ *    a particular destination, the path is looked up in appropriate Context. If the path is
  *    not already known,  the A* weights are adjusted, and the previous A*  pathfinding
  *    is continued until the new source is reached.  If the new source is  not reached,
  *    the droid is  on a  different island than the previous droid,  and pathfinding is
  *    restarted from the first step.
- *  Up to 30 pathfinding maps from A* are cached, in a LRU list. The PathNode heap con-
- *  tains the  priority-heap-sorted  nodes which are to be explored.  The path back  is
- *  stored in the PathExploredTile 2D array of tiles.
+ *  Up to 4 pathfinding maps from A* are cached per lane, in a LRU list.  Jobs for the
+ *  same destination always go to the same lane,  so lanes can be processed in parallel
+ *  without affecting the results.  The PathNode heap contains the priority-heap-sorted
+ *  nodes which are to be explored.  The path back is stored in the PathExploredTile 2D
+ *  array of tiles.
+ *  One blocking map is kept per equivalence class of blocking types, packed 32 tiles to
+ *  a word. When structures and features change the map, the blocking maps are patched,
+ *  and if a job may be using a blocking map, the patched version is a copy, and the old
+ *  version is freed once it can no longer be in use.
  */
 
 #ifndef WZ_TESTING
@@ -95,30 +101,63 @@ struct PathExploredTile
 
 struct PathBlockingType
 {
-	uint32_t gameTime;
-
 	PROPULSION_TYPE propulsion;
 	int owner;
 	FPATH_MOVETYPE moveType;
 };
+/// Sector of the abstract graph used for hierarchical path-finding.
+struct PathSector
+{
+	std::vector<PathCoord> nodes;   ///< Entrance tiles on the edges of this sector.
+	std::vector<unsigned> costs;    ///< costs[a + b*nodes.size()] is the cost of going from node a to node b without leaving the sector, or UINT32_MAX if impossible.
+};
+
+/// Abstract graph for hierarchical path-finding. The nodes are entrances between neighbouring sectors.
+struct PathAbstractGraph
+{
+	PathAbstractGraph() : sectorsX(0), sectorsY(0) {}
+
+	int sectorsX, sectorsY;           ///< Size of the map in sectors.
+	std::vector<PathSector> sectors;  ///< Sectors, empty if the graph has not been built.
+};
+
+/// Returns bit i of a bitmap packed 32 bits to a word.
+static inline bool fpathTestBit(std::vector<uint32_t> const &bits, unsigned i)
+{
+	return (bits[i/32] >> i%32 & 1) != 0;
+}
+
 /// Pathfinding blocking map
 struct PathBlockingMap
 {
+	PathBlockingMap() : generation(0), published(false), checksumMap(0), checksumDangerMap(0) {}
 	bool operator ==(PathBlockingType const &z) const
 	{
-		return type.gameTime == z.gameTime &&
-		       fpathIsEquivalentBlocking(type.propulsion, type.owner, type.moveType,
+		return fpathIsEquivalentBlocking(type.propulsion, type.owner, type.moveType,
 		                                    z.propulsion,    z.owner,    z.moveType);
 	}
+	bool isBlocked(int x, int y) const
+	{
+		return x < 0 || y < 0 || x >= mapWidth || y >= mapHeight || fpathTestBit(map, x + y*mapWidth);
+	}
+	bool isDangerous(int x, int y) const
+	{
+		return !dangerMap.empty() && fpathTestBit(dangerMap, x + y*mapWidth);
+	}
 
 	PathBlockingType type;
-	std::vector<bool> map;
-	std::vector<bool> dangerMap;	// using threatBits
+	uint32_t generation;              ///< Different for every version of every map, so contexts can tell whether the map changed.
+	bool published;                   ///< Set once a job may be using this version of the map, after which it must not be changed.
+	uint32_t checksumMap, checksumDangerMap;
+	std::vector<uint32_t> map;        ///< Bit per tile, set if blocking.
+	std::vector<uint32_t> dangerMap;  ///< Bit per tile, set if threatened (using threatBits). Empty if danger is ignored.
+	PathAbstractGraph graph;          ///< Only built when the first long route using this map is requested.
+	std::vector<bool> dirtySectors;   ///< Sectors of the graph whose tiles changed since the graph was updated, empty if none.
 };
 
 struct PathNonblockingArea
 {
-	PathNonblockingArea() {}
+	PathNonblockingArea() : x1(0), x2(0), y1(0), y2(0) {}
 	PathNonblockingArea(StructureBounds const &st) : x1(st.map.x), x2(st.map.x + st.size.x), y1(st.map.y), y2(st.map.y + st.size.y) {}
 	bool operator ==(PathNonblockingArea const &z) const { return x1 == z.x1 && x2 == z.x2 && y1 == z.y1 && y2 == z.y2; }
 	bool operator !=(PathNonblockingArea const &z) const { return !(*this == z); }
@@ -133,7 +172,7 @@ struct PathNonblockingArea
 // Data structures used for pathfinding, can contain cached results.
 struct PathfindContext
 {
-	PathfindContext() : myGameTime(0), iteration(0), blockingMap(NULL) {}
+	PathfindContext() : myGeneration(0), iteration(0), blockingMap(NULL) {}
 	bool isBlocked(int x, int y) const
 	{
 		if (dstIgnore.isNonblocking(x, y))
@@ -141,23 +180,23 @@ struct PathfindContext
 			return false;  // The path is actually blocked here by a structure, but ignore it since it's where we want to go (or where we came from).
 		}
 		// Not sure whether the out-of-bounds check is needed, can only happen if pathfinding is started on a blocking tile (or off the map).
-		return x < 0 || y < 0 || x >= mapWidth || y >= mapHeight || blockingMap->map[x + y*mapWidth];
+		return blockingMap->isBlocked(x, y);
 	}
 	bool isDangerous(int x, int y) const
 	{
-		return !blockingMap->dangerMap.empty() && blockingMap->dangerMap[x + y*mapWidth];
+		return blockingMap->isDangerous(x, y);
 	}
 	bool matches(PathBlockingMap const *blockingMap_, PathCoord tileS_, PathNonblockingArea dstIgnore_) const
 	{
-		// Must check myGameTime == blockingMap_->type.gameTime, otherwise blockingMap could be a deleted pointer which coincidentally compares equal to the valid pointer blockingMap_.
-		return myGameTime == blockingMap_->type.gameTime && blockingMap == blockingMap_ && tileS == tileS_ && dstIgnore == dstIgnore_;
+		// Must check myGeneration == blockingMap_->generation, otherwise blockingMap could be a deleted pointer which coincidentally compares equal to the valid pointer blockingMap_.
+		return myGeneration == blockingMap_->generation && blockingMap == blockingMap_ && tileS == tileS_ && dstIgnore == dstIgnore_;
 	}
 	void assign(PathBlockingMap const *blockingMap_, PathCoord tileS_, PathNonblockingArea dstIgnore_)
 	{
 		blockingMap = blockingMap_;
 		tileS = tileS_;
 		dstIgnore = dstIgnore_;
-		myGameTime = blockingMap->type.gameTime;
+		myGeneration = blockingMap->generation;
 		nodes.clear();
 
 		// Make the iteration not match any value of iteration in map.
@@ -170,7 +209,7 @@ struct PathfindContext
 	}
 
 	PathCoord       tileS;                // Start tile for pathfinding. (May be either source or target tile.)
-	uint32_t        myGameTime;
+	uint32_t        myGeneration;
 
 	PathCoord       nearestCoord;         // Nearest reachable tile to destination.
 
@@ -186,15 +225,51 @@ struct PathfindContext
 	PathNonblockingArea dstIgnore;      ///< Area of structure at destination which should be considered nonblocking.
 };
 
-/// Last recently used list of contexts.
-static std::list<PathfindContext> fpathContexts;
+/// Data used by a single lane of the path-finding system. Only one thread at a time works on a given lane.
+struct PathfindLane
+{
+	std::list<PathfindContext> contexts;  ///< Last recently used list of contexts.
+	std::vector<Vector2i> path;           ///< Route being built, kept between calls to save allocations.
+	std::vector<PathCoord> tiles;         ///< Route found by hierarchical path-finding, kept between calls to save allocations.
+};
+
+/// Lanes of the path-finding system, indexed by PATHJOB::lane.
+static PathfindLane fpathLanes[FPATH_LANES];
 
-/// Lists of blocking maps from current tick.
+/// Game state which the blocking maps depend on, other than the tiles themselves. If it changes, the blocking maps are rebuilt.
+struct PathMapState
+{
+	bool operator ==(PathMapState const &z) const
+	{
+		return width == z.width && height == z.height && scrollMinX == z.scrollMinX && scrollMinY == z.scrollMinY && scrollMaxX == z.scrollMaxX && scrollMaxY == z.scrollMaxY
+		    && blockMap == z.blockMap && auxMap == z.auxMap;
+	}
+	bool operator !=(PathMapState const &z) const { return !(*this == z); }
+
+	int width, height;
+	int scrollMinX, scrollMinY, scrollMaxX, scrollMaxY;
+	uint8_t const *blockMap, *auxMap;  ///< Swapped when switching between the mission and home maps.
+};
+
+/// Maximum number of changed areas to patch, before giving up and rebuilding the blocking maps from scratch.
+#define FPATH_MAX_CHANGED_AREAS 256
+
+/// Latest version of the blocking map for each type of blocking map. Only used from the main thread.
 static std::list<PathBlockingMap> fpathBlockingMaps;
-/// Lists of blocking maps from previous tick, will be cleared next tick (since it will be no longer needed after that).
-static std::list<PathBlockingMap> fpathPrevBlockingMaps;
-/// Game time for all blocking maps in fpathBlockingMaps.
+/// Versions of blocking maps replaced during the current tick, which jobs may still be using.
+static std::list<PathBlockingMap> fpathRetiredBlockingMaps;
+/// Versions of blocking maps replaced during the previous tick, will be cleared next tick (since they will be no longer needed after that).
+static std::list<PathBlockingMap> fpathPrevRetiredBlockingMaps;
+/// Game time when fpathRetiredBlockingMaps was started.
 static uint32_t fpathCurrentGameTime;
+/// Last value used for PathBlockingMap::generation.
+static uint32_t fpathLastBlockingMapGeneration;
+/// Map state the blocking maps in fpathBlockingMaps were built for.
+static PathMapState fpathMapState;
+/// Areas of the map where blocking bits changed since the blocking maps were last patched.
+static std::vector<StructureBounds> fpathChangedAreas;
+/// Players whose threat bits changed since the blocking maps were last patched.
+static bool fpathDangerChanged[MAX_PLAYERS];
 
 // Convert a direction into an offset
 // dir 0 => x = 0, y = -1
@@ -212,9 +287,15 @@ static const Vector2i aDirOffset[] =
 
 void fpathHardTableReset()
 {
-	fpathContexts.clear();
+	for (unsigned lane = 0; lane < FPATH_LANES; ++lane)
+	{
+		fpathLanes[lane].contexts.clear();
+	}
 	fpathBlockingMaps.clear();
-	fpathPrevBlockingMaps.clear();
+	fpathRetiredBlockingMaps.clear();
+	fpathPrevRetiredBlockingMaps.clear();
+	fpathChangedAreas.clear();
+	std::fill(fpathDangerChanged, fpathDangerChanged + MAX_PLAYERS, false);
 }
 
 /** Get the nearest entry in the open list
@@ -420,6 +501,304 @@ static void fpathInitContext(PathfindContext &context, PathBlockingMap const *bl
 	ASSERT(!context.nodes.empty(), "fpathNewNode failed to add node.");
 }
 
+/** Hierarchical path-finding
+ *  The map is divided into sectors of FPATH_SECTOR_SIZE×FPATH_SECTOR_SIZE tiles. Where two neighbouring sectors can be
+ *  crossed, one or two entrance tiles are placed on each side of the border, and the cost of moving between the entrances
+ *  of each sector is stored. Long routes are first found on this small graph of entrances, then refined by searching each
+ *  sector along the route separately, so the number of tiles explored grows with the length of the route rather than
+ *  with the area around it.
+ */
+
+/// Size of the sectors of the abstract graph, in tiles.
+#define FPATH_SECTOR_SIZE 16
+/// Routes shorter than this number of tiles are found with plain A*.
+#define FPATH_HIERARCHICAL_MIN_DIST (3*FPATH_SECTOR_SIZE)
+
+/// Node of the searches used for hierarchical path-finding.
+struct PathSearchNode
+{
+	PathSearchNode(unsigned est_, unsigned index_) : est(est_), index(index_) {}
+	bool operator <(PathSearchNode const &z) const
+	{
+		// Sort ascending est, fallback to index, so that std::push_heap puts the cheapest node first.
+		if (est != z.est) return est > z.est;
+		                  return index > z.index;
+	}
+
+	unsigned est;                   ///< Estimated total cost (or exact cost, for Dijkstra).
+	unsigned index;                 ///< Which node.
+};
+
+static inline bool fpathIsLongRoute(PATHJOB const *psJob)
+{
+	int dx = abs(map_coord(psJob->origX) - map_coord(psJob->destX));
+	int dy = abs(map_coord(psJob->origY) - map_coord(psJob->destY));
+	return std::max(dx, dy) >= FPATH_HIERARCHICAL_MIN_DIST;
+}
+
+static inline bool fpathSectorBlocked(PathBlockingMap const &blockingMap, PathNonblockingArea const &dstIgnore, int x, int y)
+{
+	return !dstIgnore.isNonblocking(x, y) && blockingMap.isBlocked(x, y);
+}
+
+static inline int fpathSectorOf(PathAbstractGraph const &graph, PathCoord p)
+{
+	return p.x/FPATH_SECTOR_SIZE + p.y/FPATH_SECTOR_SIZE*graph.sectorsX;
+}
+
+/// Returns the top left tile of the sector.
+static inline PathCoord fpathSectorCorner(int sector, int sectorsX)
+{
+	return PathCoord(sector%sectorsX*FPATH_SECTOR_SIZE, sector/sectorsX*FPATH_SECTOR_SIZE);
+}
+
+/** Dijkstra search from src, without leaving the FPATH_SECTOR_SIZE×FPATH_SECTOR_SIZE window with the given top left
+ *  corner, which is usually a sector. dist and prevDir are indexed by the tile offset from the corner, prevDir is the
+ *  index in aDirOffset of the last step to reach each tile.
+ */
+static void fpathSectorSearch(PathBlockingMap const &blockingMap, PathNonblockingArea const &dstIgnore, PathCoord corner, PathCoord src,
+                              unsigned dist[FPATH_SECTOR_SIZE*FPATH_SECTOR_SIZE], uint8_t prevDir[FPATH_SECTOR_SIZE*FPATH_SECTOR_SIZE])
+{
+	const int x0 = corner.x, x1 = std::min(x0 + FPATH_SECTOR_SIZE, mapWidth);
+	const int y0 = corner.y, y1 = std::min(y0 + FPATH_SECTOR_SIZE, mapHeight);
+
+	std::fill(dist, dist + FPATH_SECTOR_SIZE*FPATH_SECTOR_SIZE, UINT32_MAX);
+	std::vector<PathSearchNode> nodes;
+
+	unsigned srcIndex = (src.x - x0) + (src.y - y0)*FPATH_SECTOR_SIZE;
+	dist[srcIndex] = 0;
+	nodes.push_back(PathSearchNode(0, srcIndex));
+	while (!nodes.empty())
+	{
+		PathSearchNode node = nodes.front();
+		std::pop_heap(nodes.begin(), nodes.end());
+		nodes.pop_back();
+		if (node.est != dist[node.index])
+		{
+			continue;  // Already found a shorter way here.
+		}
+
+		PathCoord p(x0 + node.index%FPATH_SECTOR_SIZE, y0 + node.index/FPATH_SECTOR_SIZE);
+		for (unsigned dir = 0; dir < ARRAY_SIZE(aDirOffset); ++dir)
+		{
+			int x = p.x + aDirOffset[dir].x;
+			int y = p.y + aDirOffset[dir].y;
+			if (x < x0 || x >= x1 || y < y0 || y >= y1 || fpathSectorBlocked(blockingMap, dstIgnore, x, y))
+			{
+				continue;
+			}
+			// We cannot cut corners, same as in fpathAStarExplore.
+			if (dir % 2 != 0 && !dstIgnore.isNonblocking(p.x, p.y) && !dstIgnore.isNonblocking(x, y)
+			 && (blockingMap.isBlocked(p.x + aDirOffset[(dir + 1) % 8].x, p.y + aDirOffset[(dir + 1) % 8].y)
+			  || blockingMap.isBlocked(p.x + aDirOffset[(dir + 7) % 8].x, p.y + aDirOffset[(dir + 7) % 8].y)))
+			{
+				continue;
+			}
+
+			unsigned costFactor = blockingMap.isDangerous(x, y) ? 5 : 1;
+			unsigned newDist = node.est + fpathEstimate(p, PathCoord(x, y))*costFactor;
+			unsigned index = (x - x0) + (y - y0)*FPATH_SECTOR_SIZE;
+			if (newDist < dist[index])
+			{
+				dist[index] = newDist;
+				prevDir[index] = dir;
+				nodes.push_back(PathSearchNode(newDist, index));
+				std::push_heap(nodes.begin(), nodes.end());
+			}
+		}
+	}
+}
+
+/// Appends the route found by fpathSectorSearch from its source to dest, excluding the source tile, to path.
+static void fpathSectorTrace(PathCoord corner, uint8_t const prevDir[FPATH_SECTOR_SIZE*FPATH_SECTOR_SIZE], PathCoord src, PathCoord dest, std::vector<PathCoord> &path)
+{
+	const int x0 = corner.x;
+	const int y0 = corner.y;
+
+	size_t begin = path.size();
+	for (PathCoord p = dest; p != src; )
+	{
+		ASSERT_OR_RETURN(, path.size() - begin < FPATH_SECTOR_SIZE*FPATH_SECTOR_SIZE, "Pathfinding got in a loop.");
+		path.push_back(p);
+		Vector2i offset = aDirOffset[prevDir[(p.x - x0) + (p.y - y0)*FPATH_SECTOR_SIZE]];
+		p = PathCoord(p.x - offset.x, p.y - offset.y);
+	}
+	std::reverse(path.begin() + begin, path.end());
+}
+
+/// Use the abstract graph to find a route. Returns ASR_FAILED if no route was found, in which case plain A* should be tried.
+static ASR_RETVAL fpathHierarchicalRoute(std::vector<PathCoord> &tiles, PATHJOB *psJob)
+{
+	PathBlockingMap const &blockingMap = *psJob->blockingMap;
+	PathAbstractGraph const &graph = blockingMap.graph;
+	const PathCoord tileOrig(map_coord(psJob->origX), map_coord(psJob->origY));
+	const PathCoord tileDest(map_coord(psJob->destX), map_coord(psJob->destY));
+	const PathNonblockingArea dstIgnore(psJob->dstStructure);
+
+	if (fpathSectorBlocked(blockingMap, dstIgnore, tileOrig.x, tileOrig.y) || fpathSectorBlocked(blockingMap, dstIgnore, tileDest.x, tileDest.y))
+	{
+		return ASR_FAILED;
+	}
+
+	// Number the nodes of all sectors consecutively, followed by the origin and destination.
+	std::vector<unsigned> firstNode(graph.sectors.size() + 1, 0);
+	for (unsigned sector = 0; sector < graph.sectors.size(); ++sector)
+	{
+		firstNode[sector + 1] = firstNode[sector] + graph.sectors[sector].nodes.size();
+	}
+	const unsigned origNode = firstNode.back(), destNode = origNode + 1;
+	const int origSector = fpathSectorOf(graph, tileOrig), destSector = fpathSectorOf(graph, tileDest);
+
+	// Find the costs from the origin to the entrances of its sector, and from the entrances of the destination sector to the destination.
+	unsigned origDist[FPATH_SECTOR_SIZE*FPATH_SECTOR_SIZE], destDist[FPATH_SECTOR_SIZE*FPATH_SECTOR_SIZE];
+	uint8_t prevDir[FPATH_SECTOR_SIZE*FPATH_SECTOR_SIZE];
+	fpathSectorSearch(blockingMap, dstIgnore, fpathSectorCorner(origSector, graph.sectorsX), tileOrig, origDist, prevDir);
+	fpathSectorSearch(blockingMap, dstIgnore, fpathSectorCorner(destSector, graph.sectorsX), tileDest, destDist, prevDir);
+
+	// A* on the abstract graph.
+	std::vector<unsigned> dist(destNode + 1, UINT32_MAX);
+	std::vector<unsigned> prev(destNode + 1, UINT32_MAX);
+	std::vector<PathSearchNode> nodes;
+	dist[origNode] = 0;
+	nodes.push_back(PathSearchNode(fpathGoodEstimate(tileOrig, tileDest), origNode));
+	while (!nodes.empty() && nodes.front().index != destNode)
+	{
+		PathSearchNode node = nodes.front();
+		std::pop_heap(nodes.begin(), nodes.end());
+		nodes.pop_back();
+
+		unsigned nodeDist = dist[node.index];
+		int sector;
+		PathCoord p;
+		unsigned local;
+		if (node.index == origNode)
+		{
+			sector = origSector;
+			p = tileOrig;
+			local = UINT32_MAX;
+		}
+		else
+		{
+			sector = std::upper_bound(firstNode.begin(), firstNode.end(), node.index) - firstNode.begin() - 1;
+			local = node.index - firstNode[sector];
+			p = graph.sectors[sector].nodes[local];
+		}
+		if (node.est != nodeDist + fpathGoodEstimate(p, tileDest))
+		{
+			continue;  // Already found a shorter way here.
+		}
+
+		PathSector const &psSector = graph.sectors[sector];
+		const int x0 = sector%graph.sectorsX*FPATH_SECTOR_SIZE;
+		const int y0 = sector/graph.sectorsX*FPATH_SECTOR_SIZE;
+		const unsigned numNodes = psSector.nodes.size();
+
+		// Edges to the other entrances of the sector.
+		for (unsigned other = 0; other < numNodes; ++other)
+		{
+			PathCoord q = psSector.nodes[other];
+			unsigned cost = local == UINT32_MAX? origDist[(q.x - x0) + (q.y - y0)*FPATH_SECTOR_SIZE] : psSector.costs[local + other*numNodes];
+			unsigned index = firstNode[sector] + other;
+			if (cost != UINT32_MAX && nodeDist + cost < dist[index])
+			{
+				dist[index] = nodeDist + cost;
+				prev[index] = node.index;
+				nodes.push_back(PathSearchNode(dist[index] + fpathGoodEstimate(q, tileDest), index));
+				std::push_heap(nodes.begin(), nodes.end());
+			}
+		}
+		// Edge to the destination.
+		if (sector == destSector && local != UINT32_MAX)
+		{
+			unsigned cost = destDist[(p.x - x0) + (p.y - y0)*FPATH_SECTOR_SIZE];
+			if (cost != UINT32_MAX && nodeDist + cost < dist[destNode])
+			{
+				dist[destNode] = nodeDist + cost;
+				prev[destNode] = node.index;
+				nodes.push_back(PathSearchNode(dist[destNode], destNode));
+				std::push_heap(nodes.begin(), nodes.end());
+			}
+		}
+		// Edges across the sector borders, to the entrance on the other side.
+		for (unsigned dir = 0; dir < ARRAY_SIZE(aDirOffset) && local != UINT32_MAX; dir += 2)
+		{
+			PathCoord q(p.x + aDirOffset[dir].x, p.y + aDirOffset[dir].y);
+			if (q.x < 0 || q.y < 0 || q.x >= mapWidth || q.y >= mapHeight || fpathSectorOf(graph, q) == sector)
+			{
+				continue;
+			}
+			int otherSector = fpathSectorOf(graph, q);
+			std::vector<PathCoord> const &otherNodes = graph.sectors[otherSector].nodes;
+			std::vector<PathCoord>::const_iterator i = std::find(otherNodes.begin(), otherNodes.end(), q);
+			if (i == otherNodes.end())
+			{
+				continue;
+			}
+			unsigned costFactor = blockingMap.isDangerous(q.x, q.y) ? 5 : 1;
+			unsigned index = firstNode[otherSector] + (i - otherNodes.begin());
+			unsigned newDist = nodeDist + fpathEstimate(p, q)*costFactor;
+			if (newDist < dist[index])
+			{
+				dist[index] = newDist;
+				prev[index] = node.index;
+				nodes.push_back(PathSearchNode(newDist + fpathGoodEstimate(q, tileDest), index));
+				std::push_heap(nodes.begin(), nodes.end());
+			}
+		}
+	}
+	if (dist[destNode] == UINT32_MAX)
+	{
+		return ASR_FAILED;  // Destination unreachable, or only reachable by a route which leaves and reenters a sector.
+	}
+
+	// Get the list of entrances along the route.
+	std::vector<unsigned> route;
+	for (unsigned index = destNode; index != UINT32_MAX; index = prev[index])
+	{
+		route.push_back(index);
+	}
+	std::reverse(route.begin(), route.end());
+
+	// Refine the route, by finding the route between consecutive entrances in the same sector.
+	tiles.clear();
+	tiles.push_back(tileOrig);
+	for (unsigned i = 1; i < route.size(); ++i)
+	{
+		PathCoord from = tiles.back();
+		PathCoord to = tileDest;
+		if (route[i] != destNode)
+		{
+			int sector = std::upper_bound(firstNode.begin(), firstNode.end(), route[i]) - firstNode.begin() - 1;
+			to = graph.sectors[sector].nodes[route[i] - firstNode[sector]];
+		}
+		int sector = fpathSectorOf(graph, from);
+		if (sector != fpathSectorOf(graph, to))
+		{
+			tiles.push_back(to);  // Step across a sector border.
+			continue;
+		}
+		fpathSectorSearch(blockingMap, dstIgnore, fpathSectorCorner(sector, graph.sectorsX), from, origDist, prevDir);
+		fpathSectorTrace(fpathSectorCorner(sector, graph.sectorsX), prevDir, from, to, tiles);
+	}
+
+	return ASR_OK;
+}
+
+/// Sets the route of psMove to go through the centre of each of the tiles, ending exactly at the destination.
+static ASR_RETVAL fpathCopyTileRoute(MOVE_CONTROL *psMove, PATHJOB *psJob, std::vector<PathCoord> const &tiles)
+{
+	psMove->numPoints = tiles.size();
+	psMove->asPath = static_cast<Vector2i *>(malloc(sizeof(*psMove->asPath) * tiles.size()));
+	ASSERT_OR_RETURN(ASR_FAILED, psMove->asPath, "Out of memory");
+	for (unsigned i = 0; i < tiles.size(); ++i)
+	{
+		psMove->asPath[i] = Vector2i(world_coord(tiles[i].x) + TILE_UNITS/2, world_coord(tiles[i].y) + TILE_UNITS/2);
+	}
+	psMove->asPath[tiles.size() - 1] = Vector2i(psJob->destX, psJob->destY);
+	psMove->destination = psMove->asPath[tiles.size() - 1];
+	return ASR_OK;
+}
+
 ASR_RETVAL fpathAStarRoute(MOVE_CONTROL *psMove, PATHJOB *psJob)
 {
 	ASR_RETVAL      retval = ASR_OK;
@@ -432,6 +811,19 @@ ASR_RETVAL fpathAStarRoute(MOVE_CONTROL *psMove, PATHJOB *psJob)
 
 	PathCoord endCoord;  // Either nearest coord (mustReverse = true) or orig (mustReverse = false).
 
+	ASSERT_OR_RETURN(ASR_FAILED, psJob->lane < FPATH_LANES, "Bad path-finding lane %u", psJob->lane);
+	std::list<PathfindContext> &fpathContexts = fpathLanes[psJob->lane].contexts;
+
+	if (fpathIsLongRoute(psJob) && !psJob->blockingMap->graph.sectors.empty())
+	{
+		std::vector<PathCoord> &tiles = fpathLanes[psJob->lane].tiles;
+		if (fpathHierarchicalRoute(tiles, psJob) == ASR_OK)
+		{
+			return fpathCopyTileRoute(psMove, psJob, tiles);
+		}
+		// No route found on the abstract graph, so try plain A*, which can also find the nearest reachable tile.
+	}
+
 	std::list<PathfindContext>::iterator contextIterator = fpathContexts.begin();
 	for (contextIterator = fpathContexts.begin(); contextIterator != fpathContexts.end(); ++contextIterator)
 	{
@@ -470,7 +862,7 @@ ASR_RETVAL fpathAStarRoute(MOVE_CONTROL *psMove, PATHJOB *psJob)
 	{
 		// We did not find an appropriate context. Make one.
 
-		if (fpathContexts.size() < 30)
+		if (fpathContexts.size() < 4)
 		{
 			fpathContexts.push_back(PathfindContext());
 		}
@@ -492,7 +884,7 @@ ASR_RETVAL fpathAStarRoute(MOVE_CONTROL *psMove, PATHJOB *psJob)
 	}
 
 	// Get route, in reverse order.
-	static std::vector<Vector2i> path;  // Declared static to save allocations.
+	std::vector<Vector2i> &path = fpathLanes[psJob->lane].path;  // Kept in the lane to save allocations.
 	path.clear();
 
 	Vector2i newP;
@@ -543,7 +935,7 @@ ASR_RETVAL fpathAStarRoute(MOVE_CONTROL *psMove, PATHJOB *psJob)
 	ASSERT(psMove->asPath, "Out of memory");
 	if (!psMove->asPath)
 	{
-		fpathHardTableReset();
+		fpathContexts.clear();  // Other lanes may be in use by other threads, so only clear our own.
 		return ASR_FAILED;
 	}
 
@@ -586,19 +978,417 @@ ASR_RETVAL fpathAStarRoute(MOVE_CONTROL *psMove, PATHJOB *psJob)
 	return retval;
 }
 
+/// Returns the distance to p found by fpathSectorSearch, or UINT32_MAX if p is outside the window or unreachable.
+static inline unsigned fpathWindowDist(unsigned const dist[FPATH_SECTOR_SIZE*FPATH_SECTOR_SIZE], PathCoord corner, PathCoord p)
+{
+	int x = p.x - corner.x, y = p.y - corner.y;
+	if (x < 0 || y < 0 || x >= FPATH_SECTOR_SIZE || y >= FPATH_SECTOR_SIZE)
+	{
+		return UINT32_MAX;
+	}
+	return dist[x + y*FPATH_SECTOR_SIZE];
+}
+
+static inline Vector2i fpathTileCentre(PathCoord p)
+{
+	return Vector2i(world_coord(p.x) + TILE_UNITS/2, world_coord(p.y) + TILE_UNITS/2);
+}
+
+ASR_RETVAL fpathJoinRoute(MOVE_CONTROL *psMove, PATHJOB const *psJob, Vector2i const *route, int numPoints)
+{
+	PathBlockingMap const &blockingMap = *psJob->blockingMap;
+	const PathCoord tileOrig(map_coord(psJob->origX), map_coord(psJob->origY));
+	const PathCoord tileDest(map_coord(psJob->destX), map_coord(psJob->destY));
+	const PathNonblockingArea dstIgnore(psJob->dstStructure);
+	const PathCoord origCorner(tileOrig.x - FPATH_SECTOR_SIZE/2, tileOrig.y - FPATH_SECTOR_SIZE/2);
+	const PathCoord destCorner(tileDest.x - FPATH_SECTOR_SIZE/2, tileDest.y - FPATH_SECTOR_SIZE/2);
+
+	if (numPoints <= 0 || fpathSectorBlocked(blockingMap, dstIgnore, tileOrig.x, tileOrig.y) || fpathSectorBlocked(blockingMap, dstIgnore, tileDest.x, tileDest.y))
+	{
+		return ASR_FAILED;
+	}
+
+	unsigned origDist[FPATH_SECTOR_SIZE*FPATH_SECTOR_SIZE], destDist[FPATH_SECTOR_SIZE*FPATH_SECTOR_SIZE];
+	uint8_t origPrevDir[FPATH_SECTOR_SIZE*FPATH_SECTOR_SIZE], destPrevDir[FPATH_SECTOR_SIZE*FPATH_SECTOR_SIZE];
+	fpathSectorSearch(blockingMap, dstIgnore, origCorner, tileOrig, origDist, origPrevDir);
+	fpathSectorSearch(blockingMap, dstIgnore, destCorner, tileDest, destDist, destPrevDir);
+
+	// Choose where to join and leave the route, minimising the cost of getting to the route, following it, and getting from it to the destination.
+	int64_t routeCost = 0;                // Cost of following the route from its start to point i.
+	int64_t joinCost = INT64_MAX;         // Lowest cost of getting to the route, minus the cost of following the route to where we join it.
+	int64_t bestCost = INT64_MAX;
+	int join = -1, bestJoin = -1, bestLeave = -1;
+	for (int i = 0; i < numPoints; ++i)
+	{
+		PathCoord p(map_coord(route[i].x), map_coord(route[i].y));
+		if (i > 0)
+		{
+			PathCoord prev(map_coord(route[i - 1].x), map_coord(route[i - 1].y));
+			routeCost += fpathEstimate(prev, p)*(blockingMap.isDangerous(p.x, p.y) ? 5 : 1);
+		}
+		unsigned origCost = fpathWindowDist(origDist, origCorner, p);
+		if (origCost != UINT32_MAX && origCost - routeCost < joinCost)
+		{
+			joinCost = origCost - routeCost;
+			join = i;
+		}
+		unsigned destCost = fpathWindowDist(destDist, destCorner, p);
+		if (join != -1 && destCost != UINT32_MAX && joinCost + routeCost + destCost < bestCost)
+		{
+			bestCost = joinCost + routeCost + destCost;
+			bestJoin = join;
+			bestLeave = i;
+		}
+	}
+	if (bestLeave == -1)
+	{
+		return ASR_FAILED;  // Route doesn't pass close enough to the origin and destination.
+	}
+
+	const PathCoord joinTile(map_coord(route[bestJoin].x), map_coord(route[bestJoin].y));
+	const PathCoord leaveTile(map_coord(route[bestLeave].x), map_coord(route[bestLeave].y));
+	std::vector<PathCoord> head, tail;
+	fpathSectorTrace(origCorner, origPrevDir, tileOrig, joinTile, head);
+	fpathSectorTrace(destCorner, destPrevDir, tileDest, leaveTile, tail);
+	std::reverse(tail.begin(), tail.end());  // Now from leaveTile to next to tileDest.
+
+	std::vector<Vector2i> path;
+	if (!head.empty())
+	{
+		path.push_back(fpathTileCentre(tileOrig));
+		for (unsigned i = 0; i + 1 < head.size(); ++i)
+		{
+			path.push_back(fpathTileCentre(head[i]));  // Last tile of head is joinTile, which is on the route.
+		}
+	}
+	path.insert(path.end(), route + bestJoin, route + bestLeave + 1);
+	if (!tail.empty())
+	{
+		for (unsigned i = 1; i < tail.size(); ++i)
+		{
+			path.push_back(fpathTileCentre(tail[i]));  // First tile of tail is leaveTile, which is on the route.
+		}
+		path.push_back(fpathTileCentre(tileDest));
+	}
+	path.back() = Vector2i(psJob->destX, psJob->destY);
+
+	psMove->numPoints = path.size();
+	psMove->asPath = static_cast<Vector2i *>(malloc(sizeof(*psMove->asPath) * path.size()));
+	ASSERT_OR_RETURN(ASR_FAILED, psMove->asPath, "Out of memory");
+	std::copy(path.begin(), path.end(), psMove->asPath);
+	psMove->destination = psMove->asPath[path.size() - 1];
+	return ASR_OK;
+}
+
+/** Appends the entrance tiles on one border of a sector, on the inside of the sector. (dx, dy) is the direction from
+ *  the sector to its neighbour. Runs of passable border tiles of at least 6 tiles get an entrance at each end,
+ *  shorter runs get one in the middle. Both sectors find the same runs, so each entrance is next to one in the neighbour.
+ */
+static void fpathSectorEntrances(PathBlockingMap const &blockingMap, int sector, int sectorsX, int dx, int dy, std::vector<PathCoord> &nodes)
+{
+	const int x0 = sector%sectorsX*FPATH_SECTOR_SIZE, x1 = std::min(x0 + FPATH_SECTOR_SIZE, mapWidth);
+	const int y0 = sector/sectorsX*FPATH_SECTOR_SIZE, y1 = std::min(y0 + FPATH_SECTOR_SIZE, mapHeight);
+
+	// The border runs from start, in steps of along, for length tiles.
+	PathCoord start(dx > 0? x1 - 1 : x0, dy > 0? y1 - 1 : y0);
+	Vector2i along(dy != 0, dx != 0);
+	int length = dx != 0? y1 - y0 : x1 - x0;
+
+	int runStart = -1;
+	for (int i = 0; i <= length; ++i)
+	{
+		int x = start.x + along.x*i, y = start.y + along.y*i;
+		bool passable = i < length && !blockingMap.isBlocked(x, y) && !blockingMap.isBlocked(x + dx, y + dy);
+		if (passable && runStart == -1)
+		{
+			runStart = i;
+		}
+		else if (!passable && runStart != -1)
+		{
+			int runEnd = i - 1;
+			int entrances[2] = {runStart, runEnd};
+			if (runEnd - runStart + 1 < 6)
+			{
+				entrances[0] = entrances[1] = (runStart + runEnd)/2;
+			}
+			for (int e = 0; e < 2; ++e)
+			{
+				PathCoord p(start.x + along.x*entrances[e], start.y + along.y*entrances[e]);
+				if (std::find(nodes.begin(), nodes.end(), p) == nodes.end())  // Tiles in corners may be entrances to two neighbours.
+				{
+					nodes.push_back(p);
+				}
+			}
+			runStart = -1;
+		}
+	}
+}
+
+/// Finds the entrances of a sector and the costs of moving between them.
+static void fpathBuildSector(PathBlockingMap const &blockingMap, PathAbstractGraph &graph, int sector)
+{
+	PathSector &psSector = graph.sectors[sector];
+	const int sectorX = sector%graph.sectorsX, sectorY = sector/graph.sectorsX;
+	const int x0 = sectorX*FPATH_SECTOR_SIZE, y0 = sectorY*FPATH_SECTOR_SIZE;
+
+	psSector.nodes.clear();
+	if (sectorX > 0)                  fpathSectorEntrances(blockingMap, sector, graph.sectorsX, -1,  0, psSector.nodes);
+	if (sectorX < graph.sectorsX - 1) fpathSectorEntrances(blockingMap, sector, graph.sectorsX,  1,  0, psSector.nodes);
+	if (sectorY > 0)                  fpathSectorEntrances(blockingMap, sector, graph.sectorsX,  0, -1, psSector.nodes);
+	if (sectorY < graph.sectorsY - 1) fpathSectorEntrances(blockingMap, sector, graph.sectorsX,  0,  1, psSector.nodes);
+
+	const unsigned numNodes = psSector.nodes.size();
+	psSector.costs.resize(numNodes*numNodes);
+	unsigned dist[FPATH_SECTOR_SIZE*FPATH_SECTOR_SIZE];
+	uint8_t prevDir[FPATH_SECTOR_SIZE*FPATH_SECTOR_SIZE];
+	for (unsigned a = 0; a < numNodes; ++a)
+	{
+		fpathSectorSearch(blockingMap, PathNonblockingArea(), fpathSectorCorner(sector, graph.sectorsX), psSector.nodes[a], dist, prevDir);
+		for (unsigned b = 0; b < numNodes; ++b)
+		{
+			PathCoord q = psSector.nodes[b];
+			psSector.costs[a + b*numNodes] = dist[(q.x - x0) + (q.y - y0)*FPATH_SECTOR_SIZE];
+		}
+	}
+}
+
+/** Sets blockingMap.graph, by updating the sectors which have changed since the graph was last updated, or building it
+ *  from scratch if needed. Changing a sector can change the entrances of its neighbours, so they are rebuilt too.
+ */
+static void fpathUpdateAbstractGraph(PathBlockingMap &blockingMap)
+{
+	PathBlockingType const &type = blockingMap.type;
+	PathAbstractGraph &graph = blockingMap.graph;
+
+	const int sectorsX = (mapWidth + FPATH_SECTOR_SIZE - 1)/FPATH_SECTOR_SIZE;
+	const int sectorsY = (mapHeight + FPATH_SECTOR_SIZE - 1)/FPATH_SECTOR_SIZE;
+	std::vector<bool> rebuild(sectorsX*sectorsY, false);
+	if (graph.sectorsX != sectorsX || graph.sectorsY != sectorsY || graph.sectors.empty())
+	{
+		// New map. Build from scratch.
+		graph.sectorsX = sectorsX;
+		graph.sectorsY = sectorsY;
+		graph.sectors.assign(sectorsX*sectorsY, PathSector());
+		rebuild.assign(sectorsX*sectorsY, true);
+	}
+	else
+	{
+		for (int sector = 0; sector < sectorsX*sectorsY; ++sector)
+		{
+			if (!blockingMap.dirtySectors[sector])
+			{
+				continue;
+			}
+			int sectorX = sector%sectorsX, sectorY = sector/sectorsX;
+			rebuild[sector] = true;
+			if (sectorX > 0)            rebuild[sector - 1] = true;
+			if (sectorX < sectorsX - 1) rebuild[sector + 1] = true;
+			if (sectorY > 0)            rebuild[sector - sectorsX] = true;
+			if (sectorY < sectorsY - 1) rebuild[sector + sectorsX] = true;
+		}
+	}
+
+	unsigned numRebuilt = 0;
+	for (int sector = 0; sector < sectorsX*sectorsY; ++sector)
+	{
+		if (rebuild[sector])
+		{
+			fpathBuildSector(blockingMap, graph, sector);
+			++numRebuilt;
+		}
+	}
+	debug(LOG_NEVER, "Rebuilt %u of %d sectors of abstract path-finding graph for (%d,%d,%d)", numRebuilt, sectorsX*sectorsY, type.propulsion, type.owner, type.moveType);
+
+	blockingMap.dirtySectors.clear();
+}
+
+/// Marks the sector containing the tile as needing to be rebuilt, if the abstract graph has been built.
+static void fpathSectorDirty(PathBlockingMap &blockingMap, int x, int y)
+{
+	PathAbstractGraph const &graph = blockingMap.graph;
+	if (graph.sectors.empty())
+	{
+		return;  // Graph not built yet, it will be built from scratch anyway.
+	}
+	if (blockingMap.dirtySectors.empty())
+	{
+		blockingMap.dirtySectors.resize(graph.sectors.size(), false);
+	}
+	blockingMap.dirtySectors[x/FPATH_SECTOR_SIZE + y/FPATH_SECTOR_SIZE*graph.sectorsX] = true;
+}
+
+static bool fpathWantsDangerMap(PathBlockingType const &type)
+{
+	return !isHumanPlayer(type.owner) && type.moveType == FMT_MOVE;
+}
+
+static void fpathFillDangerMap(std::vector<uint32_t> &dangerMap, int owner)
+{
+	dangerMap.assign((mapWidth*mapHeight + 31)/32, 0);
+	for (int y = 0; y < mapHeight; ++y)
+		for (int x = 0; x < mapWidth; ++x)
+	{
+		unsigned i = x + y*mapWidth;
+		dangerMap[i/32] |= uint32_t((auxTile(x, y, owner) & AUXBITS_THREAT) != 0) << i%32;
+	}
+}
+
+/// Fills a new blocking map from scratch.
+static void fpathFillBlockingMap(PathBlockingMap &blockingMap)
+{
+	PathBlockingType const &type = blockingMap.type;
+	std::vector<uint32_t> &map = blockingMap.map;
+	map.assign((mapWidth*mapHeight + 31)/32, 0);
+	for (int y = 0; y < mapHeight; ++y)
+		for (int x = 0; x < mapWidth; ++x)
+	{
+		unsigned i = x + y*mapWidth;
+		map[i/32] |= uint32_t(fpathBaseBlockingTile(x, y, type.propulsion, type.owner, type.moveType)) << i%32;
+	}
+	if (fpathWantsDangerMap(type))
+	{
+		fpathFillDangerMap(blockingMap.dangerMap, type.owner);
+	}
+}
+
+static uint32_t fpathChecksumBits(std::vector<uint32_t> const &bits)
+{
+	uint32_t checksum = 0, factor = 0;
+	for (unsigned i = 0; i < bits.size(); ++i)
+	{
+		checksum ^= bits[i]*(factor = 3*factor + 1);
+	}
+	return checksum;
+}
+
+/// Returns a version of the blocking map which may be changed. If jobs may be using the map, it is replaced by a copy,
+/// and kept until the jobs can no longer be using it.
+static std::list<PathBlockingMap>::iterator fpathModifiableBlockingMap(std::list<PathBlockingMap>::iterator i)
+{
+	if (!i->published)
+	{
+		return i;
+	}
+	std::list<PathBlockingMap>::iterator copy = fpathBlockingMaps.insert(i, *i);
+	copy->published = false;
+	copy->generation = ++fpathLastBlockingMapGeneration;
+	fpathRetiredBlockingMaps.splice(fpathRetiredBlockingMaps.end(), fpathBlockingMaps, i);
+	return copy;
+}
+
+static PathMapState fpathCurrentMapState()
+{
+	PathMapState state;
+	state.width = mapWidth;
+	state.height = mapHeight;
+	state.scrollMinX = scrollMinX;
+	state.scrollMinY = scrollMinY;
+	state.scrollMaxX = scrollMaxX;
+	state.scrollMaxY = scrollMaxY;
+	state.blockMap = psBlockMap[0];
+	state.auxMap = psAuxMap[0];
+	return state;
+}
+
+/// Patches the blocking maps with the changes to the game map since they were last patched.
+static void fpathPatchBlockingMaps()
+{
+	PathMapState state = fpathCurrentMapState();
+	if (state != fpathMapState || fpathChangedAreas.size() > FPATH_MAX_CHANGED_AREAS)
+	{
+		// New map, switched between mission and home maps, scroll limits changed or too much changed. Start from scratch.
+		fpathMapState = state;
+		fpathRetiredBlockingMaps.splice(fpathRetiredBlockingMaps.end(), fpathBlockingMaps);
+		fpathChangedAreas.clear();
+		std::fill(fpathDangerChanged, fpathDangerChanged + MAX_PLAYERS, false);
+		return;
+	}
+
+	for (std::list<PathBlockingMap>::iterator i = fpathBlockingMaps.begin(); i != fpathBlockingMaps.end(); ++i)
+	{
+		PathBlockingType const type = i->type;
+		for (std::vector<StructureBounds>::const_iterator area = fpathChangedAreas.begin(); area != fpathChangedAreas.end(); ++area)
+		{
+			const int x0 = std::max(area->map.x, 0), x1 = std::min(area->map.x + area->size.x, mapWidth);
+			const int y0 = std::max(area->map.y, 0), y1 = std::min(area->map.y + area->size.y, mapHeight);
+			for (int y = y0; y < y1; ++y)
+				for (int x = x0; x < x1; ++x)
+			{
+				if (fpathBaseBlockingTile(x, y, type.propulsion, type.owner, type.moveType) != i->isBlocked(x, y))
+				{
+					i = fpathModifiableBlockingMap(i);
+					unsigned index = x + y*mapWidth;
+					i->map[index/32] ^= 1u << index%32;
+					fpathSectorDirty(*i, x, y);
+				}
+			}
+		}
+
+		bool wantsDangerMap = fpathWantsDangerMap(type);
+		if (wantsDangerMap == i->dangerMap.empty() || (wantsDangerMap && fpathDangerChanged[type.owner]))
+		{
+			std::vector<uint32_t> dangerMap;
+			if (wantsDangerMap)
+			{
+				fpathFillDangerMap(dangerMap, type.owner);
+			}
+			if (dangerMap != i->dangerMap)
+			{
+				i = fpathModifiableBlockingMap(i);
+				for (unsigned word = 0; word < std::min(dangerMap.size(), i->dangerMap.size()); ++word)
+				{
+					uint32_t diff = dangerMap[word] ^ i->dangerMap[word];
+					for (unsigned bit = 0; diff != 0 && bit < 32; ++bit)
+					{
+						if ((diff >> bit & 1) != 0)
+						{
+							unsigned index = word*32 + bit;
+							fpathSectorDirty(*i, index%mapWidth, index/mapWidth);
+						}
+					}
+				}
+				if (dangerMap.size() != i->dangerMap.size())
+				{
+					i->graph.sectors.clear();  // Danger map turned on or off, so every sector changed.
+					i->dirtySectors.clear();
+				}
+				i->dangerMap.swap(dangerMap);
+			}
+		}
+	}
+
+	fpathChangedAreas.clear();
+	std::fill(fpathDangerChanged, fpathDangerChanged + MAX_PLAYERS, false);
+}
+
+void fpathBlockingTilesChanged(StructureBounds const &area)
+{
+	if (fpathChangedAreas.size() <= FPATH_MAX_CHANGED_AREAS)
+	{
+		fpathChangedAreas.push_back(area);
+	}
+}
+
+void fpathDangerMapChanged(int player)
+{
+	ASSERT_OR_RETURN(, player >= 0 && player < MAX_PLAYERS, "Bad player %d", player);
+	fpathDangerChanged[player] = true;
+}
+
 void fpathSetBlockingMap(PATHJOB *psJob)
 {
 	if (fpathCurrentGameTime != gameTime)
 	{
 		// New tick, remove maps which are no longer needed.
 		fpathCurrentGameTime = gameTime;
-		fpathPrevBlockingMaps.swap(fpathBlockingMaps);
-		fpathBlockingMaps.clear();
+		fpathPrevRetiredBlockingMaps.swap(fpathRetiredBlockingMaps);
+		fpathRetiredBlockingMaps.clear();
 	}
 
+	fpathPatchBlockingMaps();
+
 	// Figure out which map we are looking for.
 	PathBlockingType type;
-	type.gameTime = gameTime;
 	type.propulsion = psJob->propulsion;
 	type.owner = psJob->owner;
 	type.moveType = psJob->moveType;
@@ -613,33 +1403,30 @@ void fpathSetBlockingMap(PATHJOB *psJob)
 
 		// i now points to an empty map with no data. Fill the map.
 		i->type = type;
-		std::vector<bool> &map = i->map;
-		map.resize(mapWidth*mapHeight);
-		uint32_t checksumMap = 0, checksumDangerMap = 0, factor = 0;
-		for (int y = 0; y < mapHeight; ++y)
-			for (int x = 0; x < mapWidth; ++x)
-		{
-			map[x + y*mapWidth] = fpathBaseBlockingTile(x, y, type.propulsion, type.owner, type.moveType);
-			checksumMap ^= map[x + y*mapWidth]*(factor = 3*factor + 1);
-		}
-		if (!isHumanPlayer(type.owner) && type.moveType == FMT_MOVE)
-		{
-			std::vector<bool> &dangerMap = i->dangerMap;
-			dangerMap.resize(mapWidth*mapHeight);
-			for (int y = 0; y < mapHeight; ++y)
-				for (int x = 0; x < mapWidth; ++x)
-			{
-				dangerMap[x + y*mapWidth] = auxTile(x, y, type.owner) & AUXBITS_THREAT;
-				checksumDangerMap ^= dangerMap[x + y*mapWidth]*(factor = 3*factor + 1);
-			}
-		}
-		syncDebug("blockingMap(%d,%d,%d,%d) = %08X %08X", gameTime, psJob->propulsion, psJob->owner, psJob->moveType, checksumMap, checksumDangerMap);
+		i->generation = ++fpathLastBlockingMapGeneration;
+		fpathFillBlockingMap(*i);
 	}
-	else
+	if (!i->published)
 	{
-		syncDebug("blockingMap(%d,%d,%d,%d) = cached", gameTime, psJob->propulsion, psJob->owner, psJob->moveType);
+		// Jobs may be using this version of the map from now on, so further changes need a new version.
+		i->published = true;
+		i->checksumMap = fpathChecksumBits(i->map);
+		i->checksumDangerMap = fpathChecksumBits(i->dangerMap);
+	}
+	syncDebug("blockingMap(%d,%d,%d,%d) = %08X %08X", gameTime, psJob->propulsion, psJob->owner, psJob->moveType, i->checksumMap, i->checksumDangerMap);
+
+	// The abstract graph is only needed for long routes, so don't build it before the first one. Jobs for short routes
+	// don't use the graph, and any earlier long route would have updated it already, so no job can be using it now.
+	if (fpathIsLongRoute(psJob) && (i->graph.sectors.empty() || !i->dirtySectors.empty()))
+	{
+		fpathUpdateAbstractGraph(*i);
 	}
 
 	// i now points to the correct map. Make psJob->blockingMap point to it.
 	psJob->blockingMap = &*i;
 }
+
+uint32_t fpathBlockingMapGeneration(PATHJOB const *psJob)
+{
+	return psJob->blockingMap->generation;
+}
@@ -40,10 +40,27 @@ enum ASR_RETVAL
  */
 ASR_RETVAL fpathAStarRoute(MOVE_CONTROL *psMove, PATHJOB *psJob);
 
+/** Finds a route by joining an earlier route, which was found with the same blocking map, using short searches near the
+ *  origin and destination. Returns ASR_FAILED if the earlier route does not pass close enough to both.
+ *
+ *  @ingroup pathfinding
+ */
+ASR_RETVAL fpathJoinRoute(MOVE_CONTROL *psMove, PATHJOB const *psJob, Vector2i const *route, int numPoints);
+
 /// Call from main thread.
 /// Sets psJob->blockingMap for later use by pathfinding thread, generating the required map if not already generated.
 void fpathSetBlockingMap(PATHJOB *psJob);
 
+/// Returns a number which changes whenever the blocking map used by psJob is changed. The map must be set already.
+uint32_t fpathBlockingMapGeneration(PATHJOB const *psJob);
+
+/// Call from main thread, after changing the blocking or aux bits of an area of the map.
+/// The blocking maps are patched before they are next used.
+void fpathBlockingTilesChanged(StructureBounds const &area);
+
+/// Call from main thread, after changing the threat bits of a player.
+void fpathDangerMapChanged(int player);
+
 /** Clean up the path finding node table.
  *
  *  @note Call this on shutdown to prevent memory from leaking, or if loading/saving, to prevent stale data from being reused.
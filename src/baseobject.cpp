@@ -29,6 +29,8 @@
 #include "feature.h"
 #include "intdisplay.h"
 #include "map.h"
+#include "objmem.h"
+#include "tickprofile.h"
 
 
 static inline uint16_t interpolateAngle(uint16_t v1, uint16_t v2, uint32_t t1, uint32_t t2, uint32_t t)
@@ -81,7 +83,9 @@ SIMPLE_OBJECT::SIMPLE_OBJECT(OBJECT_TYPE type, uint32_t id, unsigned player)
 	, born(gameTime)
 	, died(0)
 	, time(0)
-{}
+{
+	++tickProfileAllocations;
+}
 
 SIMPLE_OBJECT::~SIMPLE_OBJECT()
 {
@@ -111,10 +115,14 @@ BASE_OBJECT::BASE_OBJECT(OBJECT_TYPE type, uint32_t id, unsigned player)
 	sDisplay.screenX = 0;
 	sDisplay.screenY = 0;
 	sDisplay.screenR = 0;
+
+	objIdIndexInsert(this);
 }
 
 BASE_OBJECT::~BASE_OBJECT()
 {
+	objIdIndexRemove(this);
+
 	// Make sure to get rid of some final references in the sound code to this object first
 	audio_RemoveObj(this);
 
@@ -0,0 +1,296 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2013  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/**
+ * @file benchmark.cpp
+ * Lets the game warm up for a number of ticks, then times a number of ticks, using the tick profiler for the time spent in each stage.
+ *
+ * Scenario files are ini files, with the keys in a [benchmark] group:
+ *   Name, Map, MaxPlayers, Scavengers, Bases (counting from 1, like challenges), PowerLevel, Difficulty, Seed  -- for an AI-only skirmish.
+ *   Replay                                                                                                  -- instead of Map, a replay file, relative to the scenario.
+ *   Savegame                                                                                                -- instead of Map, a savegame in the savegame directory.
+ *   WarmupTicks, Ticks, MinObjects                                                                          -- what to measure.
+ *   MinTicksPerSecond                                                                                       -- the slowest simbench.sh accepts.
+ */
+
+#include "lib/framework/frame.h"
+#include "lib/gamelib/gtime.h"
+#include "lib/netplay/netplay.h"
+
+#include "benchmark.h"
+#include "ai.h"
+#include "loadsave.h"
+#include "main.h"
+#include "multiint.h"
+#include "multiplay.h"
+#include "replay.h"
+#include "tickprofile.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSettings>
+#include <errno.h>
+#if defined(WZ_OS_UNIX)
+# include <sys/resource.h>
+#endif
+
+static bool             benchmarkActive = false;
+static bool             benchmarkSkirmish = false;
+static bool             benchmarkDone = false;
+static QString          scenarioName;
+static QString          scenarioMap;
+static int              scenarioPlayers = 4;
+static bool             scenarioScavengers = false;
+static int              scenarioBase = CAMP_CLEAN;
+static int              scenarioPower = LEV_MED;
+static int              scenarioDifficulty = 1;
+static uint32_t         scenarioSeed = 1;
+static unsigned         warmupTicks = 1;
+static unsigned         measuredTicks = 1000;
+static unsigned         minObjects = 0;
+static double           minTicksPerSecond = 0;
+static char             *reportFile = NULL;
+
+static unsigned         tickCount = 0;
+static QElapsedTimer    measureTimer;
+static uint64_t         stageTotals[TICK_STAGE_COUNT];       ///< Microseconds spent in each stage, during the measured ticks.
+static uint64_t         stageAllocTotals[TICK_STAGE_COUNT];  ///< Objects allocated in each stage, during the measured ticks.
+static uint64_t         totalTime = 0;                       ///< Microseconds spent in gameStateUpdate, during the measured ticks.
+static unsigned         warmupObjects = 0;
+
+bool benchmarkSetScenario(const char *fileName)
+{
+	if (!QFileInfo(fileName).exists())
+	{
+		debug(LOG_ERROR, "Benchmark scenario \"%s\" not found.", fileName);
+		return false;
+	}
+	QSettings ini(fileName, QSettings::IniFormat);
+	ini.beginGroup("benchmark");
+	scenarioName = ini.value("Name", QFileInfo(fileName).baseName()).toString();
+	scenarioMap = ini.value("Map", "").toString();
+	scenarioPlayers = ini.value("MaxPlayers", scenarioPlayers).toInt();
+	scenarioScavengers = ini.value("Scavengers", scenarioScavengers).toBool();
+	scenarioBase = ini.value("Bases", scenarioBase + 1).toInt() - 1;  // Count from 1 like challenges.
+	scenarioPower = ini.value("PowerLevel", scenarioPower).toInt();
+	scenarioSeed = ini.value("Seed", scenarioSeed).toUInt();
+	QString difficulty = ini.value("Difficulty", difficultyList[scenarioDifficulty]).toString();
+	for (unsigned i = 0; i < ARRAY_SIZE(difficultyList); ++i)
+	{
+		if (difficulty.compare(difficultyList[i], Qt::CaseInsensitive) == 0)
+		{
+			scenarioDifficulty = i;
+		}
+	}
+	warmupTicks = std::max(ini.value("WarmupTicks", warmupTicks).toUInt(), 1u);  // The timer starts at the end of a tick.
+	measuredTicks = std::max(ini.value("Ticks", measuredTicks).toUInt(), 1u);
+	minObjects = ini.value("MinObjects", minObjects).toUInt();
+	minTicksPerSecond = ini.value("MinTicksPerSecond", minTicksPerSecond).toDouble();
+
+	if (ini.contains("Replay"))
+	{
+		QString replay = QFileInfo(fileName).absoluteDir().filePath(ini.value("Replay").toString());
+		replaySetPlaybackFile(replay.toUtf8().constData());
+	}
+	else if (ini.contains("Savegame"))
+	{
+		ssprintf(saveGameName, "%s/%s", SaveGamePath, ini.value("Savegame").toString().toUtf8().constData());
+		SetGameMode(GS_SAVEGAMELOAD);
+	}
+	else if (!scenarioMap.isEmpty())
+	{
+		benchmarkSkirmish = true;
+	}
+	else
+	{
+		debug(LOG_ERROR, "Benchmark scenario \"%s\" needs a Map, Replay or Savegame.", fileName);
+		return false;
+	}
+	ini.endGroup();
+
+	benchmarkActive = true;
+	return true;
+}
+
+void benchmarkSetReportFile(const char *fileName)
+{
+	free(reportFile);
+	reportFile = fileName != NULL ? strdup(fileName) : NULL;
+}
+
+bool benchmarkWantsSkirmish()
+{
+	return benchmarkSkirmish;
+}
+
+bool benchmarkStartSkirmish()
+{
+	benchmarkSkirmish = false;
+
+	game.type = SKIRMISH;
+	sstrcpy(game.map, scenarioMap.toUtf8().constData());
+	game.hash.setZero();
+	sstrcpy(game.name, scenarioName.toUtf8().constData());
+	game.maxPlayers = std::min(scenarioPlayers, MAX_PLAYERS);
+	game.scavengers = scenarioScavengers;
+	game.mapHasScavengers = true;
+	game.isMapMod = false;
+	game.base = scenarioBase;
+	game.power = scenarioPower;
+	game.alliance = NO_ALLIANCES;
+
+	// Every player is an AI, including the selected player, like in autogames. Since nobody is allocated as a human player, ticks never wait for anyone.
+	for (unsigned i = 0; i < MAX_PLAYERS; ++i)
+	{
+		PLAYER &p = NetPlay.players[i];
+		p.allocated = false;
+		p.position = i;
+		p.colour = i;
+		p.team = i;
+		p.ai = i < game.maxPlayers ? 0 : AI_CLOSED;
+		p.difficulty = scenarioDifficulty;
+		game.skDiff[i] = i < game.maxPlayers ? difficultyValue[scenarioDifficulty] : 0;
+		setPlayerName(i, "");
+		ingame.JoiningInProgress[i] = false;
+	}
+	if (ingame.numStructureLimits)
+	{
+		ingame.numStructureLimits = 0;
+		free(ingame.pStructureLimits);
+		ingame.pStructureLimits = NULL;
+	}
+	ingame.flags = 0;
+	selectedPlayer = 0;
+	realSelectedPlayer = 0;
+	NetPlay.isHost = true;
+	NetPlay.hostPlayer = 0;
+
+	debug(LOG_INFO, "Starting benchmark \"%s\" on %s with %d players.", scenarioName.toUtf8().constData(), game.map, game.maxPlayers);
+	return startGameWithoutFrontend(scenarioSeed);
+}
+
+static long long peakRSSKiB()
+{
+#if defined(WZ_OS_UNIX)
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0)
+	{
+# if defined(WZ_OS_MAC)
+		return usage.ru_maxrss / 1024;  // Bytes on Mac OS X.
+# else
+		return usage.ru_maxrss;         // Kilobytes elsewhere.
+# endif
+	}
+#endif
+	return -1;  // Unknown.
+}
+
+static void benchmarkWriteReport(double seconds, TICK_PROFILE const &last)
+{
+	FILE *file = stdout;
+	if (reportFile != NULL)
+	{
+		file = fopen(reportFile, "w");
+		if (file == NULL)
+		{
+			debug(LOG_ERROR, "Could not open \"%s\" for writing: %s", reportFile, strerror(errno));
+			return;
+		}
+	}
+
+	unsigned objects = last.droids + last.structures + last.features + last.projectiles;
+
+	// One value per line, so that scripts can read the report without a JSON parser.
+	fprintf(file, "{\n");
+	fprintf(file, "\"scenario\": \"%s\",\n", scenarioName.toUtf8().constData());
+	fprintf(file, "\"map\": \"%s\",\n", game.map);
+	fprintf(file, "\"warmupTicks\": %u,\n", warmupTicks);
+	fprintf(file, "\"ticks\": %u,\n", measuredTicks);
+	fprintf(file, "\"gameTime\": %u,\n", gameTime);
+	fprintf(file, "\"seconds\": %.3f,\n", seconds);
+	fprintf(file, "\"ticksPerSecond\": %.2f,\n", measuredTicks / std::max(seconds, 0.001));
+	fprintf(file, "\"minTicksPerSecond\": %.2f,\n", minTicksPerSecond);
+	fprintf(file, "\"updateMicrosecondsPerTick\": %.1f,\n", double(totalTime) / measuredTicks);
+	fprintf(file, "\"peakRSSKiB\": %lld,\n", peakRSSKiB());
+	fprintf(file, "\"warmupObjects\": %u,\n", warmupObjects);
+	fprintf(file, "\"objects\": %u,\n", objects);
+	fprintf(file, "\"minObjects\": %u,\n", minObjects);
+	fprintf(file, "\"droids\": %u,\n", last.droids);
+	fprintf(file, "\"structures\": %u,\n", last.structures);
+	fprintf(file, "\"features\": %u,\n", last.features);
+	fprintf(file, "\"projectiles\": %u,\n", last.projectiles);
+	fprintf(file, "\"stages\": {\n");
+	for (int stage = 0; stage < TICK_STAGE_COUNT; ++stage)
+	{
+		fprintf(file, "\"%s\": {\"totalMicroseconds\": %llu, \"microsecondsPerTick\": %.1f, \"allocs\": %llu}%s\n", tickProfileStageName((TICK_STAGE)stage),
+		        (unsigned long long)stageTotals[stage], double(stageTotals[stage]) / measuredTicks, (unsigned long long)stageAllocTotals[stage], stage + 1 < TICK_STAGE_COUNT ? "," : "");
+	}
+	fprintf(file, "}\n}\n");
+
+	if (file != stdout)
+	{
+		fclose(file);
+		debug(LOG_INFO, "Wrote benchmark report to \"%s\".", reportFile);
+	}
+	else
+	{
+		fflush(file);
+	}
+}
+
+void benchmarkEndTick()
+{
+	if (!benchmarkActive || benchmarkDone)
+	{
+		return;
+	}
+
+	++tickCount;
+	TICK_PROFILE const &tick = tickProfileGet(tickProfileCount() - 1);
+	if (tickCount <= warmupTicks)
+	{
+		if (tickCount == warmupTicks)
+		{
+			// Start timing from the end of this tick, so the timer sees exactly the measured ticks.
+			warmupObjects = tick.droids + tick.structures + tick.features + tick.projectiles;
+			debug(LOG_INFO, "Benchmark warmup done at game time %u, with %u objects.", gameTime, warmupObjects);
+			measureTimer.start();
+		}
+		return;
+	}
+
+	for (int stage = 0; stage < TICK_STAGE_COUNT; ++stage)
+	{
+		stageTotals[stage] += tick.stageTime[stage];
+		stageAllocTotals[stage] += tick.stageAllocs[stage];
+	}
+	totalTime += tick.totalTime;
+
+	if (tickCount == warmupTicks + measuredTicks)
+	{
+		// Includes the time spent between ticks, receiving messages and running the (headless) render loop.
+		double seconds = measureTimer.nsecsElapsed() / 1e9;
+		benchmarkWriteReport(seconds, tick);
+		benchmarkDone = true;
+	}
+}
+
+bool benchmarkFinished()
+{
+	return benchmarkDone;
+}
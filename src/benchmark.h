@@ -0,0 +1,41 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2013  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Runs a game for a fixed number of ticks, and reports how fast the game state was updated.
+ */
+
+#ifndef __INCLUDED_SRC_BENCHMARK_H__
+#define __INCLUDED_SRC_BENCHMARK_H__
+
+/// Reads a benchmark scenario, set from the command line. The scenario either names a map to start an AI-only skirmish on,
+/// a replay to play back, or a savegame to load. Returns false if the scenario could not be read.
+bool benchmarkSetScenario(const char *fileName);
+/// File to write the report to, set from the command line. The report goes to stdout if not set.
+void benchmarkSetReportFile(const char *fileName);
+
+/// True if the benchmark should start an AI-only skirmish from the title loop.
+bool benchmarkWantsSkirmish();
+/// Starts the AI-only skirmish. Returns false if the map was not found.
+bool benchmarkStartSkirmish();
+/// Call at the end of gameStateUpdate, after tickProfileEndTick.
+void benchmarkEndTick();
+/// True once all benchmark ticks have run, and the report has been written.
+bool benchmarkFinished();
+
+#endif // __INCLUDED_SRC_BENCHMARK_H__
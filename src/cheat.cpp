@@ -74,6 +74,7 @@ static CHEAT_ENTRY cheatCodes[] =
 	{"showfps", kf_ToggleFPS},	//displays your average FPS
 	{"showsamples", kf_ToggleSamples}, //displays the # of Sound samples in Queue & List
 	{"showorders", kf_ToggleOrders}, //displays unit order/action state.
+	{"showtickprofile", kf_ToggleTickProfile}, //displays time taken by each stage of the game tick.
 	{"showlevelname", kf_ToggleLevelName}, // shows the current level name on screen
 	{"pause", kf_TogglePauseMode}, // Pause the game.
 	{"power info", kf_PowerInfo},
@@ -29,6 +29,7 @@
 #include "lib/ivis_opengl/screen.h"
 #include "lib/netplay/netplay.h"
 
+#include "benchmark.h"
 #include "clparse.h"
 #include "display3d.h"
 #include "frontend.h"
@@ -36,6 +37,8 @@
 #include "loadsave.h"
 #include "main.h"
 #include "multiplay.h"
+#include "replay.h"
+#include "tickprofile.h"
 #include "version.h"
 #include "warzoneconfig.h"
 #include "wrappers.h"
@@ -232,6 +235,12 @@ typedef enum
 	CLI_CRASH,
 	CLI_TEXTURECOMPRESSION,
 	CLI_NOTEXTURECOMPRESSION,
+	CLI_TICKPROFILE,
+	CLI_HEADLESS,
+	CLI_RECORD,
+	CLI_REPLAY,
+	CLI_BENCHMARK,
+	CLI_BENCHMARKREPORT,
 } CLI_OPTIONS;
 
 static const struct poptOption* getOptionsTable(void)
@@ -263,6 +272,12 @@ static const struct poptOption* getOptionsTable(void)
 		{ "host",       '\0', POPT_ARG_NONE,   NULL, CLI_HOSTLAUNCH, N_("go directly to host screen"),        NULL },
 		{ "texturecompression", '\0', POPT_ARG_NONE, NULL, CLI_TEXTURECOMPRESSION, N_("Enable texture compression"), NULL },
 		{ "notexturecompression", '\0', POPT_ARG_NONE, NULL, CLI_NOTEXTURECOMPRESSION, N_("Disable texture compression"), NULL },
+		{ "tickprofile", '\0', POPT_ARG_STRING, NULL, CLI_TICKPROFILE, N_("Write game tick timings to file when a game ends (CSV, or JSON if file ends in .json)"), N_("file") },
+		{ "headless",   '\0', POPT_ARG_STRING, NULL, CLI_HEADLESS,   N_("Run without a window, graphics or sound, at real time or as fast as possible"), N_("realtime|fast") },
+		{ "record",     '\0', POPT_ARG_STRING, NULL, CLI_RECORD,     N_("Record skirmish and multiplayer games to a replay file"), N_("file") },
+		{ "replay",     '\0', POPT_ARG_STRING, NULL, CLI_REPLAY,     N_("Play back a replay file, use with --headless=fast to simulate as fast as possible"), N_("file") },
+		{ "benchmark",  '\0', POPT_ARG_STRING, NULL, CLI_BENCHMARK,  N_("Run a benchmark scenario, use with --headless=fast"), N_("file") },
+		{ "benchmark-report", '\0', POPT_ARG_STRING, NULL, CLI_BENCHMARKREPORT, N_("Write the benchmark report to file instead of stdout"), N_("file") },
 		// Terminating entry
 		{ NULL,         '\0', 0,               NULL, 0,              NULL,                                    NULL },
 	};
@@ -595,6 +610,71 @@ bool ParseCommandLine(int argc, const char** argv)
 			case CLI_NOTEXTURECOMPRESSION:
 				wz_texture_compression = GL_RGBA;
 				break;
+
+			case CLI_TICKPROFILE:
+				token = poptGetOptArg(poptCon);
+				if (token == NULL)
+				{
+					qFatal("Missing tick profile file name");
+				}
+				tickProfileSetDumpFile(token);
+				break;
+
+			case CLI_HEADLESS:
+				// The backend already checked for --headless, since it needs to know before parsing the options.
+				token = poptGetOptArg(poptCon);
+				if (token == NULL || strcmp(token, "realtime") == 0)
+				{
+					setHeadlessMode(HEADLESS_REALTIME);
+				}
+				else if (strcmp(token, "fast") == 0)
+				{
+					setHeadlessMode(HEADLESS_FAST);
+				}
+				else
+				{
+					qFatal("The headless parameter requires realtime or fast.");
+				}
+				break;
+
+			case CLI_RECORD:
+				token = poptGetOptArg(poptCon);
+				if (token == NULL)
+				{
+					qFatal("Missing replay file name");
+				}
+				replaySetRecordFile(token);
+				break;
+
+			case CLI_REPLAY:
+				token = poptGetOptArg(poptCon);
+				if (token == NULL)
+				{
+					qFatal("Missing replay file name");
+				}
+				replaySetPlaybackFile(token);
+				break;
+
+			case CLI_BENCHMARK:
+				token = poptGetOptArg(poptCon);
+				if (token == NULL)
+				{
+					qFatal("Missing benchmark scenario file name");
+				}
+				if (!benchmarkSetScenario(token))
+				{
+					qFatal("Could not read benchmark scenario");
+				}
+				break;
+
+			case CLI_BENCHMARKREPORT:
+				token = poptGetOptArg(poptCon);
+				if (token == NULL)
+				{
+					qFatal("Missing benchmark report file name");
+				}
+				benchmarkSetReportFile(token);
+				break;
 		};
 	}
 
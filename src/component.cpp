@@ -435,7 +435,7 @@ static void displayCompObj(DROID *psDroid, bool bButton)
 		if (psDroid->droidType != DROID_TRANSPORTER && !missionIsOffworld())
 		{
 			MAPTILE *psTile = worldTile(psDroid->pos.x, psDroid->pos.y);
-			if (psTile->jammerBits & alliancebits[psDroid->player])
+			if (mapTileVision(psTile)->jammerBits & alliancebits[psDroid->player])
 			{
 				pieFlag |= pie_ECM;
 			}
@@ -2027,6 +2027,7 @@ void	dealWithLMB( void )
 		if (getDebugMappingStatus() && tileOnMap(mouseTileX, mouseTileY))
 		{
 			MAPTILE *psTile = mapTile(mouseTileX, mouseTileY);
+			MAPTILE_VISION *psVision = mapTileVision(psTile);
 			uint8_t aux = auxTile(mouseTileX, mouseTileY, selectedPlayer);
 
 			console("%s tile %d, %d [%d, %d] continent(l%d, h%d) level %g illum %d %s %s w=%d s=%d j=%d",
@@ -2034,7 +2035,7 @@ void	dealWithLMB( void )
 			          mouseTileX, mouseTileY, world_coord(mouseTileX), world_coord(mouseTileY),
 			          (int)psTile->limitedContinent, (int)psTile->hoverContinent, psTile->level, (int)psTile->illumination,
 				  aux & AUXBITS_DANGER ? "danger" : "", aux & AUXBITS_THREAT ? "threat" : "",
-				  (int)psTile->watchers[selectedPlayer], (int)psTile->sensors[selectedPlayer], (int)psTile->jammers[selectedPlayer]);
+				  (int)psVision->watchers[selectedPlayer], (int)psVision->sensors[selectedPlayer], (int)psVision->jammers[selectedPlayer]);
 		}
 
 		driveDisableTactical();
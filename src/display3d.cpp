@@ -27,6 +27,7 @@
 #include "lib/framework/opengl.h"
 #include "lib/framework/math_ext.h"
 #include "lib/framework/stdio_ext.h"
+#include "lib/framework/objectpool.h"
 
 /* Includes direct access to render library */
 #include "lib/ivis_opengl/pieblitfunc.h"
@@ -52,6 +53,7 @@
 #include "levels.h"
 #include "map.h"
 #include "move.h"
+#include "fpath.h"
 #include "visibility.h"
 #include "geometry.h"
 #include "messagedef.h"
@@ -92,6 +94,7 @@
 #include "anim_id.h"
 #include "cmddroid.h"
 #include "terrain.h"
+#include "tickprofile.h"
 
 /********************  Prototypes  ********************/
 
@@ -215,6 +218,10 @@ bool showSAMPLES = false;
  *  default OFF, turn ON via console command 'showorders'
  */
 bool showORDERS = false;
+/** Show how long each stage of the game tick takes
+ *  default OFF, turn ON via console command 'showtickprofile'
+ */
+bool showTickProfile = false;
 /** Show the current level name on the screen, toggle via the 'showlevelname'
  *  console command
 */
@@ -799,6 +806,49 @@ void draw3DScene( void )
 		height = iV_GetTextHeight(DROIDDOING);
 		iV_DrawText(DROIDDOING, 0, pie_GetVideoBufferHeight()- height);
 	}
+	if (showTickProfile)
+	{
+		iV_SetFont(font_regular);
+		unsigned int height = iV_GetTextHeight("0");
+		unsigned int count = tickProfileCount();
+		uint64_t totalSum = 0;
+		uint32_t totalMax = 0;
+		const char *line;
+
+		for (int stage = 0; stage < TICK_STAGE_COUNT; ++stage)
+		{
+			uint64_t sum = 0;
+			uint32_t max = 0;
+			for (unsigned n = 0; n < count; ++n)
+			{
+				uint32_t time = tickProfileGet(n).stageTime[stage];
+				sum += time;
+				max = std::max(max, time);
+			}
+			sasprintf((char**)&line, "%-12s avg %6.2f ms  max %6.2f ms", tickProfileStageName((TICK_STAGE)stage), sum/1000.f/std::max(count, 1u), max/1000.f);
+			iV_DrawText(line, 10, 120 + height*stage);
+		}
+		for (unsigned n = 0; n < count; ++n)
+		{
+			totalSum += tickProfileGet(n).totalTime;
+			totalMax = std::max(totalMax, tickProfileGet(n).totalTime);
+		}
+		sasprintf((char**)&line, "%-12s avg %6.2f ms  max %6.2f ms  (%u ticks)", "total", totalSum/1000.f/std::max(count, 1u), totalMax/1000.f, count);
+		iV_DrawText(line, 10, 120 + height*TICK_STAGE_COUNT);
+
+		unsigned row = TICK_STAGE_COUNT + 2;
+		unsigned pathCacheHits, pathCacheMisses;
+		fpathGetCacheStatistics(&pathCacheHits, &pathCacheMisses);
+		sasprintf((char**)&line, "%-12s %6u hits  %6u misses", "path cache", pathCacheHits, pathCacheMisses);
+		iV_DrawText(line, 10, 120 + height*row);
+		row += 2;
+
+		for (ObjectPool *pool = ObjectPool::first(); pool != NULL; pool = pool->next())
+		{
+			sasprintf((char**)&line, "%-12s %6u live  %6u peak  %6u slots", pool->name(), pool->liveCount(), pool->peakCount(), pool->capacity());
+			iV_DrawText(line, 10, 120 + height*row++);
+		}
+	}
 
 	setupConnectionStatusForm();
 
@@ -1388,7 +1438,7 @@ void	renderAnimComponent( const COMPONENT_OBJECT *psObj )
 		PIELIGHT brightness;
 		MAPTILE *psTile = worldTile(psParentObj->pos.x, psParentObj->pos.y);
 
-		if (psTile->jammerBits & alliancebits[psParentObj->player])
+		if (mapTileVision(psTile)->jammerBits & alliancebits[psParentObj->player])
 		{
 			pieFlag |= pie_ECM;
 		}
@@ -2141,7 +2191,7 @@ void	renderStructure(STRUCTURE *psStructure)
 		defensive = true;
 	}
 
-	if (psTile->jammerBits & alliancebits[psStructure->player])
+	if (mapTileVision(psTile)->jammerBits & alliancebits[psStructure->player])
 	{
 		ecmFlag = pie_ECM;
 	}
@@ -2512,7 +2562,7 @@ static bool	renderWallSection(STRUCTURE *psStructure)
 		return false;
 	}
 
-		if (psTile->jammerBits & alliancebits[psStructure->player])
+		if (mapTileVision(psTile)->jammerBits & alliancebits[psStructure->player])
 		{
 			ecmFlag = pie_ECM;
 		}
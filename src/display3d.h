@@ -51,6 +51,7 @@ enum ENERGY_BAR
 extern bool showFPS;
 extern bool showSAMPLES;
 extern bool showORDERS;
+extern bool showTickProfile;
 extern bool showLevelName;
 
 extern float getViewDistance(void);
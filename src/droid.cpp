@@ -462,6 +462,7 @@ void recycleDroid(DROID *psDroid)
 
 	// hide the droid
 	memset(psDroid->visible, 0, sizeof(psDroid->visible));
+	aiInvalidateTargetCandidates();
 	// stop any group moral checks
 	if (psDroid->psGroup)
 	{
@@ -2515,7 +2515,7 @@ bool writeFXData(const char *fileName)
 {
 	EFFECT *it;
 	int i = 0;
-	WzConfig ini(fileName);
+	WzConfig ini(fileName, WzConfig::ReadAndWrite, WzConfig::BinaryFileInBackground);
 
 	for (it = activeList.first; it != NULL; it = it->next, i++)
 	{
@@ -53,6 +53,7 @@
 #include "advvis.h"
 
 #include "mapgrid.h"
+#include "astar.h"
 #include "display3d.h"
 #include "random.h"
 
@@ -273,6 +274,7 @@ FEATURE * buildFeature(FEATURE_STATS *psStats, UDWORD x, UDWORD y,bool FromSave)
 			}
 		}
 	}
+	fpathBlockingTilesChanged(b);
 	psFeature->pos.z = map_TileHeight(b.map.x, b.map.y);//jps 18july97
 
 	return psFeature;
@@ -351,6 +353,7 @@ bool removeFeature(FEATURE *psDel)
 			}
 		}
 	}
+	fpathBlockingTilesChanged(b);
 
 	if (psDel->psStats->subType == FEAT_GEN_ARTE || psDel->psStats->subType == FEAT_OIL_DRUM)
 	{
@@ -66,6 +66,9 @@ struct FEATURE : public BASE_OBJECT
 	FEATURE(uint32_t id, FEATURE_STATS const *psStats);
 	~FEATURE();
 
+	static void *operator new(size_t size);  ///< Features are allocated from a pool, see objmem.cpp.
+	static void operator delete(void *feature);
+
 	FEATURE_STATS const *psStats;
 };
 
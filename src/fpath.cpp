@@ -30,6 +30,8 @@
 
 #include "lib/framework/wzapp.h"
 
+#include <QtCore/QThread>
+
 #include "objects.h"
 #include "map.h"
 #include "raycast.h"
@@ -39,6 +41,7 @@
 #include "multiplay.h"
 #include "astar.h"
 #include "action.h"
+#include "warzoneconfig.h"
 
 #include "fpath.h"
 
@@ -54,41 +57,95 @@ struct PATHRESULT
 	MOVE_CONTROL	sMove;		///< New movement values for the droid.
 	FPATH_RETVAL	retval;		///< Result value from path-finding.
 	Vector2i        originalDest;   ///< Used to check if the pathfinding job is to the right destination.
+	PATHJOB         job;            ///< Job which gave this result, used for adding the route to the path cache.
+	uint32_t        blockingMapGeneration;  ///< Version of the blocking map used by the job.
+};
+
+/// Size in tiles of the areas which the path cache treats as the same origin or destination.
+#define FPATH_CACHE_SECTOR_SIZE 8
+/// Routes shorter than this many tiles are not worth caching.
+#define FPATH_CACHE_MIN_DIST (2*FPATH_CACHE_SECTOR_SIZE)
+/// Maximum number of routes in the path cache.
+#define FPATH_CACHE_SIZE 64
+
+/// Route found earlier, which can be reused for nearby origins and destinations while the blocking map is unchanged.
+struct PATHCACHEENTRY
+{
+	PROPULSION_TYPE propulsion;
+	int             owner;
+	FPATH_MOVETYPE  moveType;
+	uint32_t        blockingMapGeneration;  ///< Version of the blocking map the route was found with.
+	Vector2i        origSector, destSector;
+	StructureBounds dstStructure;
+	std::vector<Vector2i> route;
 };
 
 
+/// Queue of jobs which must be executed in order, by one thread at a time.
+struct PATHLANE
+{
+	PATHLANE() : busy(false) {}
+
+	std::list<PATHJOB> jobs;        ///< Jobs in this lane. The front job is being executed, if busy.
+	bool            busy;           ///< A path-finding thread is working on this lane.
+};
+
 // threading stuff
-static WZ_THREAD        *fpathThread = NULL;
+static std::vector<WZ_THREAD *> fpathThreads;
 static WZ_MUTEX         *fpathMutex = NULL;
 static WZ_SEMAPHORE     *fpathSemaphore = NULL;
-static std::list<PATHJOB>    pathJobs;
+static PATHLANE         pathLanes[FPATH_LANES];
 static std::list<PATHRESULT> pathResults;
 
 static bool             waitingForResult = false;
 static uint32_t         waitingForResultId;
 static WZ_SEMAPHORE     *waitingForResultSemaphore = NULL;
 
+/// Last recently used list of cached routes. Only used from the main thread.
+static std::list<PATHCACHEENTRY> pathCache;
+static unsigned         pathCacheHits = 0;
+static unsigned         pathCacheMisses = 0;
+
 static void fpathExecute(PATHJOB *psJob, PATHRESULT *psResult);
 
 
-/** This runs in a separate thread */
+/** Returns a lane which has jobs, but which no thread is working on, or NULL if there is no such lane.
+ *  Must be called with fpathMutex locked. */
+static PATHLANE *fpathFindIdleLane(unsigned firstLane)
+{
+	for (unsigned i = 0; i < FPATH_LANES; ++i)
+	{
+		PATHLANE *lane = &pathLanes[(firstLane + i) % FPATH_LANES];
+		if (!lane->busy && !lane->jobs.empty())
+		{
+			return lane;
+		}
+	}
+	return NULL;
+}
+
+/** This runs in separate threads, one per path-finding worker */
 static int fpathThreadFunc(void *)
 {
+	unsigned nextLane = 0;
+
 	wzMutexLock(fpathMutex);
 
 	while (!fpathQuit)
 	{
-		if (pathJobs.empty())
+		PATHLANE *lane = fpathFindIdleLane(nextLane);
+		if (lane == NULL)
 		{
-			ASSERT(!waitingForResult, "Waiting for a result (id %u) that doesn't exist.", waitingForResultId);
 			wzMutexUnlock(fpathMutex);
 			wzSemaphoreWait(fpathSemaphore);  // Go to sleep until needed.
 			wzMutexLock(fpathMutex);
 			continue;
 		}
+		nextLane = lane - pathLanes + 1;  // Start looking at the next lane next time, so no lane is starved.
 
-		// Copy the first job from the queue. Don't pop yet, since the main thread may want to set .deleted = true.
-		PATHJOB job = pathJobs.front();
+		// Copy the first job from the lane. Don't pop yet, since the main thread may want to set .deleted = true.
+		lane->busy = true;
+		PATHJOB job = lane->jobs.front();
 
 		wzMutexUnlock(fpathMutex);
 
@@ -98,17 +155,20 @@ static int fpathThreadFunc(void *)
 		memset(&result.sMove, 0, sizeof(result.sMove));
 		result.retval = FPR_FAILED;
 		result.originalDest = Vector2i(job.destX, job.destY);
+		result.job = job;
+		result.blockingMapGeneration = fpathBlockingMapGeneration(&job);
 
 		fpathExecute(&job, &result);
 
 		wzMutexLock(fpathMutex);
 
-		ASSERT(pathJobs.front().droidID == job.droidID, "Bug");  // The front of pathJobs may have .deleted set to true, but should not otherwise have been modified or deleted.
-		if (!pathJobs.front().deleted)
+		ASSERT(lane->jobs.front().droidID == job.droidID, "Bug");  // The front of the lane may have .deleted set to true, but should not otherwise have been modified or deleted.
+		if (!lane->jobs.front().deleted)
 		{
 			pathResults.push_back(result);
 		}
-		pathJobs.pop_front();
+		lane->jobs.pop_front();
+		lane->busy = false;
 
 		// Unblock the main thread, if it was waiting for this particular result.
 		if (waitingForResult && waitingForResultId == job.droidID)
@@ -129,13 +189,30 @@ bool fpathInitialise(void)
 	// The path system is up
 	fpathQuit = false;
 
-	if (!fpathThread)
+	// Cached routes must not survive into another game, since all players must have the same routes cached.
+	pathCache.clear();
+	pathCacheHits = 0;
+	pathCacheMisses = 0;
+
+	if (fpathThreads.empty())
 	{
+		// Results do not depend on the number of threads, only on the number of lanes, so this can differ between players.
+		int numThreads = war_getPathfindThreads();
+		if (numThreads <= 0)
+		{
+			numThreads = QThread::idealThreadCount() - 1;  // Leave a core for the main thread.
+		}
+		numThreads = clip(numThreads, 1, FPATH_LANES);
+		debug(LOG_INFO, "Using %d path-finding threads.", numThreads);
+
 		fpathMutex = wzMutexCreate();
 		fpathSemaphore = wzSemaphoreCreate(0);
 		waitingForResultSemaphore = wzSemaphoreCreate(0);
-		fpathThread = wzThreadCreate(fpathThreadFunc, NULL);
-		wzThreadStart(fpathThread);
+		for (int i = 0; i < numThreads; ++i)
+		{
+			fpathThreads.push_back(wzThreadCreate(fpathThreadFunc, NULL));
+			wzThreadStart(fpathThreads.back());
+		}
 	}
 
 	return true;
@@ -144,14 +221,20 @@ bool fpathInitialise(void)
 
 void fpathShutdown()
 {
-	// Signal the path finding thread to quit
+	// Signal the path finding threads to quit
 	fpathQuit = true;
-	wzSemaphorePost(fpathSemaphore);  // Wake up thread.
+	for (unsigned i = 0; i < fpathThreads.size(); ++i)
+	{
+		wzSemaphorePost(fpathSemaphore);  // Wake up threads.
+	}
 
-	if (fpathThread)
+	if (!fpathThreads.empty())
 	{
-		wzThreadJoin(fpathThread);
-		fpathThread = NULL;
+		for (unsigned i = 0; i < fpathThreads.size(); ++i)
+		{
+			wzThreadJoin(fpathThreads[i]);
+		}
+		fpathThreads.clear();
 		wzMutexDestroy(fpathMutex);
 		fpathMutex = NULL;
 		wzSemaphoreDestroy(fpathSemaphore);
@@ -159,6 +242,11 @@ void fpathShutdown()
 		wzSemaphoreDestroy(waitingForResultSemaphore);
 		waitingForResultSemaphore = NULL;
 	}
+	if (pathCacheHits + pathCacheMisses > 0)
+	{
+		debug(LOG_INFO, "Path cache: %u hits, %u misses.", pathCacheHits, pathCacheMisses);
+	}
+	pathCache.clear();
 	fpathHardTableReset();
 }
 
@@ -330,11 +418,15 @@ void fpathRemoveDroidData(int id)
 {
 	wzMutexLock(fpathMutex);
 
-	for (std::list<PATHJOB>::iterator psJob = pathJobs.begin(); psJob != pathJobs.end(); ++psJob)
+	for (unsigned lane = 0; lane < FPATH_LANES; ++lane)
 	{
-		if (psJob->droidID == id)
+		std::list<PATHJOB> &pathJobs = pathLanes[lane].jobs;
+		for (std::list<PATHJOB>::iterator psJob = pathJobs.begin(); psJob != pathJobs.end(); ++psJob)
 		{
-			psJob->deleted = true;  // Don't delete the job, since job execution order matters, so tell it to throw away the result after executing, instead.
+			if (psJob->droidID == id)
+			{
+				psJob->deleted = true;  // Don't delete the job, since job execution order matters, so tell it to throw away the result after executing, instead.
+			}
 		}
 	}
 	for (std::list<PATHRESULT>::iterator psResult = pathResults.begin(); psResult != pathResults.end(); )
@@ -352,6 +444,122 @@ void fpathRemoveDroidData(int id)
 	wzMutexUnlock(fpathMutex);
 }
 
+/// Jobs to the same destination tile go to the same lane, so that they can share cached contexts.
+static unsigned fpathJobLane(int tX, int tY)
+{
+	unsigned x = map_coord(tX), y = map_coord(tY);
+	return (x*31 + y*17) % FPATH_LANES;
+}
+
+static Vector2i fpathCacheSector(int x, int y)
+{
+	return Vector2i(map_coord(x)/FPATH_CACHE_SECTOR_SIZE, map_coord(y)/FPATH_CACHE_SECTOR_SIZE);
+}
+
+static bool fpathCacheWorthwhile(PATHJOB const *psJob)
+{
+	int dx = abs(map_coord(psJob->origX) - map_coord(psJob->destX));
+	int dy = abs(map_coord(psJob->origY) - map_coord(psJob->destY));
+	return std::max(dx, dy) >= FPATH_CACHE_MIN_DIST;
+}
+
+/** Returns the cached route for the same kind of job, or pathCache.end() if none. Removes the cached route if it was found
+ *  with an older version of the blocking map than the given generation.
+ */
+static std::list<PATHCACHEENTRY>::iterator fpathCacheFind(PATHJOB const *psJob, uint32_t generation)
+{
+	Vector2i origSector = fpathCacheSector(psJob->origX, psJob->origY);
+	Vector2i destSector = fpathCacheSector(psJob->destX, psJob->destY);
+	for (std::list<PATHCACHEENTRY>::iterator i = pathCache.begin(); i != pathCache.end(); )
+	{
+		if (i->origSector != origSector || i->destSector != destSector
+		 || i->dstStructure.map != psJob->dstStructure.map || i->dstStructure.size != psJob->dstStructure.size
+		 || !fpathIsEquivalentBlocking(i->propulsion, i->owner, i->moveType, psJob->propulsion, psJob->owner, psJob->moveType))
+		{
+			++i;
+		}
+		else if (i->blockingMapGeneration < generation)
+		{
+			i = pathCache.erase(i);  // The map changed since the route was found, so the route may be blocked.
+		}
+		else
+		{
+			return i;
+		}
+	}
+	return pathCache.end();
+}
+
+/// Remembers the route of a complete path-finding result, so that similar jobs can reuse it.
+static void fpathCacheInsert(PATHRESULT const &result)
+{
+	PATHJOB const &job = result.job;
+	if (result.retval != FPR_OK || result.sMove.numPoints < 2 || result.sMove.destination != result.originalDest || !fpathCacheWorthwhile(&job))
+	{
+		return;  // Failed, partial or short route.
+	}
+
+	std::list<PATHCACHEENTRY>::iterator i = fpathCacheFind(&job, result.blockingMapGeneration);
+	if (i != pathCache.end() && i->blockingMapGeneration > result.blockingMapGeneration)
+	{
+		return;  // Already have a route found with a newer version of the blocking map.
+	}
+	if (i == pathCache.end())
+	{
+		pathCache.push_front(PATHCACHEENTRY());
+		i = pathCache.begin();
+	}
+	i->propulsion = job.propulsion;
+	i->owner = job.owner;
+	i->moveType = job.moveType;
+	i->blockingMapGeneration = result.blockingMapGeneration;
+	i->origSector = fpathCacheSector(job.origX, job.origY);
+	i->destSector = fpathCacheSector(job.destX, job.destY);
+	i->dstStructure = job.dstStructure;
+	i->route.assign(result.sMove.asPath, result.sMove.asPath + result.sMove.numPoints);
+	pathCache.splice(pathCache.begin(), pathCache, i);
+
+	while (pathCache.size() > FPATH_CACHE_SIZE)
+	{
+		pathCache.pop_back();
+	}
+}
+
+/// Sets the route of psMove by joining a cached route, if there is a suitable one. The blocking map of the job must be set.
+static bool fpathCacheRoute(MOVE_CONTROL *psMove, PATHJOB const *psJob)
+{
+	if (!fpathCacheWorthwhile(psJob))
+	{
+		return false;
+	}
+
+	uint32_t generation = fpathBlockingMapGeneration(psJob);
+	std::list<PATHCACHEENTRY>::iterator i = fpathCacheFind(psJob, generation);
+	MOVE_CONTROL sMove;
+	memset(&sMove, 0, sizeof(sMove));
+	if (i == pathCache.end() || i->blockingMapGeneration != generation || fpathJoinRoute(&sMove, psJob, &i->route[0], i->route.size()) != ASR_OK)
+	{
+		++pathCacheMisses;
+		return false;
+	}
+	++pathCacheHits;
+	pathCache.splice(pathCache.begin(), pathCache, i);
+
+	psMove->destination = sMove.destination;
+	psMove->numPoints = sMove.numPoints;
+	psMove->pathIndex = 0;
+	psMove->Status = MOVENAVIGATE;
+	free(psMove->asPath);
+	psMove->asPath = sMove.asPath;
+	return true;
+}
+
+void fpathGetCacheStatistics(unsigned *hits, unsigned *misses)
+{
+	*hits = pathCacheHits;
+	*misses = pathCacheMisses;
+}
+
 static FPATH_RETVAL fpathRoute(MOVE_CONTROL *psMove, int id, int startX, int startY, int tX, int tY, PROPULSION_TYPE propulsionType, 
                                DROID_TYPE droidType, FPATH_MOVETYPE moveType, int owner, bool acceptNearest, StructureBounds const &dstStructure)
 {
@@ -389,6 +597,8 @@ static FPATH_RETVAL fpathRoute(MOVE_CONTROL *psMove, int id, int startX, int sta
 
 			ASSERT(psResult->retval != FPR_OK || psResult->sMove.asPath, "Ok result but no path in list");
 
+			fpathCacheInsert(*psResult);
+
 			// Copy over select fields - preserve others
 			psMove->destination = psResult->sMove.destination;
 			psMove->numPoints = psResult->sMove.numPoints;
@@ -439,25 +649,38 @@ queuePathfinding:
 	job.owner = owner;
 	job.acceptNearest = acceptNearest;
 	job.deleted = false;
+	job.lane = fpathJobLane(tX, tY);
 	fpathSetBlockingMap(&job);
 
+	// Many droids often go the same way, so try to reuse a route found earlier, instead of waiting for a new one.
+	if (fpathCacheRoute(psMove, &job))
+	{
+		// Clear any results or jobs waiting already, the droid isn't waiting for them any more.
+		fpathRemoveDroidData(id);
+
+		objTrace(id, "Joined a cached route to (%d, %d)! Length=%d", psMove->destination.x, psMove->destination.y, psMove->numPoints);
+		syncDebug("fpathRoute(..., %d, %d, %d, %d, %d, %d, %d, %d, %d) = %d, cached path[%d] = %08X->(%d, %d)", id, startX, startY, tX, tY, propulsionType, droidType, moveType, owner, FPR_OK, psMove->numPoints, ~crcSumVector2i(0, psMove->asPath, psMove->numPoints), psMove->destination.x, psMove->destination.y);
+		return FPR_OK;
+	}
+
 	// Clear any results or jobs waiting already. It is a vital assumption that there is only one
 	// job or result for each droid in the system at any time.
 	fpathRemoveDroidData(id);
 
 	wzMutexLock(fpathMutex);
 
-	// Add to end of list
+	// Add to end of lane
+	std::list<PATHJOB> &pathJobs = pathLanes[job.lane].jobs;
 	bool isFirstJob = pathJobs.empty();
 	pathJobs.push_back(job);
 	if (isFirstJob)
 	{
-		wzSemaphorePost(fpathSemaphore);  // Wake up processing thread.
+		wzSemaphorePost(fpathSemaphore);  // Wake up a processing thread, since the lane has become ready.
 	}
 
 	wzMutexUnlock(fpathMutex);
 
-	objTrace(id, "Queued up a path-finding request to (%d, %d), at least %d items earlier in queue", tX, tY, isFirstJob);
+	objTrace(id, "Queued up a path-finding request to (%d, %d) in lane %u, at least %d items earlier in lane", tX, tY, job.lane, !isFirstJob);
 	syncDebug("fpathRoute(..., %d, %d, %d, %d, %d, %d, %d, %d, %d) = FPR_WAIT", id, startX, startY, tX, tY, propulsionType, droidType, moveType, owner);
 	return FPR_WAIT;	// wait while polling result queue
 }
@@ -555,7 +778,10 @@ static int fpathJobQueueLength(void)
 	int count = 0;
 
 	wzMutexLock(fpathMutex);
-	count = pathJobs.size();  // O(N) function call for std::list. .empty() is faster, but this function isn't used except in tests.
+	for (unsigned lane = 0; lane < FPATH_LANES; ++lane)
+	{
+		count += pathLanes[lane].jobs.size();  // O(N) function call for std::list. .empty() is faster, but this function isn't used except in tests.
+	}
 	wzMutexUnlock(fpathMutex);
 	return count;
 }
@@ -589,10 +815,10 @@ void fpathTest(int x, int y, int x2, int y2)
 	(void)fpathJobQueueLength;
 
 	/* Check initial state */
-	assert(fpathThread != NULL);
+	assert(!fpathThreads.empty());
 	assert(fpathMutex != NULL);
 	assert(fpathSemaphore != NULL);
-	assert(pathJobs.empty());
+	assert(fpathJobQueueLength() == 0);
 	assert(pathResults.empty());
 	fpathRemoveDroidData(0);	// should not crash
 
@@ -651,7 +877,7 @@ void fpathTest(int x, int y, int x2, int y2)
 	{
 		fpathRemoveDroidData(i);
 	}
-	//assert(pathJobs.empty()); // can now be marked .deleted as well
+	//assert(fpathJobQueueLength() == 0); // can now be marked .deleted as well
 	assert(pathResults.empty());
 	(void)r;  // Squelch unused-but-set warning.
 }
@@ -41,6 +41,12 @@ enum FPATH_MOVETYPE
 
 struct PathBlockingMap;
 
+/** Number of independent job queues in the path-finding system. Each lane has its own context cache, and is
+ *  worked on by at most one path-finding thread at a time. Must not depend on the number of threads, since
+ *  the lane a job ends up in can affect the resulting path.
+ */
+#define FPATH_LANES 8
+
 struct PATHJOB
 {
 	PROPULSION_TYPE	propulsion;
@@ -52,6 +58,7 @@ struct PATHJOB
 	FPATH_MOVETYPE	moveType;
 	int		owner;		///< Player owner
 	PathBlockingMap *blockingMap;   ///< Map of blocking tiles.
+	unsigned	lane;		///< Job queue and context cache used for this job, depends only on the destination.
 	bool		acceptNearest;
 	bool            deleted;        ///< Droid was deleted, so throw away result when complete. Must still process this PATHJOB, since processing order can affect resulting paths (but can't affect the path length).
 };
@@ -115,6 +122,10 @@ extern void fpathRemoveDroidData(int id);
  *  using the given propulsion type. orig and dest are in world coordinates. */
 bool fpathCheck(Position orig, Position dest, PROPULSION_TYPE propulsion);
 
+/** Number of routes which were joined from cached routes, and number of routes which could have been but weren't,
+ *  since the path-finding module was initialised. */
+void fpathGetCacheStatistics(unsigned *hits, unsigned *misses);
+
 /** Unit testing. */
 void fpathTest(int x, int y, int x2, int y2);
 
@@ -76,6 +76,7 @@
 #include "mission.h"
 #include "geometry.h"
 #include "gateway.h"
+#include "mapgrid.h"
 #include "scripttabs.h"
 #include "scriptvals.h"
 #include "scriptextern.h"
@@ -1638,6 +1639,12 @@ bool loadGame(const char *pGameToLoad, bool keepObjects, bool freeMem, bool User
 	/* Stop the game clock */
 	gameTimeStop();
 
+	// The files of a recent save may still be being written.
+	if (!WzConfig::waitForBackgroundWrites())
+	{
+		debug(LOG_ERROR, "A recent savegame was not written completely");
+	}
+
 	if ((gameType == GTYPE_SAVE_START) ||
 		(gameType == GTYPE_SAVE_MIDMISSION))
 	{
@@ -1676,6 +1683,7 @@ bool loadGame(const char *pGameToLoad, bool keepObjects, bool freeMem, bool User
 			apsExtractorLists[player] = NULL;
 		}
 		apsOilList[0] = NULL;
+		gridStaticListsReplaced();
 		initFactoryNumFlag();
 	}
 
@@ -2104,6 +2112,7 @@ bool loadGame(const char *pGameToLoad, bool keepObjects, bool freeMem, bool User
 	if (gameType != GTYPE_SCENARIO_EXPAND)
 	{
 		psMapTiles = NULL;
+		psTileVision = NULL;
 		//load in the map file
 		aFileName[fileExten] = '\0';
 		strcat(aFileName, "game.map");
@@ -2131,6 +2140,15 @@ bool loadGame(const char *pGameToLoad, bool keepObjects, bool freeMem, bool User
 				debug(LOG_ERROR, "Failed with: %s", aFileName);
 				goto error;
 			}
+
+			// Older saves have no burning tiles.
+			aFileName[fileExten] = '\0';
+			strcat(aFileName, "fires.ini");
+			if (PHYSFS_exists(aFileName) && !readFireData(aFileName))
+			{
+				debug(LOG_ERROR, "Failed with: %s", aFileName);
+				goto error;
+			}
 		}
 	}
 
@@ -2496,6 +2514,7 @@ error:
 	freeAllFeatures();
 	droidTemplateShutDown();
 	psMapTiles = NULL;
+	psTileVision = NULL;
 
 	/* Start the game clock */
 	gameTimeStart();
@@ -2505,6 +2524,8 @@ error:
 // -----------------------------------------------------------------------------------------
 
 // Modified by AlexL , now takes a filename, with no popup....
+// Only the .gam file and gameinfo.ini are written here. The other files are copied and left to the background writer,
+// so returning true does not mean they were written; failures are reported by WzConfig::takeBackgroundWriteFailures.
 bool saveGame(char *aFileName, GAME_TYPE saveType)
 {
 	UDWORD			fileExtension;
@@ -2670,6 +2691,15 @@ bool saveGame(char *aFileName, GAME_TYPE saveType)
 		goto error;
 	}
 
+	CurrentFileName[fileExtension] = '\0';
+	strcat(CurrentFileName, "fires.ini");
+	/*Write the data to the file*/
+	if (!writeFireData(CurrentFileName))
+	{
+		debug(LOG_ERROR, "saveGame: writeFireData(\"%s\") failed", CurrentFileName);
+		goto error;
+	}
+
 	//added at V15 save
 	CurrentFileName[fileExtension] = '\0';
 	strcat(CurrentFileName, "score.ini");
@@ -2814,8 +2844,8 @@ static bool writeMapFile(const char* fileName)
 
 	if (status)
 	{
-		/* Write the data to the file */
-		status = saveFile(fileName, pFileData, fileSize);
+		/* Copy the data, and write it to the file in the background */
+		WzConfig::saveFileInBackground(fileName, QByteArray(pFileData, fileSize));
 	}
 
 	if (pFileData != NULL)
@@ -3975,7 +4005,7 @@ bool loadSaveDroidInit(char *pFileData, UDWORD filesize)
 			{
 				Vector2i startpos = getPlayerStartPosition(psDroid->player);
 
-				psDroid->id = pDroidInit->id > 0 ? pDroidInit->id : 0xFEDBCA98;	// hack to remove droid id zero
+				setObjectId(psDroid, pDroidInit->id > 0 ? pDroidInit->id : 0xFEDBCA98);	// hack to remove droid id zero
 				psDroid->rot.direction = DEG(pDroidInit->direction);
 				addDroid(psDroid, apsDroidLists);
 				if (psDroid->droidType == DROID_CONSTRUCT && startpos.x == 0 && startpos.y == 0)
@@ -4266,7 +4296,7 @@ static bool loadSaveDroid(const char *pFileName, DROID **ppsCurrentDroidLists)
 		// Copy the values across
 		if (id > 0)
 		{
-			psDroid->id = id; // force correct ID, unless ID is set to eg -1, in which case we should keep new ID (useful for starting units in campaign)
+			setObjectId(psDroid, id); // force correct ID, unless ID is set to eg -1, in which case we should keep new ID (useful for starting units in campaign)
 		}
 		ASSERT(id != 0, "Droid ID should never be zero here");
 		psDroid->body = healthValue(ini, psDroid->originalBody);
@@ -4511,7 +4541,7 @@ static bool writeDroid(WzConfig &ini, DROID *psCurr, bool onMission, int &counte
 
 static bool writeDroidFile(const char *pFileName, DROID **ppsCurrentDroidLists)
 {
-	WzConfig ini(pFileName);
+	WzConfig ini(pFileName, WzConfig::ReadAndWrite, WzConfig::BinaryFileInBackground);
 	int counter = 0;
 	bool onMission = (ppsCurrentDroidLists[0] == mission.apsDroidLists[0]);
 
@@ -4674,7 +4704,7 @@ bool loadSaveStructure(char *pFileData, UDWORD filesize)
 		if (!psStructure) continue;
 		// The original code here didn't work and so the scriptwriters worked round it by using the module ID - so making it work now will screw up
 		// the scripts -so in ALL CASES overwrite the ID!
-		psStructure->id = psSaveStructure->id > 0 ? psSaveStructure->id : 0xFEDBCA98; // hack to remove struct id zero
+		setObjectId(psStructure, psSaveStructure->id > 0 ? psSaveStructure->id : 0xFEDBCA98); // hack to remove struct id zero
 		psStructure->periodicalDamage = psSaveStructure->periodicalDamage;
 		periodicalDamageTime = psSaveStructure->periodicalDamageStart;
 		psStructure->periodicalDamageStart = periodicalDamageTime;
@@ -4796,7 +4826,7 @@ static bool loadSaveStructure2(const char *pFileName, STRUCTURE **ppList)
 		}
 		if (id > 0)
 		{
-			psStructure->id = id;	// force correct ID
+			setObjectId(psStructure, id);	// force correct ID
 		}
 		psStructure->periodicalDamage = ini.value("periodicalDamage", 0).toInt();
 		psStructure->periodicalDamageStart = ini.value("periodicalDamageStart", 0).toInt();
@@ -5012,7 +5042,7 @@ bool writeGameInfo(const char *pFileName)
 	ini.setValue("openGL_GLEW_version", opengl.GLEWversion);
 	ini.setValue("openGL_GLSL_version", opengl.GLSLversion);
 	// NOTE: deprecated for GL 3+. Needed this to check what extensions some chipsets support for the openGL hacks
-	std::string extensions = (const char *) glGetString(GL_EXTENSIONS);
+	std::string extensions = isHeadless()? "" : (const char *) glGetString(GL_EXTENSIONS);
 	ini.setValue("GL_EXTENSIONS", extensions.data());
 	ini.endGroup();
 	return true;
@@ -5023,7 +5053,7 @@ Writes the linked list of structure for each player to a file
 */
 bool writeStructFile(const char *pFileName)
 {
-	WzConfig ini(pFileName);
+	WzConfig ini(pFileName, WzConfig::ReadAndWrite, WzConfig::BinaryFileInBackground);
 	int counter = 0;
 
 	for (int player = 0; player < MAX_PLAYERS; player++)
@@ -5345,7 +5375,7 @@ bool loadSaveFeature(char *pFileData, UDWORD filesize)
 			scriptSetDerrickPos(pFeature->pos.x, pFeature->pos.y);
 		}
 		//restore values
-		pFeature->id = psSaveFeature->id;
+		setObjectId(pFeature, psSaveFeature->id);
 		pFeature->rot.direction = DEG(psSaveFeature->direction);
 		pFeature->periodicalDamage = psSaveFeature->periodicalDamage;
 		if (psHeader->version >= VERSION_14)
@@ -5411,7 +5441,7 @@ bool loadSaveFeature2(const char *pFileName)
 			scriptSetDerrickPos(pFeature->pos.x, pFeature->pos.y);
 		}
 		//restore values
-		pFeature->id = ini.value("id").toInt();
+		setObjectId(pFeature, ini.value("id").toInt());
 		pFeature->rot = ini.vector3i("rotation");
 		pFeature->periodicalDamage = ini.value("periodicalDamage", 0).toInt();
 		pFeature->periodicalDamageStart = ini.value("periodicalDamageStart", 0).toInt();
@@ -5434,7 +5464,7 @@ Writes the linked list of features to a file
 */
 bool writeFeatureFile(const char *pFileName)
 {
-	WzConfig ini(pFileName);
+	WzConfig ini(pFileName, WzConfig::ReadAndWrite, WzConfig::BinaryFileInBackground);
 	int counter = 0;
 
 	for(FEATURE *psCurr = apsFeatureLists[0]; psCurr != NULL; psCurr = psCurr->psNext)
@@ -5526,7 +5556,7 @@ bool loadSaveTemplate(const char *pFileName)
 
 bool writeTemplateFile(const char *pFileName)
 {
-	WzConfig ini(pFileName);
+	WzConfig ini(pFileName, WzConfig::ReadAndWrite, WzConfig::BinaryFileInBackground);
 
 	for (int player = 0; player < MAX_PLAYERS; player++)
 	{
@@ -5656,10 +5686,7 @@ static bool writeTerrainTypeMapFile(char *pFileName)
 	endian_udword(&psHeader->version);
 	endian_udword(&psHeader->quantity);
 
-	if (!saveFile(pFileName, pFileData, fileSize))
-	{
-		return false;
-	}
+	WzConfig::saveFileInBackground(pFileName, QByteArray(pFileData, fileSize));
 	free(pFileData);
 
 	return true;
@@ -5694,7 +5721,7 @@ bool loadSaveCompList(const char *pFileName)
 // Write out the current state of the Comp lists per player
 static bool writeCompListFile(const char *pFileName)
 {
-	WzConfig ini(pFileName);
+	WzConfig ini(pFileName, WzConfig::ReadAndWrite, WzConfig::BinaryFileInBackground);
 
 	// Save each type of struct type
 	for (int player = 0; player < MAX_PLAYERS; player++)
@@ -5792,7 +5819,7 @@ static bool loadSaveStructTypeList(const char *pFileName)
 // Write out the current state of the Struct Type List per player
 static bool writeStructTypeListFile(const char *pFileName)
 {
-	WzConfig ini(pFileName);
+	WzConfig ini(pFileName, WzConfig::ReadAndWrite, WzConfig::BinaryFileInBackground);
 
 	// Save each type of struct type
 	for (int player = 0; player < MAX_PLAYERS; player++)
@@ -5874,7 +5901,7 @@ bool loadSaveResearch(const char *pFileName)
 // Write out the current state of the Research per player
 static bool writeResearchFile(char *pFileName)
 {
-	WzConfig ini(pFileName);
+	WzConfig ini(pFileName, WzConfig::ReadAndWrite, WzConfig::BinaryFileInBackground);
 
 	for (int i = 0; i < asResearch.size(); ++i)
 	{
@@ -6036,7 +6063,7 @@ bool loadSaveMessage(const char *pFileName, SWORD levelType)
 // Write out the current messages per player
 static bool writeMessageFile(const char *pFileName)
 {
-	WzConfig ini(pFileName);
+	WzConfig ini(pFileName, WzConfig::ReadAndWrite, WzConfig::BinaryFileInBackground);
 	int numMessages = 0;
 
 	// save each type of research
@@ -6142,7 +6169,7 @@ Writes the list of structure limits to a file
 */
 bool writeStructLimitsFile(const char *pFileName)
 {
-	WzConfig ini(pFileName);
+	WzConfig ini(pFileName, WzConfig::ReadAndWrite, WzConfig::BinaryFileInBackground);
 
 	// Save each type of struct type
 	for (int player = 0; player < game.maxPlayers; player++)
@@ -6184,7 +6211,7 @@ bool readFiresupportDesignators(const char *pFileName)
 bool writeFiresupportDesignators(const char *pFileName)
 {
 	int player;
-	WzConfig ini(pFileName);
+	WzConfig ini(pFileName, WzConfig::ReadAndWrite, WzConfig::BinaryFileInBackground);
 
 	for (player = 0; player < MAX_PLAYERS; player++)
 	{
@@ -33,6 +33,7 @@
 #include "lib/framework/physfs_ext.h"
 #include "lib/framework/strres.h"
 #include "lib/framework/wzapp.h"
+#include "lib/framework/wzconfig.h"
 #include "lib/ivis_opengl/piemode.h"
 #include "lib/ivis_opengl/piestate.h"
 #include "lib/ivis_opengl/screen.h"
@@ -72,6 +73,7 @@
 #include "lighting.h"
 #include "loop.h"
 #include "mapgrid.h"
+#include "parallel.h"
 #include "mechanics.h"
 #include "miscimd.h"
 #include "mission.h"
@@ -81,6 +83,7 @@
 #include "multiplay.h"
 #include "projectile.h"
 #include "radar.h"
+#include "replay.h"
 #include "research.h"
 #include "lib/framework/cursors.h"
 #include "scriptextern.h"
@@ -89,6 +92,7 @@
 #include "scriptvals.h"
 #include "text.h"
 #include "texture.h"
+#include "tickprofile.h"
 #include "transporter.h"
 #include "warzoneconfig.h"
 #include "main.h"
@@ -664,11 +668,13 @@ bool systemInitialise(void)
 		return false;
 	}
 
-	if (!audio_Init(droidAudioTrackStopped, war_getSoundEnabled()))
+	// No sound when headless, without changing the saved sound setting.
+	bool soundEnabled = war_getSoundEnabled() && !isHeadless();
+	if (!audio_Init(droidAudioTrackStopped, soundEnabled))
 	{
 		debug(LOG_SOUND, "Continuing without audio");
 	}
-	if (war_getSoundEnabled() && war_GetMusicEnabled())
+	if (soundEnabled && war_GetMusicEnabled())
 	{
 		cdAudio_Open(UserMusicPath);
 	}
@@ -705,6 +711,7 @@ extern char *mod_list;
 void systemShutdown(void)
 {
 	pie_ShutdownRadar();
+	replayStop();
 	if (mod_list)
 	{
 		free(mod_list);
@@ -744,6 +751,7 @@ void systemShutdown(void)
 	frameShutDown();	// close screen / SDL / resources / cursors / trig
 	screenShutDown();
 	closeConfig();		// "registry" close
+	WzConfig::shutdownBackgroundWrites();	// finish writing savegames
 	cleanSearchPath();	// clean PHYSFS search paths
 	debug_exit();		// cleanup debug routines
 	PHYSFS_deinit();	// cleanup PHYSFS (If failure, state of PhysFS is undefined, and probably badly screwed up.)
@@ -999,6 +1007,11 @@ bool stageOneInitialise(void)
 		return false;
 	}
 
+	if (!parallelInitialise())
+	{
+		return false;
+	}
+
 	initMission();
 	initTransporters();
 	scriptInit();
@@ -1060,6 +1073,7 @@ bool stageOneShutDown(void)
 
 	scrShutDown();
 	gridShutDown();
+	parallelShutdown();
 
 	if ( !anim_Shutdown() )
 	{
@@ -1227,6 +1241,8 @@ bool stageThreeInitialise(void)
 
 	loopMissionState = LMS_NORMAL;
 
+	tickProfileReset();
+
 	if(!InitRadar()) 	// After resLoad cause it needs the game palette initialised.
 	{
 		return false;
@@ -1326,6 +1342,12 @@ bool stageThreeShutDown(void)
 {
 	debug(LOG_WZ, "== stageThreeShutDown ==");
 
+	if (tickProfileGetDumpFile() != NULL)
+	{
+		tickProfileDump(tickProfileGetDumpFile());
+	}
+	replayStop();
+
 	removeSpotters();
 
 	// There is an assymetry in scripts initialization and destruction, due
@@ -586,6 +586,12 @@ void kf_ToggleOrders(void)	// Displays orders & action of currently selected uni
 		CONPRINTF(ConsoleString, (ConsoleString, "Unit Order/Action displayed is %s", showORDERS ? "Enabled" : "Disabled"));
 }
 
+void kf_ToggleTickProfile(void)	// Displays time taken by each stage of the game tick, path cache hits and how many objects are allocated.
+{
+	showTickProfile = !showTickProfile;
+	CONPRINTF(ConsoleString, (ConsoleString, "Tick profile displayed is %s", showTickProfile ? "Enabled" : "Disabled"));
+}
+
 void kf_ToggleLevelName(void) // toggles level name 
 {
 	showLevelName = !showLevelName;
@@ -598,11 +604,12 @@ void	kf_FrameRate( void )
 	          frameRate(), loopPieCount, loopPolyCount, loopStateChanges));
 	if (runningMultiplayer())
 	{
-		CONPRINTF(ConsoleString, (ConsoleString, "NETWORK:  Bytes: s-%d r-%d  Uncompressed Bytes: s-%d r-%d  Packets: s-%d r-%d",
+		CONPRINTF(ConsoleString, (ConsoleString, "NETWORK:  Bytes: s-%d r-%d  Uncompressed Bytes: s-%d r-%d  Serialised Bytes: s-%d  Packets: s-%d r-%d",
 		                          NETgetStatistic(NetStatisticRawBytes, true),
 		                          NETgetStatistic(NetStatisticRawBytes, false),
 		                          NETgetStatistic(NetStatisticUncompressedBytes, true),
 		                          NETgetStatistic(NetStatisticUncompressedBytes, false),
+		                          NETgetStatistic(NetStatisticSerializedBytes, true),
 		                          NETgetStatistic(NetStatisticPackets, true),
 		                          NETgetStatistic(NetStatisticPackets, false)));
 	}
@@ -1344,6 +1351,7 @@ void	kf_ToggleGodMode( void )
 				}
 			}
 		}
+		aiInvalidateTargetCandidates();
 		// remove all proximity messages
 		releaseAllProxDisp();
 	}
@@ -33,6 +33,7 @@
 #include "lib/framework/strres.h"
 #include "lib/framework/input.h"
 #include "lib/framework/stdio_ext.h"
+#include "lib/framework/wzconfig.h"
 #include "lib/widget/button.h"
 #include "lib/widget/editbox.h"
 #include "lib/widget/widget.h"
@@ -365,6 +366,7 @@ void deleteSaveGame(char* saveGameName)
 
 	ASSERT( strlen(saveGameName) < MAX_STR_LENGTH,"deleteSaveGame; save game name too long" );
 
+	WzConfig::waitForBackgroundWrites();	// don't delete files which are still being written
 	PHYSFS_delete(saveGameName);
 	saveGameName[strlen(saveGameName)-4] = '\0';// strip extension
 
@@ -28,6 +28,7 @@
 #include "lib/framework/strres.h"
 #include "lib/framework/wzapp.h"
 #include "lib/framework/rational.h"
+#include "lib/framework/wzconfig.h"
 
 #include "lib/ivis_opengl/pieblitfunc.h"
 #include "lib/ivis_opengl/piestate.h" //ivis render code
@@ -87,6 +88,9 @@
 #include "wrappers.h"
 #include "random.h"
 #include "qtscript.h"
+#include "benchmark.h"
+#include "replay.h"
+#include "tickprofile.h"
 
 #include "warzoneconfig.h"
 
@@ -139,8 +143,89 @@ LEVEL_TYPE nextMissionType = LDS_NONE;
  /* Force 3D display */
 UDWORD	mcTime;
 
+/// Deal with the mission state, returning GAMECODE_CONTINUE unless the game loop needs to be left.
+static GAMECODE updateMissionState()
+{
+	switch (loopMissionState)
+	{
+		case LMS_CLEAROBJECTS:
+			missionDestroyObjects();
+			setScriptPause(true);
+			loopMissionState = LMS_SETUPMISSION;
+			break;
+
+		case LMS_NORMAL:
+			// default
+			break;
+		case LMS_SETUPMISSION:
+			setScriptPause(false);
+			if (!setUpMission(nextMissionType))
+			{
+				return GAMECODE_QUITGAME;
+			}
+			break;
+		case LMS_SAVECONTINUE:
+			// just wait for this to be changed when the new mission starts
+			break;
+		case LMS_NEWLEVEL:
+			//nextMissionType = MISSION_NONE;
+			nextMissionType = LDS_NONE;
+			return GAMECODE_NEWLEVEL;
+			break;
+		case LMS_LOADGAME:
+			return GAMECODE_LOADGAME;
+			break;
+		default:
+			ASSERT( false, "unknown loopMissionState" );
+			break;
+	}
+	return GAMECODE_CONTINUE;
+}
+
+/// The game logic parts of renderLoop(), for headless mode, without any input, drawing or sound.
+static GAMECODE headlessLoop()
+{
+	if (!paused && !gameUpdatePaused())
+	{
+		if (bMultiPlayer)
+		{
+			multiPlayerLoop();
+		}
+		animObj_Update();
+	}
+	if (!consolePaused())
+	{
+		updateConsoleMessages();
+	}
+
+	GAMECODE missionReturn = updateMissionState();
+	if (missionReturn != GAMECODE_CONTINUE)
+	{
+		return missionReturn;
+	}
+	if (replayFinished())
+	{
+		debug(LOG_INFO, "Replay finished at game time %u.", gameTime);
+		return GAMECODE_QUITGAME;
+	}
+	if (benchmarkFinished())
+	{
+		return GAMECODE_QUITGAME;
+	}
+	if (loop_GetVideoStatus())
+	{
+		return GAMECODE_PLAYVIDEO;
+	}
+	return GAMECODE_CONTINUE;
+}
+
 static GAMECODE renderLoop()
 {
+	if (isHeadless())
+	{
+		return headlessLoop();
+	}
+
 	if (bMultiPlayer && !NetPlay.isHostAlive && NetPlay.bComms && !NetPlay.isHost)
 	{
 		intAddInGamePopup();
@@ -148,6 +233,17 @@ static GAMECODE renderLoop()
 
 	audio_Update();
 
+	// Most savegame files are written in the background, so a failure is only known after saveGame has returned.
+	QStringList failedSaves = WzConfig::takeBackgroundWriteFailures();
+	if (!failedSaves.isEmpty())
+	{
+		for (int i = 0; i < failedSaves.size(); ++i)
+		{
+			debug(LOG_ERROR, "\"%s\" was not saved", failedSaves[i].toUtf8().constData());
+		}
+		addConsoleMessage(_("Could not save game!"), LEFT_JUSTIFY, NOTIFY_MESSAGE);
+	}
+
 	wzShowMouse(true);
 
 	INT_RETVAL intRetVal = INT_NONE;
@@ -361,39 +457,10 @@ static GAMECODE renderLoop()
 		}
 	}
 
-	// deal with the mission state
-	switch (loopMissionState)
+	GAMECODE missionReturn = updateMissionState();
+	if (missionReturn != GAMECODE_CONTINUE)
 	{
-		case LMS_CLEAROBJECTS:
-			missionDestroyObjects();
-			setScriptPause(true);
-			loopMissionState = LMS_SETUPMISSION;
-			break;
-
-		case LMS_NORMAL:
-			// default
-			break;
-		case LMS_SETUPMISSION:
-			setScriptPause(false);
-			if (!setUpMission(nextMissionType))
-			{
-				return GAMECODE_QUITGAME;
-			}
-			break;
-		case LMS_SAVECONTINUE:
-			// just wait for this to be changed when the new mission starts
-			break;
-		case LMS_NEWLEVEL:
-			//nextMissionType = MISSION_NONE;
-			nextMissionType = LDS_NONE;
-			return GAMECODE_NEWLEVEL;
-			break;
-		case LMS_LOADGAME:
-			return GAMECODE_LOADGAME;
-			break;
-		default:
-			ASSERT( false, "unknown loopMissionState" );
-			break;
+		return missionReturn;
 	}
 
 	int clearMode = 0;
@@ -563,8 +630,12 @@ static void gameStateUpdate()
 	sendPlayerGameTime();
 	NETflush();  // Make sure the game time tick message is really sent over the network.
 
+	tickProfileBeginTick();
+
 	if (!paused && !scriptPaused())
 	{
+		TickProfileScope scope(TICK_SCRIPTS);
+
 		/* Update the event system */
 		if (!bInTutorial)
 		{
@@ -578,40 +649,59 @@ static void gameStateUpdate()
 	}
 
 	// Update abandoned structures
+	tickProfileBegin(TICK_ABANDONED);
 	handleAbandonedStructures();
+	tickProfileEnd(TICK_ABANDONED);
 
 	// Update the visibility change stuff
 	visUpdateLevel();
 
 	// Put all droids/structures/features into the grid.
+	tickProfileBegin(TICK_GRID);
 	gridReset();
+	tickProfileEnd(TICK_GRID);
 
 	// Check which objects are visible.
+	tickProfileBegin(TICK_VISIBILITY);
 	processVisibility();
+	tickProfileEnd(TICK_VISIBILITY);
 
 	// Update the map.
+	tickProfileBegin(TICK_MAP);
 	mapUpdate();
+	tickProfileEnd(TICK_MAP);
 
 	//update the findpath system
+	tickProfileBegin(TICK_FPATH);
 	fpathUpdate();
+	tickProfileEnd(TICK_FPATH);
 
 	// update the cluster system
+	tickProfileBegin(TICK_CLUSTER);
 	clusterUpdate();
+	tickProfileEnd(TICK_CLUSTER);
 
 	// update the command droids
+	tickProfileBegin(TICK_COMMANDERS);
 	cmdDroidUpdate();
 	if(getDrivingStatus())
 	{
 		driveUpdate();
 	}
+	tickProfileEnd(TICK_COMMANDERS);
 
+	tickProfileBegin(TICK_CALLBACKS);
 	fireWaitingCallbacks(); //Now is the good time to fire waiting callbacks (since interpreter is off now)
+	tickProfileEnd(TICK_CALLBACKS);
 
 	for (unsigned i = 0; i < MAX_PLAYERS; i++)
 	{
 		//update the current power available for a player
+		tickProfileBegin(TICK_POWER);
 		updatePlayerPower(i);
+		tickProfileEnd(TICK_POWER);
 
+		tickProfileBegin(TICK_DROIDS);
 		DROID *psNext;
 		for (DROID *psCurr = apsDroidLists[i]; psCurr != NULL; psCurr = psNext)
 		{
@@ -627,8 +717,10 @@ static void gameStateUpdate()
 			psNext = psCurr->psNext;
 			missionDroidUpdate(psCurr);
 		}
+		tickProfileEnd(TICK_DROIDS);
 
 		// FIXME: These for-loops are code duplicationo
+		tickProfileBegin(TICK_STRUCTURES);
 		STRUCTURE *psNBuilding;
 		for (STRUCTURE *psCBuilding = apsStructLists[i]; psCBuilding != NULL; psCBuilding = psNBuilding)
 		{
@@ -642,21 +734,31 @@ static void gameStateUpdate()
 			psNBuilding = psCBuilding->psNext;
 			structureUpdate(psCBuilding, true); // update for mission
 		}
+		tickProfileEnd(TICK_STRUCTURES);
 	}
 	countUpdate();
 
 	missionTimerUpdate();
 
+	tickProfileBegin(TICK_PROJECTILES);
 	proj_UpdateAll();
+	tickProfileEnd(TICK_PROJECTILES);
 
+	tickProfileBegin(TICK_FEATURES);
 	FEATURE *psNFeat;
 	for (FEATURE *psCFeat = apsFeatureLists[0]; psCFeat; psCFeat = psNFeat)
 	{
 		psNFeat = psCFeat->psNext;
 		featureUpdate(psCFeat);
 	}
+	tickProfileEnd(TICK_FEATURES);
 
+	tickProfileBegin(TICK_OBJMEM);
 	objmemUpdate();
+	tickProfileEnd(TICK_OBJMEM);
+
+	tickProfileEndTick();
+	benchmarkEndTick();
 
 	// Must end update, since we may or may not have ticked, and some message queue processing code may vary depending on whether it's in an update.
 	gameTimeUpdateEnd();
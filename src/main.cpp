@@ -68,6 +68,7 @@
 #include "modding.h"
 #include "multiplay.h"
 #include "qtscript.h"
+#include "replay.h"
 #include "research.h"
 #include "scripttabs.h"
 #include "seqdisp.h"
@@ -773,6 +774,8 @@ static void startGameLoop(void)
 {
 	SetGameMode(GS_NORMAL);
 
+	replayStartRecording();
+
 	// Not sure what aLevelName is, in relation to game.map. But need to use aLevelName here, to be able to start the right map for campaign, and need game.hash, to start the right non-campaign map, if there are multiple identically named maps.
 	if (!levLoadData(aLevelName, &game.hash, NULL, GTYPE_SCENARIO_START))
 	{
@@ -892,6 +895,11 @@ static void runGameLoop(void)
 		case GAMECODE_QUITGAME:
 			debug(LOG_MAIN, "GAMECODE_QUITGAME");
 			stopGameLoop();
+			if (isHeadless())
+			{
+				wzQuit();  // Nobody to use the menus.
+				break;
+			}
 			startTitleLoop(); // Restart into titleloop
 			break;
 		case GAMECODE_LOADGAME:
@@ -29,6 +29,7 @@
 #include "lib/framework/endian_hack.h"
 #include "lib/framework/file.h"
 #include "lib/framework/physfs_ext.h"
+#include "lib/framework/wzconfig.h"
 #include "lib/ivis_opengl/tex.h"
 #include "lib/netplay/netplay.h"  // For syncDebug
 
@@ -49,18 +50,54 @@
 #include "fpath.h"
 #include "levels.h"
 #include "scriptfuncs.h"
+#include "parallel.h"
 #include "lib/framework/wzapp.h"
 
-#define GAME_TICKS_FOR_DANGER (GAME_TICKS_PER_SEC * 2)
+#define GAME_TICKS_FOR_DANGER GAME_TICKS_PER_SEC
 
-static WZ_THREAD *dangerThread = NULL;
-static WZ_SEMAPHORE *dangerSemaphore = NULL;
-static WZ_SEMAPHORE *dangerDoneSemaphore = NULL;
 struct floodtile { uint8_t x; uint8_t y; };
+
+/// A thread flood filling the danger maps of some of the players, in the background.
+struct DangerWorker
+{
+	WZ_THREAD *thread;
+	WZ_SEMAPHORE *semaphore;        ///< Posted to start a flood fill.
+	WZ_SEMAPHORE *doneSemaphore;    ///< Posted when the flood fill is done.
+	struct floodtile *bucket;
+};
+
+static DangerWorker dangerWorkers[PARALLEL_MAX_THREADS];
+static unsigned dangerWorkerCount = 0;
+static bool dangerQuit = false;
+static bool dangerPending = false;                      ///< Workers are flood filling, and the results are not applied yet.
+static int dangerPlayers = 0;                           ///< Number of players being flood filled.
+static uint8_t *dangerAuxMap[MAX_PLAYERS];              ///< Back buffers of the danger bits, swapped in by mapUpdate.
 static struct floodtile *floodbucket = NULL;
-static int bucketcounter;
 static UDWORD lastDangerUpdate = 0;
-static int lastDangerPlayer = -1;
+
+/// A burning tile, in the queue of fires to put out.
+struct FireTile
+{
+	uint32_t endTime;       ///< The gameTime / GAME_TICKS_PER_UPDATE that the fire goes out.
+	uint16_t x, y;
+
+	/// Reversed, so the heap gives the first fire to go out first. Ties go in map order, like scanning the map did.
+	bool operator <(FireTile const &b) const
+	{
+		if (endTime != b.endTime)
+		{
+			return endTime > b.endTime;
+		}
+		return y != b.y ? y > b.y : x > b.x;
+	}
+};
+
+/// Heap of burning tiles. May contain tiles which have since been set on fire for longer, which are skipped.
+static std::vector<FireTile> fireQueue;
+/// Map which fireQueue refers to, so the queue can be rebuilt if the mission code swaps maps.
+static MAPTILE *fireQueueMap = NULL;
+
+static void dangerStopWorkers();
 
 //scroll min and max values
 SDWORD		scrollMinX, scrollMaxX, scrollMinY, scrollMaxY;
@@ -101,6 +138,7 @@ struct GATEWAY_SAVE
 /* The size and contents of the map */
 SDWORD	mapWidth = 0, mapHeight = 0;
 MAPTILE	*psMapTiles = NULL;
+MAPTILE_VISION *psTileVision = NULL;
 uint8_t *psBlockMap[AUX_MAX];
 uint8_t *psAuxMap[MAX_PLAYERS + AUX_MAX];        // yes, we waste one element... eyes wide open... makes API nicer
 
@@ -774,6 +812,8 @@ bool mapLoad(char *filename, bool preview)
 	/* Allocate the memory for the map */
 	psMapTiles = (MAPTILE *)calloc(width * height, sizeof(MAPTILE));
 	ASSERT(psMapTiles != NULL, "Out of memory" );
+	psTileVision = (MAPTILE_VISION *)calloc(width * height, sizeof(MAPTILE_VISION));  // Zeroed, so no one is watching.
+	ASSERT(psTileVision != NULL, "Out of memory" );
 
 	mapWidth = width;
 	mapHeight = height;
@@ -808,12 +848,9 @@ bool mapLoad(char *filename, bool preview)
 		psMapTiles[i].height = height*ELEVATION_SCALE;
 
 		// Visibility stuff
-		memset(psMapTiles[i].watchers, 0, sizeof(psMapTiles[i].watchers));
-		memset(psMapTiles[i].sensors, 0, sizeof(psMapTiles[i].sensors));
-		memset(psMapTiles[i].jammers, 0, sizeof(psMapTiles[i].jammers));
-		psMapTiles[i].sensorBits = 0;
-		psMapTiles[i].jammerBits = 0;
-		psMapTiles[i].tileExploredBits = 0;
+		psTileVision[i].sensorBits = 0;
+		psTileVision[i].jammerBits = 0;
+		psTileVision[i].tileExploredBits = 0;
 	}
 
 	if (preview)
@@ -901,6 +938,7 @@ bool mapLoad(char *filename, bool preview)
 			}
 		}
 	}
+	fpathBlockingTilesChanged(StructureBounds(Vector2i(0, 0), Vector2i(mapWidth, mapHeight)));
 
 	/* Set continents. This should ideally be done in advance by the map editor. */
 	mapFloodFillContinents();
@@ -1011,20 +1049,10 @@ bool mapShutdown(void)
 {
 	int x;
 
-	if (dangerThread)
-	{
-		wzSemaphoreWait(dangerDoneSemaphore);
-		lastDangerPlayer = -1;
-		wzSemaphorePost(dangerSemaphore);
-		wzThreadJoin(dangerThread);
-		wzSemaphoreDestroy(dangerSemaphore);
-		wzSemaphoreDestroy(dangerDoneSemaphore);
-		dangerThread = NULL;
-		dangerSemaphore = NULL;
-		dangerDoneSemaphore = NULL;
-	}
+	dangerStopWorkers();
 
 	free(psMapTiles);
+	free(psTileVision);
 	delete[] mapDecals;
 	free(psGroundTypes);
 	free(map);
@@ -1041,12 +1069,20 @@ bool mapShutdown(void)
 		free(psAuxMap[x]);
 		psAuxMap[x] = NULL;
 	}
+	for (x = 0; x < MAX_PLAYERS; x++)
+	{
+		free(dangerAuxMap[x]);
+		dangerAuxMap[x] = NULL;
+	}
 
 	map = NULL;
 	floodbucket = NULL;
+	fireQueue.clear();
+	fireQueueMap = NULL;
 	psGroundTypes = NULL;
 	mapDecals = NULL;
 	psMapTiles = NULL;
+	psTileVision = NULL;
 	mapWidth = mapHeight = 0;
 	numTile_names = 0;
 	Tile_names = NULL;
@@ -1474,48 +1510,26 @@ void getTileMaxMin(int x, int y, int *pMax, int *pMin)
 /* This will save out the visibility data */
 bool writeVisibilityData(const char* fileName)
 {
-	unsigned int i;
-	VIS_SAVEHEADER fileHeader;
-
-	PHYSFS_file* fileHandle = openSaveFile(fileName);
-	if (!fileHandle)
-	{
-		return false;
-	}
-
-	fileHeader.aFileType[0] = 'v';
-	fileHeader.aFileType[1] = 'i';
-	fileHeader.aFileType[2] = 's';
-	fileHeader.aFileType[3] = 'd';
-
-	fileHeader.version = CURRENT_VERSION_NUM;
+	int planes = (game.maxPlayers + 7)/8;
+	QByteArray data;
+	data.reserve(4 + 4 + planes * mapWidth * mapHeight);
 
-	// Write out the current file header
-	if (PHYSFS_write(fileHandle, fileHeader.aFileType, sizeof(fileHeader.aFileType), 1) != 1
-	 || !PHYSFS_writeUBE32(fileHandle, fileHeader.version))
+	// The file header, "visd" followed by the version as big endian
+	data.append("visd", 4);
+	for (int shift = 24; shift >= 0; shift -= 8)
 	{
-		debug(LOG_ERROR, "writeVisibilityData: could not write header to %s; PHYSFS error: %s", fileName, PHYSFS_getLastError());
-		PHYSFS_close(fileHandle);
-		return false;
+		data.append((char)(CURRENT_VERSION_NUM >> shift));
 	}
 
-	int planes = (game.maxPlayers + 7)/8;
-
 	for (unsigned plane = 0; plane < planes; ++plane)
 	{
-		for (i = 0; i < mapWidth * mapHeight; ++i)
+		for (unsigned i = 0; i < mapWidth * mapHeight; ++i)
 		{
-			if (!PHYSFS_writeUBE8(fileHandle, psMapTiles[i].tileExploredBits >> (plane*8)))
-			{
-				debug(LOG_ERROR, "writeVisibilityData: could not write to %s; PHYSFS error: %s", fileName, PHYSFS_getLastError());
-				PHYSFS_close(fileHandle);
-				return false;
-			}
+			data.append((char)(psTileVision[i].tileExploredBits >> (plane*8)));
 		}
 	}
 
-	// Everything is just fine!
-	PHYSFS_close(fileHandle);
+	WzConfig::saveFileInBackground(fileName, data);
 	return true;
 }
 
@@ -1575,7 +1589,7 @@ bool readVisibilityData(const char* fileName)
 	// For every tile...
 	for(i=0; i<mapWidth*mapHeight; i++)
 	{
-		psMapTiles[i].tileExploredBits = 0;
+		psTileVision[i].tileExploredBits = 0;
 	}
 	for (unsigned plane = 0; plane < planes; ++plane)
 	{
@@ -1589,7 +1603,7 @@ bool readVisibilityData(const char* fileName)
 				PHYSFS_close(fileHandle);
 				return false;
 			}
-			psMapTiles[i].tileExploredBits |= val << (plane*8);
+			psTileVision[i].tileExploredBits |= val << (plane*8);
 		}
 	}
 
@@ -1691,12 +1705,44 @@ void mapFloodFillContinents()
 	debug(LOG_MAP, "Found %d limited and %d hover continents", limitedContinents, hoverContinents);
 }
 
+/** Makes sure fireQueue holds the fires of the current map. */
+static void fireQueueCheckMap()
+{
+	if (fireQueueMap == psMapTiles)
+	{
+		return;
+	}
+
+	// Different map, so find out what is burning on it.
+	const uint32_t currentTime = gameTime / GAME_TICKS_PER_UPDATE;
+	fireQueue.clear();
+	fireQueueMap = psMapTiles;
+	for (int posY = 0; posY < mapHeight; ++posY)
+	{
+		for (int posX = 0; posX < mapWidth; ++posX)
+		{
+			const MAPTILE *tile = mapTile(posX, posY);
+			if ((tile->tileInfoBits & BITS_ON_FIRE) != 0)
+			{
+				FireTile fire;
+				fire.endTime = currentTime + (uint16_t)(tile->fireEndTime - currentTime);
+				fire.x = posX;
+				fire.y = posY;
+				fireQueue.push_back(fire);
+			}
+		}
+	}
+	std::make_heap(fireQueue.begin(), fireQueue.end());
+}
+
 void tileSetFire(int32_t x, int32_t y, uint32_t duration)
 {
 	const int posX = map_coord(x);
 	const int posY = map_coord(y);
 	MAPTILE *const tile = mapTile(posX, posY);
 
+	fireQueueCheckMap();
+
 	uint16_t currentTime =  gameTime             / GAME_TICKS_PER_UPDATE;
 	uint16_t fireEndTime = (gameTime + duration) / GAME_TICKS_PER_UPDATE;
 	if (currentTime == fireEndTime)
@@ -1708,13 +1754,72 @@ void tileSetFire(int32_t x, int32_t y, uint32_t duration)
 		return;  // Tile already on fire, and that fire lasts longer.
 	}
 
+	// The queue already has an entry for this fire if the tile is burning until the same time, and a second one would be saved twice.
+	const bool alreadyQueued = (tile->tileInfoBits & BITS_ON_FIRE) != 0 && tile->fireEndTime == fireEndTime;
+
 	// Burn, tile, burn!
 	tile->tileInfoBits |= BITS_ON_FIRE;
 	tile->fireEndTime = fireEndTime;
 
+	if (!alreadyQueued)
+	{
+		FireTile fire;
+		fire.endTime = (gameTime + duration) / GAME_TICKS_PER_UPDATE;
+		fire.x = posX;
+		fire.y = posY;
+		fireQueue.push_back(fire);
+		std::push_heap(fireQueue.begin(), fireQueue.end());
+	}
+
 	syncDebug("Fire tile{%d, %d} dur%u end%d", posX, posY, duration, fireEndTime);
 }
 
+/** Check whether a fire in the queue is still the one burning on its tile. */
+static bool fireIsBurning(FireTile const &fire)
+{
+	const MAPTILE *tile = mapTile(fire.x, fire.y);
+	return (tile->tileInfoBits & BITS_ON_FIRE) != 0 && tile->fireEndTime == (uint16_t)fire.endTime;
+}
+
+bool writeFireData(const char *fileName)
+{
+	WzConfig ini(fileName, WzConfig::ReadAndWrite, WzConfig::BinaryFileInBackground);
+	int count = 0;
+
+	fireQueueCheckMap();
+	for (unsigned i = 0; i < fireQueue.size(); ++i)
+	{
+		FireTile const &fire = fireQueue[i];
+		if (fireIsBurning(fire) && fire.endTime * GAME_TICKS_PER_UPDATE > gameTime)
+		{
+			ini.beginGroup("fire_" + QString::number(count++));
+			ini.setVector2i("position", Vector2i(fire.x, fire.y));
+			ini.setValue("duration", fire.endTime * GAME_TICKS_PER_UPDATE - gameTime);
+			ini.endGroup();
+		}
+	}
+	return true;
+}
+
+bool readFireData(const char *fileName)
+{
+	WzConfig ini(fileName, WzConfig::ReadOnly);
+	QStringList list = ini.childGroups();
+
+	for (int i = 0; i < list.size(); ++i)
+	{
+		ini.beginGroup(list[i]);
+		Vector2i pos = ini.vector2i("position");
+		uint32_t duration = ini.value("duration").toUInt();
+		if (tileOnMap(pos.x, pos.y))
+		{
+			tileSetFire(world_coord(pos.x), world_coord(pos.y), duration);
+		}
+		ini.endGroup();
+	}
+	return true;
+}
+
 /** Check if tile contained within the given world coordinates is burning. */
 bool fireOnLocation(unsigned int x, unsigned int y)
 {
@@ -1727,28 +1832,25 @@ bool fireOnLocation(unsigned int x, unsigned int y)
 }
 
 // This function runs in a separate thread!
-static int dangerFloodFill(int player)
+/// Flood fills the danger bits of aux from the player's start position, stopping at threatened or blocked tiles.
+/// Reads the block map from psBlockMap[AUX_DANGERMAP], and only touches aux otherwise.
+static void dangerFloodFill(int player, uint8_t *aux, struct floodtile *bucket)
 {
 	int i;
 	Vector2i pos = getPlayerStartPosition(player);
 	Vector2i npos;
-	uint8_t aux, block;
-	int x, y;
+	uint8_t tileAux, block;
+	int bucketcounter = 0;
 	bool start = true;	// hack to disregard the blocking status of any building exactly on the starting position
 
 	// Set our danger bits
-	for (y = 0; y < mapHeight; y++)
+	for (i = 0; i < mapWidth * mapHeight; i++)
 	{
-		for (x = 0; x < mapWidth; x++)
-		{
-			auxSet(x, y, MAX_PLAYERS + AUX_DANGERMAP, AUXBITS_DANGER);
-			auxClear(x, y, MAX_PLAYERS + AUX_DANGERMAP, AUXBITS_TEMPORARY);
-		}
+		aux[i] = (aux[i] | AUXBITS_DANGER) & ~AUXBITS_TEMPORARY;
 	}
 
 	pos.x = map_coord(pos.x);
 	pos.y = map_coord(pos.y);
-	bucketcounter = 0;
 
 	do
 	{
@@ -1761,56 +1863,63 @@ static int dangerFloodFill(int player)
 			{
 				continue;
 			}
-			aux = auxTile(npos.x, npos.y, MAX_PLAYERS + AUX_DANGERMAP);
+			tileAux = aux[npos.x + npos.y * mapWidth];
 			block = blockTile(pos.x, pos.y, AUX_DANGERMAP);
-			if (!(aux & AUXBITS_TEMPORARY) && !(aux & AUXBITS_THREAT) && (aux & AUXBITS_DANGER))
+			if (!(tileAux & AUXBITS_TEMPORARY) && !(tileAux & AUXBITS_THREAT) && (tileAux & AUXBITS_DANGER))
 			{
 				// Note that we do not consider water to be a blocker here. This may or may not be a feature...
-				if (!(block & FEATURE_BLOCKED) && (!(aux & AUXBITS_NONPASSABLE) || start))
+				if (!(block & FEATURE_BLOCKED) && (!(tileAux & AUXBITS_NONPASSABLE) || start))
 				{
-					floodbucket[bucketcounter].x = npos.x;
-					floodbucket[bucketcounter].y = npos.y;
+					bucket[bucketcounter].x = npos.x;
+					bucket[bucketcounter].y = npos.y;
 					bucketcounter++;
-					if (start && !(aux & AUXBITS_NONPASSABLE))
+					if (start && !(tileAux & AUXBITS_NONPASSABLE))
 					{
 						start = false;
 					}
 				}
 				else
 				{
-					auxClear(npos.x, npos.y, MAX_PLAYERS + AUX_DANGERMAP, AUXBITS_DANGER);
+					aux[npos.x + npos.y * mapWidth] &= ~AUXBITS_DANGER;
 				}
-				auxSet(npos.x, npos.y, MAX_PLAYERS + AUX_DANGERMAP, AUXBITS_TEMPORARY); // make sure we do not process it more than once
+				aux[npos.x + npos.y * mapWidth] |= AUXBITS_TEMPORARY; // make sure we do not process it more than once
 			}
 		}
 
 		// Clear danger
-		auxClear(pos.x, pos.y, MAX_PLAYERS + AUX_DANGERMAP, AUXBITS_DANGER);
+		aux[pos.x + pos.y * mapWidth] &= ~AUXBITS_DANGER;
 
 		// Pop the last open node off the bucket list for the next iteration
 		if (bucketcounter)
 		{
 			bucketcounter--;
-			pos.x = floodbucket[bucketcounter].x;
-			pos.y = floodbucket[bucketcounter].y;
+			pos.x = bucket[bucketcounter].x;
+			pos.y = bucket[bucketcounter].y;
 		}
 	} while (bucketcounter);
-	return 0;
 }
 
 // This function runs in a separate thread!
-static int dangerThreadFunc(WZ_DECL_UNUSED void *data)
+static int dangerThreadFunc(void *data)
 {
-	while (lastDangerPlayer != -1)
+	DangerWorker *worker = (DangerWorker *)data;
+	unsigned index = worker - dangerWorkers;
+
+	wzSemaphoreWait(worker->semaphore);	// Go to sleep until needed.
+	while (!dangerQuit)
 	{
-		dangerFloodFill(lastDangerPlayer);	// Do the actual work
-		wzSemaphorePost(dangerDoneSemaphore);   // Signal that we are done
-		wzSemaphoreWait(dangerSemaphore);	// Go to sleep until needed.
+		// Each worker has its own players, so the results do not depend on which worker finishes first.
+		for (int player = index; player < dangerPlayers; player += dangerWorkerCount)
+		{
+			dangerFloodFill(player, dangerAuxMap[player], worker->bucket);	// Do the actual work
+		}
+		wzSemaphorePost(worker->doneSemaphore);	// Signal that we are done
+		wzSemaphoreWait(worker->semaphore);	// Go to sleep until needed.
 	}
 	return 0;
 }
 
-static inline void threatUpdateTarget(int player, BASE_OBJECT *psObj, bool ground, bool air)
+static inline void threatUpdateTarget(int player, uint8_t *aux, BASE_OBJECT *psObj, bool ground, bool air)
 {
 	int i;
 
@@ -1822,27 +1931,25 @@ static inline void threatUpdateTarget(int player, BASE_OBJECT *psObj, bool groun
 
 			if (ground)
 			{
-				auxSet(pos.x, pos.y, MAX_PLAYERS + AUX_DANGERMAP, AUXBITS_THREAT);	// set ground threat for this tile
+				aux[pos.x + pos.y * mapWidth] |= AUXBITS_THREAT;	// set ground threat for this tile
 			}
 			if (air)
 			{
-				auxSet(pos.x, pos.y, MAX_PLAYERS + AUX_DANGERMAP, AUXBITS_AATHREAT);	// set air threat for this tile
+				aux[pos.x + pos.y * mapWidth] |= AUXBITS_AATHREAT;	// set air threat for this tile
 			}
 		}
 	}
 }
 
-static void threatUpdate(int player)
+/// Sets the threat bits of aux from the player's enemies. Only reads the game state, so can run for several players at once.
+static void threatUpdate(int player, uint8_t *aux)
 {
-	int i, weapon, x, y;
+	int i, weapon;
 
 	// Step 1: Clear our threat bits
-	for (y = 0; y < mapHeight; y++)
+	for (i = 0; i < mapWidth * mapHeight; i++)
 	{
-		for (x = 0; x < mapWidth; x++)
-		{
-			auxClear(x, y, MAX_PLAYERS + AUX_DANGERMAP, AUXBITS_THREAT | AUXBITS_AATHREAT);
-		}
+		aux[i] &= ~(AUXBITS_THREAT | AUXBITS_AATHREAT);
 	}
 
 	// Step 2: Set threat bits
@@ -1876,7 +1983,7 @@ static void threatUpdate(int player)
 			}
 			if (mode > 0)
 			{
-				threatUpdateTarget(player, (BASE_OBJECT *)psDroid, mode & SHOOT_ON_GROUND, mode & SHOOT_IN_AIR);
+				threatUpdateTarget(player, aux, (BASE_OBJECT *)psDroid, mode & SHOOT_ON_GROUND, mode & SHOOT_IN_AIR);
 			}
 		}
 
@@ -1894,12 +2001,75 @@ static void threatUpdate(int player)
 			}
 			if (mode > 0)
 			{
-				threatUpdateTarget(player, (BASE_OBJECT *)psStruct, mode & SHOOT_ON_GROUND, mode & SHOOT_IN_AIR);
+				threatUpdateTarget(player, aux, (BASE_OBJECT *)psStruct, mode & SHOOT_ON_GROUND, mode & SHOOT_IN_AIR);
 			}
 		}
 	}
 }
 
+static void threatUpdateFunc(WZ_DECL_UNUSED void *data, unsigned begin, unsigned end, WZ_DECL_UNUSED unsigned thread)
+{
+	for (unsigned player = begin; player < end; ++player)
+	{
+		threatUpdate(player, dangerAuxMap[player]);
+	}
+}
+
+/// Copies the aux maps of the first numPlayers players into the danger back buffers, and sets their threat bits.
+static void dangerPrepare(int numPlayers)
+{
+	memcpy(psBlockMap[AUX_DANGERMAP], psBlockMap[AUX_MAP], sizeof(*psBlockMap[0]) * mapWidth * mapHeight);
+	for (int player = 0; player < numPlayers; player++)
+	{
+		memcpy(dangerAuxMap[player], psAuxMap[player], sizeof(*psAuxMap[0]) * mapWidth * mapHeight);
+	}
+	parallelFor(numPlayers, 1, threatUpdateFunc, NULL);
+}
+
+/// Copies the danger bits of the first numPlayers players from the back buffers into the aux maps.
+static void dangerApply(int numPlayers)
+{
+	const int mask = AUXBITS_DANGER | AUXBITS_THREAT | AUXBITS_AATHREAT;
+
+	for (int player = 0; player < numPlayers; player++)
+	{
+		uint8_t *aux = psAuxMap[player];
+		const uint8_t *cached = dangerAuxMap[player];
+
+		for (int i = 0; i < mapWidth * mapHeight; i++)
+		{
+			aux[i] ^= (aux[i] ^ cached[i]) & mask;
+		}
+		fpathDangerMapChanged(player);
+	}
+}
+
+/// Waits for the workers to finish any flood fills, and stops them.
+static void dangerStopWorkers()
+{
+	if (dangerWorkerCount == 0)
+	{
+		return;
+	}
+
+	for (unsigned i = 0; i < dangerWorkerCount && dangerPending; i++)
+	{
+		wzSemaphoreWait(dangerWorkers[i].doneSemaphore);
+	}
+	dangerPending = false;
+	dangerQuit = true;
+	for (unsigned i = 0; i < dangerWorkerCount; i++)
+	{
+		wzSemaphorePost(dangerWorkers[i].semaphore);
+		wzThreadJoin(dangerWorkers[i].thread);
+		wzSemaphoreDestroy(dangerWorkers[i].semaphore);
+		wzSemaphoreDestroy(dangerWorkers[i].doneSemaphore);
+		free(dangerWorkers[i].bucket);
+		memset(&dangerWorkers[i], 0, sizeof(dangerWorkers[i]));
+	}
+	dangerWorkerCount = 0;
+}
+
 void mapInit()
 {
 	int player;
@@ -1908,57 +2078,80 @@ void mapInit()
 	floodbucket = (struct floodtile *)malloc(mapWidth * mapHeight * sizeof(*floodbucket));
 
 	lastDangerUpdate = 0;
-	lastDangerPlayer = -1;
+	dangerPending = false;
 
 	// Initialize danger maps
 	for (player = 0; player < MAX_PLAYERS; player++)
 	{
-		auxMapStore(player, AUX_DANGERMAP);
-		threatUpdate(player);
-		dangerFloodFill(player);
-		auxMapRestore(player, AUX_DANGERMAP, AUXBITS_DANGER | AUXBITS_THREAT | AUXBITS_AATHREAT);
+		free(dangerAuxMap[player]);
+		dangerAuxMap[player] = (uint8_t *)malloc(mapWidth * mapHeight * sizeof(*dangerAuxMap[0]));
 	}
+	dangerPrepare(MAX_PLAYERS);
+	for (player = 0; player < MAX_PLAYERS; player++)
+	{
+		dangerFloodFill(player, dangerAuxMap[player], floodbucket);
+	}
+	dangerApply(MAX_PLAYERS);
 
-	// Start thread
-	ASSERT(dangerSemaphore == NULL && dangerThread == NULL, "Map data not cleaned up before starting!");
+	// Start threads
+	ASSERT(dangerWorkerCount == 0, "Map data not cleaned up before starting!");
 	if (game.type == SKIRMISH)
 	{
-		lastDangerPlayer = 0;
-		dangerSemaphore = wzSemaphoreCreate(0);
-		dangerDoneSemaphore = wzSemaphoreCreate(0);
-		dangerThread = wzThreadCreate(dangerThreadFunc, NULL);
-		wzThreadStart(dangerThread);
+		dangerQuit = false;
+		dangerWorkerCount = std::min<unsigned>(parallelThreads(), MAX_PLAYERS);
+		for (unsigned i = 0; i < dangerWorkerCount; i++)
+		{
+			dangerWorkers[i].semaphore = wzSemaphoreCreate(0);
+			dangerWorkers[i].doneSemaphore = wzSemaphoreCreate(0);
+			dangerWorkers[i].bucket = (struct floodtile *)malloc(mapWidth * mapHeight * sizeof(*dangerWorkers[i].bucket));
+			dangerWorkers[i].thread = wzThreadCreate(dangerThreadFunc, &dangerWorkers[i]);
+			wzThreadStart(dangerWorkers[i].thread);
+		}
 	}
 }
 
 void mapUpdate()
 {
-	const uint16_t currentTime = gameTime / GAME_TICKS_PER_UPDATE;
-	int posX, posY;
+	const uint32_t currentTime = gameTime / GAME_TICKS_PER_UPDATE;
 
-	for (posY = 0; posY < mapHeight; ++posY)
-		for (posX = 0; posX < mapWidth; ++posX)
+	fireQueueCheckMap();
+	while (!fireQueue.empty() && fireQueue.front().endTime <= currentTime)
 	{
-		MAPTILE *const tile = mapTile(posX, posY);
+		const FireTile fire = fireQueue.front();
+		std::pop_heap(fireQueue.begin(), fireQueue.end());
+		fireQueue.pop_back();
 
-		if ((tile->tileInfoBits & BITS_ON_FIRE) != 0 && tile->fireEndTime == currentTime)
+		if (fireIsBurning(fire))
 		{
 			// Extinguish, tile, extinguish!
-			tile->tileInfoBits &= ~BITS_ON_FIRE;
+			mapTile(fire.x, fire.y)->tileInfoBits &= ~BITS_ON_FIRE;
 
-			syncDebug("Extinguished tile{%d, %d}", posX, posY);
+			syncDebug("Extinguished tile{%d, %d}", fire.x, fire.y);
 		}
 	}
 
-	if (gameTime > lastDangerUpdate + GAME_TICKS_FOR_DANGER && game.type == SKIRMISH)
+	if (gameTime > lastDangerUpdate + GAME_TICKS_FOR_DANGER && dangerWorkerCount > 0)
 	{
-		// Lock if previous job not done yet
-		wzSemaphoreWait(dangerDoneSemaphore);
+		lastDangerUpdate = gameTime;
+
+		// The results of the last cycle must be applied at a fixed game time to stay in sync, so wait if the workers
+		// are somehow still busy. They have had a whole cycle to finish, so this should not normally block.
+		if (dangerPending)
+		{
+			for (unsigned i = 0; i < dangerWorkerCount; i++)
+			{
+				wzSemaphoreWait(dangerWorkers[i].doneSemaphore);
+			}
+			dangerApply(dangerPlayers);
+		}
 
-		auxMapRestore(lastDangerPlayer, AUX_DANGERMAP, AUXBITS_THREAT | AUXBITS_AATHREAT | AUXBITS_DANGER);
-		lastDangerPlayer = (lastDangerPlayer + 1 ) % game.maxPlayers;
-		auxMapStore(lastDangerPlayer, AUX_DANGERMAP);
-		threatUpdate(lastDangerPlayer);
-		wzSemaphorePost(dangerSemaphore);
+		// Update the threat bits of all players now, while the game state holds still, and flood fill in the background.
+		dangerPlayers = game.maxPlayers;
+		dangerPrepare(dangerPlayers);
+		dangerPending = true;
+		for (unsigned i = 0; i < dangerWorkerCount; i++)
+		{
+			wzSemaphorePost(dangerWorkers[i].semaphore);
+		}
 	}
 }
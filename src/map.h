@@ -94,10 +94,7 @@ struct GROUND_TYPE
 struct MAPTILE
 {
 	uint8_t			tileInfoBits;
-	PlayerMask              tileExploredBits;
-	PlayerMask              sensorBits;             ///< bit per player, who can see tile with sensor
 	uint8_t			illumination;	// How bright is this tile?
-	uint8_t			watchers[MAX_PLAYERS];		// player sees through fog of war here with this many objects
 	uint16_t		texture;		// Which graphics texture is on this tile
 	int32_t                 height;                 ///< The height at the top left of the tile
 	float                   level;                  ///< The visibility level of the top left of the tile, for this client.
@@ -108,7 +105,16 @@ struct MAPTILE
 	uint8_t			ground;			///< The ground type used for the terrain renderer
 	uint16_t                fireEndTime;            ///< The (uint16_t)(gameTime / GAME_TICKS_PER_UPDATE) that BITS_ON_FIRE should be cleared.
 	int32_t                 waterLevel;             ///< At what height is the water for this tile
+};
+
+/// Who can see a tile. Kept in a separate layer from MAPTILE, so that updating visibility does not drag the rest of
+/// the tile through the cache, and MAPTILE stays half the size for the terrain height and render code.
+struct MAPTILE_VISION
+{
+	PlayerMask              tileExploredBits;
+	PlayerMask              sensorBits;             ///< bit per player, who can see tile with sensor
 	PlayerMask		jammerBits;             ///< bit per player, who is jamming tile
+	uint8_t                 watchers[MAX_PLAYERS];  ///< player sees through fog of war here with this many objects
 	uint8_t                 sensors[MAX_PLAYERS];   ///< player sees this tile with this many radar sensors
 	uint8_t                 jammers[MAX_PLAYERS];   ///< player jams the tile with this many objects
 };
@@ -116,11 +122,18 @@ struct MAPTILE
 /* The size and contents of the map */
 extern SDWORD	mapWidth, mapHeight;
 extern MAPTILE *psMapTiles;
+extern MAPTILE_VISION *psTileVision;  ///< Who can see each tile, in the same order as psMapTiles.
 extern float waterLevel;
 extern GROUND_TYPE *psGroundTypes;
 extern int numGroundTypes;
 extern char *tilesetDir;
 
+/** Return the visibility of a tile returned by mapTile() */
+static inline WZ_DECL_PURE MAPTILE_VISION *mapTileVision(const MAPTILE *psTile)
+{
+	return &psTileVision[psTile - psMapTiles];
+}
+
 #define AIR_BLOCKED		0x01	///< Aircraft cannot pass tile
 #define FEATURE_BLOCKED		0x02	///< Ground units cannot pass tile due to item in the way
 #define WATER_BLOCKED		0x04	///< Units that cannot pass water are blocked by this tile
@@ -291,7 +304,7 @@ static inline bool TileIsBurning(const MAPTILE *tile)
 /** Check if tile has been explored. */
 static inline bool tileIsExplored(const MAPTILE *psTile)
 {
-	return psTile->tileExploredBits & (1 << selectedPlayer);
+	return mapTileVision(psTile)->tileExploredBits & (1 << selectedPlayer);
 }
 
 /** Check if tile contains a small structure. Function is NOT thread-safe. */
@@ -314,10 +327,10 @@ static inline bool TileHasSmallStructure(const MAPTILE* tile)
 #define TOGGLE_TRIFLIP(x)	((x)->texture ^= TILE_TRIFLIP)
 
 /* Can player number p has explored tile t? */
-#define TEST_TILE_VISIBLE(p,t)	((t)->tileExploredBits & (1<<(p)))
+#define TEST_TILE_VISIBLE(p,t)	(mapTileVision(t)->tileExploredBits & (1<<(p)))
 
 /* Set a tile to be visible for a player */
-#define SET_TILE_VISIBLE(p,t) ((t)->tileExploredBits |= alliancebits[p])
+#define SET_TILE_VISIBLE(p,t) (mapTileVision(t)->tileExploredBits |= alliancebits[p])
 
 /* Arbitrary maximum number of terrain textures - used in look up table for terrain type */
 #define MAX_TILE_TEXTURES	255
@@ -541,13 +554,18 @@ extern void mapTest(void);
 void tileSetFire(int32_t x, int32_t y, uint32_t duration);
 extern bool fireOnLocation(unsigned int x, unsigned int y);
 
+/// Save the burning tiles, and how long they have left to burn.
+bool writeFireData(const char *fileName);
+/// Load the burning tiles. The game time must already be restored.
+bool readFireData(const char *fileName);
+
 /**
  * Transitive sensor check for tile. Has to be here rather than
  * visibility.h due to header include order issues. 
  */
 WZ_DECL_ALWAYS_INLINE static inline bool hasSensorOnTile(MAPTILE *psTile, unsigned player)
 {
-	return ((player == selectedPlayer && godMode) || (alliancebits[selectedPlayer] & (satuplinkbits | psTile->sensorBits)));
+	return ((player == selectedPlayer && godMode) || (alliancebits[selectedPlayer] & (satuplinkbits | mapTileVision(psTile)->sensorBits)));
 }
 
 void mapInit(void);
@@ -31,125 +31,375 @@
 #include "mapgrid.h"
 #include "pointtree.h"
 
+#include <algorithm>
+#include <map>
 
-static PointTree *gridPointTree = NULL;  // A quad-tree-like object.
-static PointTree::Filter *gridFiltersUnseen;
+
+// Structures and features don't move, so they are kept in their own tree, which is only changed when they are added or removed.
+// Droids move, so their tree is rebuilt every tick.
+static PointTree *gridDroidTree = NULL;   // A quad-tree-like object, containing droids.
+static PointTree *gridStaticTree = NULL;  // A quad-tree-like object, containing structures and features.
+static PointTree::Filter *gridDroidFiltersUnseen;
+static PointTree::Filter *gridStaticFiltersUnseen;
 static PointTree::Filter *gridFiltersDroidsByPlayer;
+static bool gridDroidFiltersUnseenValid[MAX_PLAYERS];   // Filters are reset on first use each tick, since most players never use them.
+static bool gridStaticFiltersUnseenValid[MAX_PLAYERS];
+static bool gridFiltersDroidsByPlayerValid[MAX_PLAYERS];
+
+enum GridStaticList
+{
+	GRID_STRUCTURES,
+	GRID_FEATURES,
+	GRID_STATIC_LISTS
+};
+
+/// A structure or feature which was added to or removed from its list since the last gridReset.
+struct GridStaticChange
+{
+	GridStaticChange(BASE_OBJECT *psObj_, bool added_) : psObj(psObj_), added(added_) {}
+	BASE_OBJECT *psObj;  ///< Not dereferenced when removed, since it may already have been freed.
+	bool added;
+};
+
+static std::vector<GridStaticChange> gridStaticChanges;
+
+// Searches from places in the same GRID_SHARED_REGION_SIZE square, with radii rounded up to the same multiple of GRID_SHARED_RADIUS_STEP,
+// share one search of the point trees, see gridStartIterateShared.
+#define GRID_SHARED_REGION_SIZE (4*TILE_UNITS)
+#define GRID_SHARED_RADIUS_STEP (2*TILE_UNITS)
+#define GRID_SHARED_MAX_RADIUS  (32*TILE_UNITS)  // Bigger searches aren't shared.
+
+struct GridSharedObject
+{
+	GridObject object;
+	uint64_t sortKey;  ///< Point tree sort key, for merging the droid and static results.
+};
+
+static std::vector<GridObject> gridSharedObjects;                                 // Results of all shared searches since the last gridReset.
+static std::map<GridSharedKey, std::pair<unsigned, unsigned> > gridSharedSearches;  // Where in gridSharedObjects the results of each shared search are.
+static std::vector<GridObject> gridAll;  // Everything in the grid, see gridAllObjects.
+static bool gridAllValid = false;
+static bool gridStaticRebuild = true;  // Set by gridStaticListsReplaced.
+
+static BASE_OBJECT *gridStaticListHead(unsigned list, unsigned player)
+{
+	return list == GRID_STRUCTURES ? (BASE_OBJECT *)apsStructLists[player] : (BASE_OBJECT *)apsFeatureLists[player];
+}
+
+// Returns whether psObj is, or is about to be, in the current structure or feature lists.
+static bool gridIsStaticObject(BASE_OBJECT *psObj)
+{
+	return (psObj->type == OBJ_STRUCTURE && psObj->player < MAX_PLAYERS) || psObj->type == OBJ_FEATURE;
+}
+
+// Objects used to be put in a single tree, player by player, with each player's droids, then structures, then features, each in list order.
+// Returns the position of the list psObj was in, which decides the order of objects in the same place.
+static unsigned gridObjectRank(void const *psObj)
+{
+	BASE_OBJECT const *obj = static_cast<BASE_OBJECT const *>(psObj);
+	switch (obj->type)
+	{
+		case OBJ_DROID:   return obj->player*3;
+		case OBJ_FEATURE: return 2;  // All features are in apsFeatureLists[0].
+		default:          return obj->player*3 + 1;
+	}
+}
+
+// Within a list, objects in the same place are in list order, which PointTree::sort keeps, since new objects go both at the start of
+// their list and before older points.
+static bool gridObjectRankLess(void const *a, void const *b)
+{
+	return gridObjectRank(a) < gridObjectRank(b);
+}
 
 // initialise the grid system
 bool gridInitialise(void)
 {
-	ASSERT(gridPointTree == NULL, "gridInitialise already called, without calling gridShutDown.");
-	gridPointTree = new PointTree;
-	gridFiltersUnseen = new PointTree::Filter[MAX_PLAYERS];
+	ASSERT(gridDroidTree == NULL, "gridInitialise already called, without calling gridShutDown.");
+	gridDroidTree = new PointTree;
+	gridStaticTree = new PointTree;
+	gridDroidFiltersUnseen = new PointTree::Filter[MAX_PLAYERS];
+	gridStaticFiltersUnseen = new PointTree::Filter[MAX_PLAYERS];
 	gridFiltersDroidsByPlayer = new PointTree::Filter[MAX_PLAYERS];
+	gridStaticChanges.clear();
+	gridStaticRebuild = true;
+	gridSharedObjects.clear();
+	gridSharedSearches.clear();
+	gridAll.clear();
+	gridAllValid = false;
 
 	return true;  // Yay, nothing failed!
 }
 
-// reset the grid system
-void gridReset(void)
+void gridAddStaticObject(BASE_OBJECT *psObj)
+{
+	if (gridStaticTree == NULL || !gridIsStaticObject(psObj) || psObj->died)
+	{
+		return;
+	}
+	gridStaticChanges.push_back(GridStaticChange(psObj, true));
+}
+
+void gridRemoveStaticObject(BASE_OBJECT *psObj)
+{
+	if (gridStaticTree == NULL || !gridIsStaticObject(psObj) || psObj->died)
+	{
+		return;
+	}
+	gridStaticChanges.push_back(GridStaticChange(psObj, false));
+}
+
+void gridStaticListsReplaced()
 {
-	gridPointTree->clear();
+	gridStaticRebuild = true;
+	gridStaticChanges.clear();  // May refer to freed objects.
+}
 
-	// Put all existing objects into the point tree.
-	for (unsigned player = 0; player < MAX_PLAYERS; player++)
+static void gridRebuildStaticTree()
+{
+	gridStaticTree->clear();
+	for (unsigned player = 0; player < MAX_PLAYERS; ++player)
 	{
-		BASE_OBJECT *start[3] = {(BASE_OBJECT *)apsDroidLists[player], (BASE_OBJECT *)apsStructLists[player], (BASE_OBJECT *)apsFeatureLists[player]};
-		for (unsigned type = 0; type != sizeof(start)/sizeof(*start); ++type)
+		for (unsigned list = 0; list < GRID_STATIC_LISTS; ++list)
 		{
-			for (BASE_OBJECT *psObj = start[type]; psObj != NULL; psObj = psObj->psNext)
+			for (BASE_OBJECT *psObj = gridStaticListHead(list, player); psObj != NULL; psObj = psObj->psNext)
 			{
 				if (!psObj->died)
 				{
-					gridPointTree->insert(psObj, psObj->pos.x, psObj->pos.y);
-					for (unsigned viewer = 0; viewer < MAX_PLAYERS; ++viewer)
-					{
-						psObj->seenThisTick[viewer] = 0;
-					}
+					gridStaticTree->insert(psObj, psObj->pos.x, psObj->pos.y);
 				}
 			}
 		}
 	}
+	gridStaticTree->sort(gridObjectRankLess);
+	gridStaticChanges.clear();
+	gridStaticRebuild = false;
+}
 
-	gridPointTree->sort();
+static void gridUpdateStaticTree()
+{
+	if (gridStaticRebuild)
+	{
+		gridRebuildStaticTree();
+		return;
+	}
+	if (gridStaticChanges.empty())
+	{
+		return;
+	}
+
+	// Remove everything which changed, then put back everything whose last change was being added, newest first, as in the lists.
+	std::vector<void *> changed(gridStaticChanges.size());
+	for (unsigned n = 0; n < gridStaticChanges.size(); ++n)
+	{
+		changed[n] = gridStaticChanges[n].psObj;
+	}
+	std::sort(changed.begin(), changed.end());
+	changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+	gridStaticTree->erase(changed);
+
+	std::vector<bool> done(changed.size(), false);
+	for (unsigned n = gridStaticChanges.size(); n-- > 0; )
+	{
+		GridStaticChange const &change = gridStaticChanges[n];
+		unsigned index = std::lower_bound(changed.begin(), changed.end(), (void *)change.psObj) - changed.begin();
+		if (done[index])
+		{
+			continue;  // Object was changed again later.
+		}
+		done[index] = true;
+		if (change.added && !change.psObj->died)
+		{
+			gridStaticTree->insert(change.psObj, change.psObj->pos.x, change.psObj->pos.y);
+		}
+	}
+	gridStaticTree->sort(gridObjectRankLess);
+	gridStaticChanges.clear();
+}
+
+// reset the grid system
+void gridReset(void)
+{
+	gridDroidTree->clear();
+
+	// Put all existing droids into the point tree.
+	for (unsigned player = 0; player < MAX_PLAYERS; player++)
+	{
+		for (DROID *psDroid = apsDroidLists[player]; psDroid != NULL; psDroid = psDroid->psNext)
+		{
+			if (!psDroid->died)
+			{
+				gridDroidTree->insert(psDroid, psDroid->pos.x, psDroid->pos.y);
+			}
+		}
+	}
+
+	gridDroidTree->sort();
+
+	// Structures and features only need updating if some were added or removed.
+	gridUpdateStaticTree();
+
+	gridSharedObjects.clear();
+	gridSharedSearches.clear();
+	gridAllValid = false;
+	aiInvalidateTargetCandidates();  // Filtered copies of the shared searches.
 
 	for (unsigned player = 0; player < MAX_PLAYERS; ++player)
 	{
-		gridFiltersUnseen[player].reset(*gridPointTree);
-		gridFiltersDroidsByPlayer[player].reset(*gridPointTree);
+		gridDroidFiltersUnseenValid[player] = false;
+		gridStaticFiltersUnseenValid[player] = false;
+		gridFiltersDroidsByPlayerValid[player] = false;
 	}
 }
 
 // shutdown the grid system
 void gridShutDown(void)
 {
-	delete gridPointTree;
-	gridPointTree = NULL;
-	delete[] gridFiltersUnseen;
-	gridFiltersUnseen = NULL;
+	delete gridDroidTree;
+	gridDroidTree = NULL;
+	delete gridStaticTree;
+	gridStaticTree = NULL;
+	delete[] gridDroidFiltersUnseen;
+	gridDroidFiltersUnseen = NULL;
+	delete[] gridStaticFiltersUnseen;
+	gridStaticFiltersUnseen = NULL;
 	delete[] gridFiltersDroidsByPlayer;
 	gridFiltersDroidsByPlayer = NULL;
+	gridStaticChanges.clear();
+	gridSharedObjects.clear();
+	gridSharedSearches.clear();
+	gridAll.clear();
+	gridAllValid = false;
+	aiInvalidateTargetCandidates();
 }
 
-static bool isInRadius(int32_t x, int32_t y, uint32_t radius)
+static PointTree::Filter *gridFilter(PointTree::Filter *filters, bool *valid, PointTree const &pointTree, int player)
 {
-	return (uint32_t)(x*x + y*y) <= radius*radius;
+	if (!valid[player])
+	{
+		filters[player].reset(pointTree);
+		valid[player] = true;
+	}
+	return &filters[player];
 }
 
-// initialise the grid system to start iterating through units that
-// could affect a location (x,y in world coords)
+static GridQuery gridQuery;  // Used by the non-reentrant functions.
+
+// Appends objects in the point tree within radius to query.list.
 template<class Condition>
-static GridList const &gridStartIterateFiltered(int32_t x, int32_t y, uint32_t radius, PointTree::Filter *filter, Condition const &condition)
+static void gridQueryFiltered(GridQuery &query, PointTree const *pointTree, int32_t x, int32_t y, uint32_t radius, PointTree::Filter *filter, Condition const &condition)
 {
 	if (filter == NULL)
 	{
-		gridPointTree->query(x, y, radius);
+		pointTree->query(query.points, query.indices, x, y, radius);
 	}
 	else
 	{
-		gridPointTree->query(*filter, x, y, radius);
+		pointTree->query(query.points, query.indices, *filter, x, y, radius);
 	}
-	PointTree::ResultVector::iterator w = gridPointTree->lastQueryResults.begin(), i;
-	for (i = w; i != gridPointTree->lastQueryResults.end(); ++i)
+	for (unsigned n = 0; n < query.points.size(); ++n)
 	{
-		BASE_OBJECT *obj = static_cast<BASE_OBJECT *>(*i);
+		BASE_OBJECT *obj = static_cast<BASE_OBJECT *>(query.points[n]);
 		if (!condition.test(obj))  // Check if we should skip this object.
 		{
-			filter->erase(gridPointTree->lastFilteredQueryIndices[i - gridPointTree->lastQueryResults.begin()]);  // Stop the object from appearing in future searches.
+			filter->erase(query.indices[n]);  // Stop the object from appearing in future searches.
 		}
-		else if (isInRadius(obj->pos.x - x, obj->pos.y - y, radius))  // Check that search result is less than radius (since they can be up to a factor of sqrt(2) more).
+		else if (gridIsInRadius(obj->pos.x - x, obj->pos.y - y, radius))  // Check that search result is less than radius (since they can be up to a factor of sqrt(2) more).
 		{
-			*w = *i;
-			++w;
+			query.list.push_back(obj);
+			query.keys.push_back(pointTree->sortKey(query.indices[n]));
 		}
 	}
-	gridPointTree->lastQueryResults.erase(w, i);  // Erase all points that were a bit too far.
-	/*
-	// In case you are curious.
-	debug(LOG_WARNING, "gridStartIterateFiltered(%d, %d, %u) found %u objects", x, y, radius, (unsigned)gridPointTree->lastQueryResults.size());
-	*/
-	static GridList gridList;
-	gridList.resize(gridPointTree->lastQueryResults.size());
-	for (unsigned n = 0; n < gridList.size(); ++n)
+}
+
+// Returns true if the structure or feature psStatic, found at key staticKey, would have come before the droid psDroid, found at droidKey,
+// in a single tree holding all objects.
+static bool gridStaticBeforeDroid(uint64_t staticKey, BASE_OBJECT *psStatic, uint64_t droidKey, BASE_OBJECT *psDroid)
+{
+	if (staticKey != droidKey)
 	{
-		gridList[n] = (BASE_OBJECT *)gridPointTree->lastQueryResults[n];
+		return staticKey < droidKey;
 	}
-	return gridList;
+	return gridObjectRank(psStatic) < gridObjectRank(psDroid);
 }
 
+static bool gridSharedObjectLess(GridSharedObject const &a, GridSharedObject const &b)
+{
+	if (a.sortKey != b.sortKey)
+	{
+		return a.sortKey < b.sortKey;
+	}
+	return gridObjectRank(a.object.psObj) < gridObjectRank(b.object.psObj);
+}
+
+// Merges the droids in query.list before split with the structures and features after split, keeping the order of each part.
+// Each tree returns its objects sorted along the Z-order curve, so this gives the same order as a single tree holding all objects.
+static void gridMergeStatic(GridQuery &query, unsigned split)
+{
+	unsigned end = query.list.size();
+	if (split == 0 || split == end)
+	{
+		return;  // Nothing to merge.
+	}
+	query.merged.clear();
+	unsigned d = 0, s = split;
+	while (d < split && s < end)
+	{
+		if (gridStaticBeforeDroid(query.keys[s], query.list[s], query.keys[d], query.list[d]))
+		{
+			query.merged.push_back(query.list[s++]);
+		}
+		else
+		{
+			query.merged.push_back(query.list[d++]);
+		}
+	}
+	query.merged.insert(query.merged.end(), query.list.begin() + d, query.list.begin() + split);
+	query.merged.insert(query.merged.end(), query.list.begin() + s, query.list.end());
+	query.list.swap(query.merged);
+}
+
+// initialise the grid system to start iterating through units that
+// could affect a location (x,y in world coords)
+// Results are in the same order as if droids, structures and features were all in one tree, unless !includeStatic.
 template<class Condition>
-static GridList const &gridStartIterateFilteredArea(int32_t x, int32_t y, int32_t x2, int32_t y2, Condition const &condition)
+static GridList const &gridStartIterateFiltered(GridQuery &query, int32_t x, int32_t y, uint32_t radius, PointTree::Filter *droidFilter, PointTree::Filter *staticFilter, bool includeStatic, Condition const &condition)
 {
-	gridPointTree->query(x, y, x2, y2);
+	query.list.clear();
+	query.keys.clear();
+	gridQueryFiltered(query, gridDroidTree, x, y, radius, droidFilter, condition);
+	if (includeStatic)
+	{
+		unsigned split = query.list.size();
+		gridQueryFiltered(query, gridStaticTree, x, y, radius, staticFilter, condition);
+		gridMergeStatic(query, split);
+	}
+	/*
+	// In case you are curious.
+	debug(LOG_WARNING, "gridStartIterateFiltered(%d, %d, %u) found %u objects", x, y, radius, (unsigned)query.list.size());
+	*/
+	return query.list;
+}
 
-	static GridList gridList;
-	gridList.resize(gridPointTree->lastQueryResults.size());
-	for (unsigned n = 0; n < gridList.size(); ++n)
+template<class Condition>
+static GridList const &gridStartIterateFilteredArea(GridQuery &query, int32_t x, int32_t y, int32_t x2, int32_t y2, Condition const &condition)
+{
+	query.list.clear();
+	query.keys.clear();
+	unsigned split = 0;
+	PointTree const *pointTrees[2] = {gridDroidTree, gridStaticTree};
+	for (unsigned tree = 0; tree < 2; ++tree)
 	{
-		gridList[n] = (BASE_OBJECT *)gridPointTree->lastQueryResults[n];
+		split = query.list.size();
+		pointTrees[tree]->query(query.points, query.indices, x, y, x2, y2);
+		for (unsigned n = 0; n < query.points.size(); ++n)
+		{
+			query.list.push_back((BASE_OBJECT *)query.points[n]);
+			query.keys.push_back(pointTrees[tree]->sortKey(query.indices[n]));
+		}
 	}
-	return gridList;
+	gridMergeStatic(query, split);
+	return query.list;
 }
 
 struct ConditionTrue
@@ -160,14 +410,123 @@ struct ConditionTrue
 	}
 };
 
+GridList const &gridStartIterate(GridQuery &query, int32_t x, int32_t y, uint32_t radius)
+{
+	return gridStartIterateFiltered(query, x, y, radius, NULL, NULL, true, ConditionTrue());
+}
+
 GridList const &gridStartIterate(int32_t x, int32_t y, uint32_t radius)
 {
-	return gridStartIterateFiltered(x, y, radius, NULL, ConditionTrue());
+	return gridStartIterate(gridQuery, x, y, radius);
+}
+
+static int32_t gridSharedRegion(int32_t coord)
+{
+	return coord >= 0 ? coord/GRID_SHARED_REGION_SIZE : -1 - (-1 - coord)/GRID_SHARED_REGION_SIZE;  // Round down, even if negative.
+}
+
+bool gridSharedKey(GridSharedKey &key, int32_t x, int32_t y, uint32_t radius)
+{
+	key.regionX = gridSharedRegion(x);
+	key.regionY = gridSharedRegion(y);
+	key.radiusSteps = (radius + GRID_SHARED_RADIUS_STEP - 1)/GRID_SHARED_RADIUS_STEP;
+	return radius <= GRID_SHARED_MAX_RADIUS;
+}
+
+GridObject const *gridSharedSearch(GridSharedKey const &key, unsigned *count)
+{
+	std::map<GridSharedKey, std::pair<unsigned, unsigned> >::iterator search = gridSharedSearches.find(key);
+	if (search == gridSharedSearches.end())
+	{
+		// Search a square containing the squares searched by gridStartIterate from anywhere in the region, with any radius rounding up to the same step.
+		int32_t border = key.radiusSteps*GRID_SHARED_RADIUS_STEP;
+		int32_t minX = key.regionX*GRID_SHARED_REGION_SIZE - border, maxX = (key.regionX + 1)*GRID_SHARED_REGION_SIZE - 1 + border;
+		int32_t minY = key.regionY*GRID_SHARED_REGION_SIZE - border, maxY = (key.regionY + 1)*GRID_SHARED_REGION_SIZE - 1 + border;
+		static std::vector<Vector2i> positions;          // static to avoid allocations.
+		static std::vector<GridSharedObject> found;      // static to avoid allocations.
+		found.clear();
+		unsigned split = 0;
+		PointTree const *pointTrees[2] = {gridDroidTree, gridStaticTree};
+		for (unsigned tree = 0; tree < 2; ++tree)
+		{
+			split = found.size();
+			pointTrees[tree]->query(gridQuery.points, positions, gridQuery.indices, minX, minY, maxX, maxY);
+			for (unsigned n = 0; n < gridQuery.points.size(); ++n)
+			{
+				GridSharedObject object = {{static_cast<BASE_OBJECT *>(gridQuery.points[n]), positions[n]}, pointTrees[tree]->sortKey(gridQuery.indices[n])};
+				found.push_back(object);
+			}
+		}
+		// Same order as gridStartIterate, see gridMergeStatic.
+		std::inplace_merge(found.begin(), found.begin() + split, found.end(), gridSharedObjectLess);
+		unsigned begin = gridSharedObjects.size();
+		for (unsigned n = 0; n < found.size(); ++n)
+		{
+			gridSharedObjects.push_back(found[n].object);
+		}
+		search = gridSharedSearches.insert(std::make_pair(key, std::make_pair(begin, (unsigned)gridSharedObjects.size()))).first;
+	}
+
+	*count = search->second.second - search->second.first;
+	return *count != 0? &gridSharedObjects[search->second.first] : NULL;
+}
+
+GridList const &gridStartIterateShared(int32_t x, int32_t y, uint32_t radius)
+{
+	GridSharedKey key;
+	if (!gridSharedKey(key, x, y, radius))
+	{
+		return gridStartIterate(x, y, radius);
+	}
+
+	unsigned count;
+	GridObject const *objects = gridSharedSearch(key, &count);
+
+	// The point trees return points in the order they are stored, so picking out what gridStartIterate would have found, using the
+	// same tests, gives the same results in the same order.
+	gridQuery.list.clear();
+	for (unsigned n = 0; n < count; ++n)
+	{
+		if (gridIsInSearch(objects[n], x, y, radius))
+		{
+			gridQuery.list.push_back(objects[n].psObj);
+		}
+	}
+	return gridQuery.list;
+}
+
+std::vector<GridObject> const &gridAllObjects()
+{
+	if (gridAllValid)
+	{
+		return gridAll;
+	}
+
+	// Merge the two trees, as gridMergeStatic does.
+	gridAll.clear();
+	gridAll.reserve(gridDroidTree->size() + gridStaticTree->size());
+	unsigned d = 0, s = 0;
+	while (d < gridDroidTree->size() || s < gridStaticTree->size())
+	{
+		bool takeStatic = d == gridDroidTree->size() || (s < gridStaticTree->size() && gridStaticBeforeDroid(gridStaticTree->sortKey(s), static_cast<BASE_OBJECT *>(gridStaticTree->data(s)),
+		                                                                                                      gridDroidTree->sortKey(d), static_cast<BASE_OBJECT *>(gridDroidTree->data(d))));
+		PointTree const *pointTree = takeStatic ? gridStaticTree : gridDroidTree;
+		unsigned index = takeStatic ? s++ : d++;
+		GridObject object = {static_cast<BASE_OBJECT *>(pointTree->data(index)), pointTree->position(index)};
+		gridAll.push_back(object);
+	}
+	gridAllValid = true;
+	return gridAll;
+}
+
+GridList const &gridStartIterateArea(GridQuery &query, int32_t x, int32_t y, uint32_t x2, uint32_t y2)
+{
+	return gridStartIterateFilteredArea(query, x, y, x2, y2, ConditionTrue());
 }
 
 GridList const &gridStartIterateArea(int32_t x, int32_t y, uint32_t x2, uint32_t y2)
 {
-	return gridStartIterateFilteredArea(x, y, x2, y2, ConditionTrue());
+	return gridStartIterateArea(gridQuery, x, y, x2, y2);
 }
 
 struct ConditionDroidsByPlayer
@@ -180,9 +539,14 @@ struct ConditionDroidsByPlayer
 	int player;
 };
 
+GridList const &gridStartIterateDroidsByPlayer(GridQuery &query, int32_t x, int32_t y, uint32_t radius, int player)
+{
+	return gridStartIterateFiltered(query, x, y, radius, gridFilter(gridFiltersDroidsByPlayer, gridFiltersDroidsByPlayerValid, *gridDroidTree, player), NULL, false, ConditionDroidsByPlayer(player));
+}
+
 GridList const &gridStartIterateDroidsByPlayer(int32_t x, int32_t y, uint32_t radius, int player)
 {
-	return gridStartIterateFiltered(x, y, radius, &gridFiltersDroidsByPlayer[player], ConditionDroidsByPlayer(player));
+	return gridStartIterateDroidsByPlayer(gridQuery, x, y, radius, player);
 }
 
 struct ConditionUnseen
@@ -195,15 +559,21 @@ struct ConditionUnseen
 	int player;
 };
 
+GridList const &gridStartIterateUnseen(GridQuery &query, int32_t x, int32_t y, uint32_t radius, int player)
+{
+	return gridStartIterateFiltered(query, x, y, radius, gridFilter(gridDroidFiltersUnseen, gridDroidFiltersUnseenValid, *gridDroidTree, player),
+	                                gridFilter(gridStaticFiltersUnseen, gridStaticFiltersUnseenValid, *gridStaticTree, player), true, ConditionUnseen(player));
+}
+
 GridList const &gridStartIterateUnseen(int32_t x, int32_t y, uint32_t radius, int player)
 {
-	return gridStartIterateFiltered(x, y, radius, &gridFiltersUnseen[player], ConditionUnseen(player));
+	return gridStartIterateUnseen(gridQuery, x, y, radius, player);
 }
 
 BASE_OBJECT **gridIterateDup(void)
 {
-	size_t bytes = gridPointTree->lastQueryResults.size()*sizeof(void *);
+	size_t bytes = gridQuery.list.size()*sizeof(void *);
 	BASE_OBJECT **ret = (BASE_OBJECT **)malloc(bytes);
-	memcpy(ret, &gridPointTree->lastQueryResults[0], bytes);
+	memcpy(ret, &gridQuery.list[0], bytes);
 	return ret;
 }
@@ -28,6 +28,18 @@
 typedef std::vector<BASE_OBJECT *> GridList;
 typedef GridList::const_iterator GridIterator;
 
+/// Holds the results of a grid query. Queries which are given their own GridQuery don't touch any shared state, except for
+/// the per-player filters used by gridStartIterateDroidsByPlayer and gridStartIterateUnseen, so they can be run from several
+/// threads at once between calls to gridReset, as long as no two threads query for the same player at the same time.
+struct GridQuery
+{
+	GridList list;                  ///< The objects found by the last query.
+	std::vector<void *> points;     ///< Scratch space.
+	std::vector<unsigned> indices;  ///< Scratch space.
+	std::vector<uint64_t> keys;     ///< Scratch space.
+	GridList merged;                ///< Scratch space.
+};
+
 
 // initialise the grid system
 extern bool gridInitialise(void);
@@ -36,9 +48,19 @@ extern bool gridInitialise(void);
 extern void gridShutDown(void);
 
 // Reset the grid system. Called once per update.
-// Resets seenThisTick[] to false.
+// Rebuilds the droid part of the grid, structures and features are only updated if some were added, removed or replaced.
 extern void gridReset(void);
 
+/// Call after adding a structure or feature to the start of its object list, so the grid doesn't need rebuilding.
+void gridAddStaticObject(BASE_OBJECT *psObj);
+
+/// Call before removing a structure or feature from its object list, so the grid doesn't need rebuilding.
+void gridRemoveStaticObject(BASE_OBJECT *psObj);
+
+/// Call after replacing or freeing whole structure or feature lists, such as when swapping in the mission lists, so that the next
+/// gridReset rebuilds the grid from the lists.
+void gridStaticListsReplaced(void);
+
 /// Find all objects within radius.
 GridList const &gridStartIterate(int32_t x, int32_t y, uint32_t radius);
 
@@ -53,4 +75,58 @@ GridList const &gridStartIterateDroidsByPlayer(int32_t x, int32_t y, uint32_t ra
 /// Find all objects within radius where object->seenThisTick[player] != 255.
 GridList const &gridStartIterateUnseen(int32_t x, int32_t y, uint32_t radius, int player);
 
+/// Find all objects within radius, with the same results in the same order as gridStartIterate. Searches from nearby places with
+/// similar radii share one search of the grid, which is kept until the next gridReset, for code such as target selection where many
+/// objects close to each other search the same area every tick.
+GridList const &gridStartIterateShared(int32_t x, int32_t y, uint32_t radius);
+
+/// An object in the grid, with where it was put in the grid. Droids may have moved since.
+struct GridObject
+{
+	BASE_OBJECT *psObj;
+	Vector2i gridPos;
+};
+
+/// Identifies the search of the grid which gridStartIterateShared calls from nearby places with similar radii share.
+struct GridSharedKey
+{
+	bool operator <(GridSharedKey const &b) const
+	{
+		return regionX != b.regionX ? regionX < b.regionX : regionY != b.regionY ? regionY < b.regionY : radiusSteps < b.radiusSteps;
+	}
+	int32_t regionX, regionY;
+	uint32_t radiusSteps;
+};
+
+/// Sets key to the shared search gridStartIterateShared(x, y, radius) uses. Returns false if searches this big aren't shared.
+bool gridSharedKey(GridSharedKey &key, int32_t x, int32_t y, uint32_t radius);
+
+/// Returns the count objects gridStartIterateShared picks from for the key, in gridStartIterate order, for code which keeps its own
+/// filtered copy of them. gridIsInSearch picks out what a search would return. Valid until the next gridReset or shared search.
+GridObject const *gridSharedSearch(GridSharedKey const &key, unsigned *count);
+
+/// Returns all objects in the grid, in the order the gridStartIterate functions return them, for code which buckets objects itself.
+/// gridStartIterate(x, y, radius) returns, in this order, exactly the objects for which gridIsInSearch is true. Valid until the next gridReset.
+std::vector<GridObject> const &gridAllObjects();
+
+/// The radius test used by the gridStartIterate functions, on the offset from the centre of the search to the current position of an object.
+static inline bool gridIsInRadius(int32_t x, int32_t y, uint32_t radius)
+{
+	return (uint32_t)(x*x + y*y) <= radius*radius;
+}
+
+/// Whether gridStartIterate(x, y, radius) returns the object: it was put in the grid in the square around (x, y), and is now within radius.
+static inline bool gridIsInSearch(GridObject const &object, int32_t x, int32_t y, uint32_t radius)
+{
+	return object.gridPos.x >= x - (int32_t)radius && object.gridPos.x <= x + (int32_t)radius
+	    && object.gridPos.y >= y - (int32_t)radius && object.gridPos.y <= y + (int32_t)radius
+	    && gridIsInRadius(object.psObj->pos.x - x, object.psObj->pos.y - y, radius);
+}
+
+/// Reentrant versions of the above, see GridQuery.
+GridList const &gridStartIterate(GridQuery &query, int32_t x, int32_t y, uint32_t radius);
+GridList const &gridStartIterateArea(GridQuery &query, int32_t x, int32_t y, uint32_t x2, uint32_t y2);
+GridList const &gridStartIterateDroidsByPlayer(GridQuery &query, int32_t x, int32_t y, uint32_t radius, int player);
+GridList const &gridStartIterateUnseen(GridQuery &query, int32_t x, int32_t y, uint32_t radius, int player);
+
 #endif // __INCLUDED_SRC_MAPGRID_H__
@@ -324,12 +324,14 @@ bool missionShutDown(void)
 			apsExtractorLists[inc] = mission.apsExtractorLists[inc];
 			mission.apsExtractorLists[inc] = NULL;
 		}
+		gridStaticListsReplaced();
 		apsSensorList[0] = mission.apsSensorList[0];
 		apsOilList[0] = mission.apsOilList[0];
 		mission.apsSensorList[0] = NULL;
 		mission.apsOilList[0] = NULL;
 
 		psMapTiles = mission.psMapTiles;
+		psTileVision = mission.psTileVision;
 		mapWidth = mission.mapWidth;
 		mapHeight = mission.mapHeight;
 		for (int i = 0; i < ARRAY_SIZE(mission.psBlockMap); ++i)
@@ -711,6 +713,7 @@ static void saveMissionData(void)
 
 	//save the mission data
 	mission.psMapTiles = psMapTiles;
+	mission.psTileVision = psTileVision;
 	mission.mapWidth = mapWidth;
 	mission.mapHeight = mapHeight;
 	for (int i = 0; i < ARRAY_SIZE(mission.psBlockMap); ++i)
@@ -793,6 +796,7 @@ static void saveMissionData(void)
 		mission.apsFlagPosLists[inc] = apsFlagPosLists[inc];
 		mission.apsExtractorLists[inc] = apsExtractorLists[inc];
 	}
+	gridStaticListsReplaced();
 	mission.apsSensorList[0] = apsSensorList[0];
 	mission.apsOilList[0] = apsOilList[0];
 
@@ -861,12 +865,14 @@ void restoreMissionData(void)
 		apsExtractorLists[inc] = mission.apsExtractorLists[inc];
 		mission.apsExtractorLists[inc] = NULL;
 	}
+	gridStaticListsReplaced();
 	apsSensorList[0] = mission.apsSensorList[0];
 	apsOilList[0] = mission.apsOilList[0];
 	mission.apsSensorList[0] = NULL;
 	//swap mission data over
 
 	psMapTiles = mission.psMapTiles;
+	psTileVision = mission.psTileVision;
 
 	mapWidth = mission.mapWidth;
 	mapHeight = mission.mapHeight;
@@ -887,6 +893,7 @@ void restoreMissionData(void)
 	gwSetGateways(mission.psGateways);
 	//and clear the mission pointers
 	mission.psMapTiles	= NULL;
+	mission.psTileVision	= NULL;
 	mission.mapWidth	= 0;
 	mission.mapHeight	= 0;
 	mission.scrollMinX	= 0;
@@ -1374,6 +1381,7 @@ void swapMissionPointers(void)
 	debug(LOG_SAVE, "called");
 
 	std::swap(psMapTiles, mission.psMapTiles);
+	std::swap(psTileVision, mission.psTileVision);
 	std::swap(mapWidth,   mission.mapWidth);
 	std::swap(mapHeight,  mission.mapHeight);
 	for (int i = 0; i < ARRAY_SIZE(mission.psBlockMap); ++i)
@@ -1400,6 +1408,7 @@ void swapMissionPointers(void)
 		std::swap(apsFlagPosLists[inc],   mission.apsFlagPosLists[inc]);
 		std::swap(apsExtractorLists[inc], mission.apsExtractorLists[inc]);
 	}
+	gridStaticListsReplaced();
 	std::swap(apsSensorList[0], mission.apsSensorList[0]);
 	std::swap(apsOilList[0],    mission.apsOilList[0]);
 }
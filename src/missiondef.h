@@ -53,6 +53,7 @@ struct MISSION
 {
 	UDWORD				type;							//defines which start and end functions to use - see levels_type in levels.h
 	MAPTILE				*psMapTiles;					//the original mapTiles
+	MAPTILE_VISION                 *psTileVision;                   //the original vision counters
 	int32_t                         mapWidth;                       //the original mapWidth
 	int32_t                         mapHeight;                      //the original mapHeight
 	uint8_t                        *psBlockMap[AUX_MAX];
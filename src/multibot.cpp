@@ -379,7 +379,7 @@ bool recvDroid(NETQUEUE queue)
 	// If we were able to build the droid set it up
 	if (psDroid)
 	{
-		psDroid->id = id;
+		setObjectId(psDroid, id);
 		addDroid(psDroid, apsDroidLists);
 
 		if (haveInitialOrders)
@@ -407,7 +407,8 @@ bool recvDroid(NETQUEUE queue)
 
 
 /// Does not read/write info->droidId!
-static void NETQueuedDroidInfo(QueuedDroidInfo *info)
+/// Target IDs and positions are encoded relative to prev, the previous order in the batch. Since the orders are sorted, they are usually close together.
+static void NETQueuedDroidInfo(QueuedDroidInfo *info, QueuedDroidInfo const &prev)
 {
 	NETuint8_t(&info->player);
 	NETenum(&info->subType);
@@ -418,12 +419,16 @@ static void NETQueuedDroidInfo(QueuedDroidInfo *info)
 			NETenum(&info->order);
 			if (info->subType == ObjOrder)
 			{
-				NETuint32_t(&info->destId);
+				int32_t deltaDestId = info->destId - prev.destId;
+				NETint32_t(&deltaDestId);
+				info->destId = prev.destId + deltaDestId;
 				NETenum(&info->destType);
 			}
 			else
 			{
-				NETauto(&info->pos);
+				Vector2i deltaPos = info->pos - prev.pos;
+				NETauto(&deltaPos);
+				info->pos = prev.pos + deltaPos;
 			}
 			if (info->order == DORDER_BUILD || info->order == DORDER_LINEBUILD)
 			{
@@ -432,7 +437,9 @@ static void NETQueuedDroidInfo(QueuedDroidInfo *info)
 			}
 			if (info->order == DORDER_LINEBUILD)
 			{
-				NETauto(&info->pos2);
+				Vector2i deltaPos2 = info->pos2 - info->pos;
+				NETauto(&deltaPos2);
+				info->pos2 = info->pos + deltaPos2;
 			}
 			if (info->order == DORDER_BUILDMODULE)
 			{
@@ -450,18 +457,36 @@ static void NETQueuedDroidInfo(QueuedDroidInfo *info)
 // Actually send the droid info.
 void sendQueuedDroidInfo()
 {
+	if (queuedOrders.empty())
+	{
+		return;  // Nothing to send.
+	}
+
 	// Sort queued orders, to group the same order to multiple droids.
 	std::sort(queuedOrders.begin(), queuedOrders.end());
 
-	std::vector<QueuedDroidInfo>::iterator eqBegin, eqEnd;
-	for (eqBegin = queuedOrders.begin(); eqBegin != queuedOrders.end(); eqBegin = eqEnd)
+	uint32_t numOrders = 1;
+	for (std::vector<QueuedDroidInfo>::iterator i = queuedOrders.begin() + 1; i != queuedOrders.end(); ++i)
 	{
-		// Find end of range of orders which differ only by the droid ID.
-		for (eqEnd = eqBegin + 1; eqEnd != queuedOrders.end() && eqEnd->orderCompare(*eqBegin) == 0; ++eqEnd)
-		{}
+		numOrders += i->orderCompare(*(i - 1)) != 0;
+	}
+
+	// All orders go in a single message, so selecting 100+ droids and giving orders doesn't cost a message header per order.
+	NETbeginEncode(NETgameQueue(selectedPlayer), GAME_DROIDINFO);
+		NETuint32_t(&numOrders);
 
-		NETbeginEncode(NETgameQueue(selectedPlayer), GAME_DROIDINFO);
-			NETQueuedDroidInfo(&*eqBegin);
+		QueuedDroidInfo prevInfo;
+		memset(&prevInfo, 0x00, sizeof(prevInfo));
+
+		std::vector<QueuedDroidInfo>::iterator eqBegin, eqEnd;
+		for (eqBegin = queuedOrders.begin(); eqBegin != queuedOrders.end(); eqBegin = eqEnd)
+		{
+			// Find end of range of orders which differ only by the droid ID.
+			for (eqEnd = eqBegin + 1; eqEnd != queuedOrders.end() && eqEnd->orderCompare(*eqBegin) == 0; ++eqEnd)
+			{}
+
+			NETQueuedDroidInfo(&*eqBegin, prevInfo);
+			prevInfo = *eqBegin;
 
 			uint32_t num = eqEnd - eqBegin;
 			NETuint32_t(&num);
@@ -477,8 +502,8 @@ void sendQueuedDroidInfo()
 
 				prevDroidId = droidId;
 			}
-		NETend();
-	}
+		}
+	NETend();
 
 	// Sent the orders. Don't send them again.
 	queuedOrders.clear();
@@ -559,24 +584,88 @@ void sendDroidInfo(DROID *psDroid, DroidOrder const &order, bool add)
 // receive droid information form other players.
 bool recvDroidInfo(NETQUEUE queue)
 {
+	// Static, to avoid reallocating for each message.
+	static std::vector<QueuedDroidInfo> infos;     // One entry per droid, droids with the same order are consecutive.
+	static std::vector<unsigned>        orderEnds; // Index in infos after the last droid of each order.
+	static std::vector<DROID *>         droids;    // The droid of each entry in infos, or NULL if not found.
+	infos.clear();
+	orderEnds.clear();
+
 	NETbeginDecode(queue, GAME_DROIDINFO);
 	{
-		QueuedDroidInfo info;
-		memset(&info, 0x00, sizeof(info));
-		NETQueuedDroidInfo(&info);
+		// Every value takes at least a byte, so no valid message has more orders or droids than bytes.
+		const uint32_t maxCount = NETgetMessage(queue)->data.size();
+
+		uint32_t numOrders = 0;
+		NETuint32_t(&numOrders);
+		numOrders = std::min(numOrders, maxCount);
+
+		QueuedDroidInfo prevInfo;
+		memset(&prevInfo, 0x00, sizeof(prevInfo));
+
+		for (unsigned o = 0; o < numOrders; ++o)
+		{
+			QueuedDroidInfo info;
+			memset(&info, 0x00, sizeof(info));
+			NETQueuedDroidInfo(&info, prevInfo);
+			prevInfo = info;
+
+			uint32_t num = 0;
+			NETuint32_t(&num);
+			num = std::min<uint32_t>(num, maxCount - std::min<size_t>(infos.size(), maxCount));
+
+			for (unsigned n = 0; n < num; ++n)
+			{
+				// Get the next droid ID which is being given this order.
+				uint32_t deltaDroidId = 0;
+				NETuint32_t(&deltaDroidId);
+				info.droidId += deltaDroidId;
+				infos.push_back(info);
+			}
+			orderEnds.push_back(infos.size());
+		}
+	}
+	if (!NETend())
+	{
+		debug(LOG_ERROR, "Bad GAME_DROIDINFO message from player %d.", queue.index);
+		syncDebug("Bad droid info.");
+		return false;
+	}
+
+	// Look up all the droids of the batch at once, instead of in between executing orders.
+	droids.resize(infos.size());
+	for (unsigned i = 0; i < infos.size(); ++i)
+	{
+		droids[i] = IdToDroid(infos[i].droidId, infos[i].player);
+	}
 
-		STRUCTURE_STATS *psStats = NULL;
+	STRUCTURE_STATS *psStats = NULL;
+	unsigned begin = 0;
+	for (unsigned o = 0; o < orderEnds.size(); begin = orderEnds[o], ++o)
+	{
+		if (begin == orderEnds[o])
+		{
+			continue;  // Order for no droids.
+		}
+		QueuedDroidInfo const &info = infos[begin];
+
+		STRUCTURE_STATS *psOrderStats = NULL;
 		if (info.subType == LocOrder && (info.order == DORDER_BUILD || info.order == DORDER_LINEBUILD))
 		{
-			// Find structure target
-			for (unsigned typeIndex = 0; typeIndex < numStructureStats; typeIndex++)
+			// Find structure target, usually the same as for the previous build order.
+			if (psStats == NULL || psStats->ref != info.structRef)
 			{
-				if (asStructureStats[typeIndex].ref == info.structRef)
+				psStats = NULL;
+				for (unsigned typeIndex = 0; typeIndex < numStructureStats; typeIndex++)
 				{
-					psStats = asStructureStats + typeIndex;
-					break;
+					if (asStructureStats[typeIndex].ref == info.structRef)
+					{
+						psStats = asStructureStats + typeIndex;
+						break;
+					}
 				}
 			}
+			psOrderStats = psStats;
 		}
 
 		switch (info.subType)
@@ -586,24 +675,16 @@ bool recvDroidInfo(NETQUEUE queue)
 			case SecondaryOrder: syncDebug("SecondaryOrder=%d,%08X", (int)info.secOrder, (int)info.secState); break;
 		}
 
-		DROID_ORDER_DATA sOrder = infoToOrderData(info, psStats);
-
-		uint32_t num = 0;
-		NETuint32_t(&num);
+		DROID_ORDER_DATA sOrder = infoToOrderData(info, psOrderStats);
 
-		for (unsigned n = 0; n < num; ++n)
+		for (unsigned n = begin; n < orderEnds[o]; ++n)
 		{
-			// Get the next droid ID which is being given this order.
-			uint32_t deltaDroidId = 0;
-			NETuint32_t(&deltaDroidId);
-			info.droidId += deltaDroidId;
-
-			DROID *psDroid = IdToDroid(info.droidId, info.player);
-			if (!psDroid)
+			DROID *psDroid = droids[n];
+			if (!psDroid || psDroid->died != 0)
 			{
 				debug(LOG_NEVER, "Packet from %d refers to non-existent droid %u, [%s : p%d]",
-				      queue.index, info.droidId, isHumanPlayer(info.player) ? "Human" : "AI", info.player);
-				syncDebug("Droid %d missing", info.droidId);
+				      queue.index, infos[n].droidId, isHumanPlayer(info.player) ? "Human" : "AI", info.player);
+				syncDebug("Droid %d missing", infos[n].droidId);
 				continue;  // Can't find the droid, so skip this droid.
 			}
 			if (!canGiveOrdersFor(queue.index, psDroid->player))
@@ -656,7 +737,6 @@ bool recvDroidInfo(NETQUEUE queue)
 			CHECK_DROID(psDroid);
 		}
 	}
-	NETend();
 
 	return true;
 }
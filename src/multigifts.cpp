@@ -405,6 +405,7 @@ void requestAlliance(uint8_t from, uint8_t to, bool prop, bool allowAudio)
 	syncDebug("Request alliance %d %d", from, to);
 	alliances[from][to] = ALLIANCE_REQUESTED;	// We've asked
 	alliances[to][from] = ALLIANCE_INVITATION;	// They've been invited
+	aiInvalidateTargetCandidates();
 
 
 	CBallFrom = from;
@@ -456,6 +457,7 @@ void breakAlliance(uint8_t p1, uint8_t p2, bool prop, bool allowAudio)
 	alliances[p2][p1] = ALLIANCE_BROKEN;
 	alliancebits[p1] &= ~(1 << p2);
 	alliancebits[p2] &= ~(1 << p1);
+	aiInvalidateTargetCandidates();
 }
 
 void formAlliance(uint8_t p1, uint8_t p2, bool prop, bool allowAudio, bool allowNotification)
@@ -479,6 +481,7 @@ void formAlliance(uint8_t p1, uint8_t p2, bool prop, bool allowAudio, bool allow
 	syncDebug("Form alliance %d %d", p1, p2);
 	alliances[p1][p2] = ALLIANCE_FORMED;
 	alliances[p2][p1] = ALLIANCE_FORMED;
+	aiInvalidateTargetCandidates();
 	if (alliancesSharedVision(game.alliance))	// this is for shared vision only
 	{
 		alliancebits[p1] |= 1 << p2;
@@ -656,7 +659,7 @@ void recvMultiPlayerFeature(NETQUEUE queue)
 		{
 			// Create a feature of the specified type at the given location
 			FEATURE *result = buildFeature(&asFeatureStats[i], x, y, false);
-			result->id = id;
+			setObjectId(result, id);
 			break;
 		}
 	}
@@ -210,8 +210,8 @@ static int difficultyIcon(int difficulty);
 // ////////////////////////////////////////////////////////////////////////////
 // map previews..
 
-static const char *difficultyList[] = { N_("Easy"), N_("Medium"), N_("Hard"), N_("Insane") };
-static const int difficultyValue[] = { 1, 10, 15, 20 };
+const char *difficultyList[DIFFICULTY_COUNT] = { N_("Easy"), N_("Medium"), N_("Hard"), N_("Insane") };
+const int difficultyValue[DIFFICULTY_COUNT] = { 1, 10, 15, 20 };
 static struct
 {
 	bool scavengers;
@@ -3278,6 +3278,37 @@ void startMultiplayerGame(void)
 	}
 }
 
+// ////////////////////////////////////////////////////////////////////////////
+// Start the game set up in game, ingame and NetPlay.players, without the options screen or the network.
+bool startGameWithoutFrontend(uint32_t randomSeed)
+{
+	// Find the map, like recvOptions() does.
+	levShutDown();
+	levInitialise();
+	rebuildSearchPath(mod_multiplay, true);
+	buildMapList();
+	LEVEL_DATASET *mapData = levFindDataSet(game.map, &game.hash);
+	if (mapData == NULL)
+	{
+		debug(LOG_ERROR, "Map \"%s\" not found.", game.map);
+		return false;
+	}
+	game.hash = levGetFileHash(mapData);
+
+	// Start it, like the NET_FIREUP handler does.
+	NetPlay.bComms = false;
+	ingame.localOptionsReceived = true;
+	ingame.TimeEveryoneIsInGame = 0;
+	gameSRand(randomSeed);
+	decideWRF();
+
+	bMultiPlayer = true;
+	bMultiMessages = true;
+	changeTitleMode(STARTGAME);
+	bHosted = false;
+	return true;
+}
+
 // ////////////////////////////////////////////////////////////////////////////
 // Net message handling
 
@@ -103,11 +103,17 @@ void updateLimitFlags(void);
 extern	void	runMultiOptions			(void);
 extern	bool	startMultiOptions		(bool bReenter);
 extern	void	frontendMultiMessages	(void);
+/// Starts the game set up in game, ingame and NetPlay.players, without the options screen or the network. Used for replays and benchmarks.
+bool startGameWithoutFrontend(uint32_t randomSeed);
 
 bool addMultiBut(W_SCREEN *screen, UDWORD formid, UDWORD id, UDWORD x, UDWORD y, UDWORD width, UDWORD height, const char* tipres, UDWORD norm, UDWORD down, UDWORD hi, unsigned tc = MAX_PLAYERS);
 bool changeColour(unsigned player, int col, bool isHost);
 extern	char	sPlayer[128];
 
+#define DIFFICULTY_COUNT 4
+extern const char *difficultyList[DIFFICULTY_COUNT];  ///< AI difficulty names, untranslated.
+extern const int difficultyValue[DIFFICULTY_COUNT];   ///< game.skDiff of each AI difficulty.
+
 extern bool bHosted;
 
 void	kickPlayer(uint32_t player_id, const char *reason, LOBBY_ERROR_TYPES type);
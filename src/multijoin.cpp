@@ -455,6 +455,7 @@ void setupNewPlayer(UDWORD player)
 	}
 
 	resetMultiVisibility(player);						// set visibility flags.
+	aiInvalidateTargetCandidates();
 
 	setMultiStats(player, getMultiStats(player), true);  // get the players score
 
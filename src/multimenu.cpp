@@ -711,6 +711,10 @@ static void displayExtraGubbins(UDWORD height)
 		iV_DrawText(str, MULTIMENU_FORM_X + xPos, MULTIMENU_FORM_Y + height + yPos);
 		xPos += iV_GetTextWidth(str) + 20;
 
+		sprintf(str, _("Serialised: %u"), NETgetStatistic(NetStatisticSerializedBytes, true, isTotal));
+		iV_DrawText(str, MULTIMENU_FORM_X + xPos, MULTIMENU_FORM_Y + height + yPos);
+		xPos += iV_GetTextWidth(str) + 20;
+
 		sprintf(str, _("Pack: %u/%u"), NETgetStatistic(NetStatisticPackets, true, isTotal), NETgetStatistic(NetStatisticPackets, false, isTotal));
 		iV_DrawText(str, MULTIMENU_FORM_X + xPos, MULTIMENU_FORM_Y + height + yPos);
 	}
@@ -292,28 +292,12 @@ bool multiPlayerLoop(void)
 // to get droids ...
 DROID *IdToDroid(UDWORD id, UDWORD player)
 {
-	if (player == ANYPLAYER)
-	{
-		for (int i = 0; i < MAX_PLAYERS; i++)
-		{
-			for (DROID *d = apsDroidLists[i]; d; d = d->psNext)
-			{
-				if (d->id == id)
-				{
-					return d;
-				}
-			}
-		}
-	}
-	else if (player < MAX_PLAYERS)
+	// Only droids in the current lists, so not in transporters, off-world or in limbo.
+	DROID *psDroid = (DROID *)findCurrentObjectById(id, OBJ_DROID);
+
+	if (psDroid != NULL && (player == ANYPLAYER || psDroid->player == player))
 	{
-		for (DROID *d = apsDroidLists[player]; d; d = d->psNext)
-		{
-			if (d->id == id)
-			{
-				return d;
-			}
-		}
+		return psDroid;
 	}
 	return NULL;
 }
@@ -322,25 +306,11 @@ DROID *IdToDroid(UDWORD id, UDWORD player)
 // find a structure
 STRUCTURE *IdToStruct(UDWORD id, UDWORD player)
 {
-	int beginPlayer = 0, endPlayer = MAX_PLAYERS;
-	if (player != ANYPLAYER)
-	{
-		beginPlayer = player;
-		endPlayer = std::min<int>(player + 1, MAX_PLAYERS);
-	}
-	STRUCTURE **lists[2] = {apsStructLists, mission.apsStructLists};
-	for (int j = 0; j < 2; ++j)
+	STRUCTURE *psStruct = (STRUCTURE *)findObjectById(id, OBJ_STRUCTURE);
+
+	if (psStruct != NULL && (player == ANYPLAYER || psStruct->player == player))
 	{
-		for (int i = beginPlayer; i < endPlayer; ++i)
-		{
-			for (STRUCTURE *d = lists[j][i]; d; d = d->psNext)
-			{
-				if (d->id == id)
-				{
-					return d;
-				}
-			}
-		}
+		return psStruct;
 	}
 	return NULL;
 }
@@ -350,14 +320,7 @@ STRUCTURE *IdToStruct(UDWORD id, UDWORD player)
 FEATURE *IdToFeature(UDWORD id, UDWORD player)
 {
 	(void)player;	// unused, all features go into player 0
-	for (FEATURE *d = apsFeatureLists[0]; d; d = d->psNext)
-	{
-		if (d->id == id)
-		{
-			return d;
-		}
-	}
-	return NULL;
+	return (FEATURE *)findCurrentObjectById(id, OBJ_FEATURE);
 }
 
 // ////////////////////////////////////////////////////////////////////////////
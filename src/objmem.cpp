@@ -26,6 +26,7 @@
 #include <string.h>
 
 #include "lib/framework/frame.h"
+#include "lib/framework/objectpool.h"
 #include "objects.h"
 #include "lib/gamelib/gtime.h"
 #include "lib/netplay/netplay.h"
@@ -41,11 +42,14 @@
 #include "structuredef.h"
 #include "structure.h"
 #include "droid.h"
+#include "projectile.h"
 #include "mapgrid.h"
 #include "combat.h"
 #include "visibility.h"
 #include "qtscript.h"
 
+#include <QtCore/QHash>
+
 // the initial value for the object ID
 #define OBJ_ID_INIT 20000
 
@@ -69,10 +73,58 @@ FLAG_POSITION	*apsFlagPosLists[MAX_PLAYERS];
 /* The list of destroyed objects */
 BASE_OBJECT		*psDestroyedObj=NULL;
 
+/* The pools the objects are allocated from, so that creating and destroying objects in battle doesn't go through the system allocator. */
+static ObjectPool droidPool("droids", sizeof(DROID));
+static ObjectPool structurePool("structures", sizeof(STRUCTURE));
+static ObjectPool featurePool("features", sizeof(FEATURE), 1024);
+static ObjectPool projectilePool("projectiles", sizeof(PROJECTILE), 1024);
+
+void *DROID::operator new(size_t size)
+{
+	return droidPool.allocate(size);
+}
+
+void DROID::operator delete(void *droid)
+{
+	droidPool.free(droid);
+}
+
+void *STRUCTURE::operator new(size_t size)
+{
+	return structurePool.allocate(size);
+}
+
+void STRUCTURE::operator delete(void *structure)
+{
+	structurePool.free(structure);
+}
+
+void *FEATURE::operator new(size_t size)
+{
+	return featurePool.allocate(size);
+}
+
+void FEATURE::operator delete(void *feature)
+{
+	featurePool.free(feature);
+}
+
+void *PROJECTILE::operator new(size_t size)
+{
+	return projectilePool.allocate(size);
+}
+
+void PROJECTILE::operator delete(void *projectile)
+{
+	projectilePool.free(projectile);
+}
+
 /* Forward function declarations */
 #ifdef DEBUG
 static void objListIntegCheck(void);
 #endif
+static void objCurrentIdIndexAdd(void const *list, BASE_OBJECT *psObj, int player);
+static void objCurrentIdIndexRemove(void const *list, BASE_OBJECT *psObj, int player);
 
 
 /* Initialise the object heaps */
@@ -223,6 +275,7 @@ static inline void addObjectToList(OBJECT *list[], OBJECT *object, int player)
 	// Prepend the object to the top of the list
 	object->psNext = list[player];
 	list[player] = object;
+	objCurrentIdIndexAdd(list, object, player);
 }
 
 /* Add the object to its list
@@ -248,6 +301,8 @@ static inline void destroyObject(OBJECT* list[], OBJECT* object)
 {
 	ASSERT(object != NULL, "Invalid pointer");
 
+	objCurrentIdIndexRemove(list, object, object->player);
+
 	// If the message to remove is the first one in the list then mark the next one as the first
 	if (list[object->player] == object)
 	{
@@ -294,6 +349,8 @@ static inline void removeObjectFromList(OBJECT *list[], OBJECT *object, int play
 {
 	ASSERT_OR_RETURN(, object != NULL, "Invalid pointer");
 
+	objCurrentIdIndexRemove(list, object, player);
+
 	// If the message to remove is the first one in the list then mark the next one as the first
 	if (list[player] == object)
 	{
@@ -488,6 +545,7 @@ void freeAllLimboDroids(void)
 void addStructure(STRUCTURE *psStructToAdd)
 {
 	addObjectToList(apsStructLists, psStructToAdd, psStructToAdd->player);
+	gridAddStaticObject(psStructToAdd);
 	if (psStructToAdd->pStructureType->pSensor
 	    && psStructToAdd->pStructureType->pSensor->location == LOC_TURRET)
 	{
@@ -556,6 +614,7 @@ void killStruct(STRUCTURE *psBuilding)
 		}
 	}
 
+	gridRemoveStaticObject(psBuilding);
 	destroyObject(apsStructLists, psBuilding);
 }
 
@@ -563,6 +622,7 @@ void killStruct(STRUCTURE *psBuilding)
 void freeAllStructs(void)
 {
 	releaseAllObjectsInList(apsStructLists);
+	gridStaticListsReplaced();
 }
 
 /*Remove a single Structure from a list*/
@@ -572,6 +632,10 @@ void removeStructureFromList(STRUCTURE *psStructToRemove, STRUCTURE *pList[MAX_P
 		"removeStructureFromList: pointer is not a structure" );
 	ASSERT( psStructToRemove->player < MAX_PLAYERS,
 		"removeStructureFromList: invalid player for structure" );
+	if (pList == apsStructLists)
+	{
+		gridRemoveStaticObject(psStructToRemove);
+	}
 	removeObjectFromList(pList, psStructToRemove, psStructToRemove->player);
 	if (psStructToRemove->pStructureType->pSensor
 	    && psStructToRemove->pStructureType->pSensor->location == LOC_TURRET)
@@ -590,6 +654,7 @@ void removeStructureFromList(STRUCTURE *psStructToRemove, STRUCTURE *pList[MAX_P
 void addFeature(FEATURE *psFeatureToAdd)
 {
 	addObjectToList(apsFeatureLists, psFeatureToAdd, 0);
+	gridAddStaticObject(psFeatureToAdd);
 	if (psFeatureToAdd->psStats->subType == FEAT_OIL_RESOURCE)
 	{
 		addObjectToFuncList(apsOilList, psFeatureToAdd, 0);
@@ -604,6 +669,7 @@ void killFeature(FEATURE *psDel)
 	ASSERT( psDel->type == OBJ_FEATURE,
 		"killFeature: pointer is not a feature" );
 	psDel->player = 0;
+	gridRemoveStaticObject(psDel);
 	destroyObject(apsFeatureLists, psDel);
 
 	if (psDel->psStats->subType == FEAT_OIL_RESOURCE)
@@ -616,6 +682,7 @@ void killFeature(FEATURE *psDel)
 void freeAllFeatures(void)
 {
 	releaseAllObjectsInList(apsFeatureLists);
+	gridStaticListsReplaced();
 }
 
 /**************************  FLAG_POSITION ********************************/
@@ -738,155 +805,169 @@ void checkFactoryFlags(void)
 
 /**************************  OBJECT ACCESS FUNCTIONALITY ********************************/
 
-// Find a base object from it's id
-BASE_OBJECT *getBaseObjFromData(unsigned id, unsigned player, OBJECT_TYPE type)
+// All objects which currently exist, by id. Objects are added when constructed and removed when deleted, so
+// moving objects between the current, mission and limbo lists or into transporters doesn't need to update this.
+static QMultiHash<uint32_t, BASE_OBJECT *> objIdIndex;
+
+// Droids and features in the current lists, by id, for IdToDroid and IdToFeature. addObjectToList, removeObjectFromList and destroyObject
+// keep this up to date, since all other changes to a list, such as mission.cpp moving whole lists between the current, mission and limbo
+// lists, replace the list head. The heads are compared against what they were after the last tracked change, and if any differs, this
+// is rebuilt from the lists on the next lookup.
+static QMultiHash<uint32_t, BASE_OBJECT *> objCurrentIdIndex;
+static BASE_OBJECT *objCurrentHeads[MAX_PLAYERS + 1];  // Droid list heads, then the feature list head.
+static bool objCurrentIdIndexValid = false;
+
+// Returns where the expected head of list is kept, or NULL if list isn't one of the current droid or feature lists.
+static BASE_OBJECT **objCurrentHead(void const *list, int player)
+{
+	if (list == apsDroidLists && player >= 0 && player < MAX_PLAYERS)
+	{
+		return &objCurrentHeads[player];
+	}
+	if (list == apsFeatureLists && player == 0)
+	{
+		return &objCurrentHeads[MAX_PLAYERS];
+	}
+	return NULL;
+}
+
+static BASE_OBJECT *objCurrentListHead(unsigned index)
 {
-	BASE_OBJECT		*psObj;
-	DROID			*psTrans;
+	return index < MAX_PLAYERS ? (BASE_OBJECT *)apsDroidLists[index] : (BASE_OBJECT *)apsFeatureLists[0];
+}
 
-	for (int i = 0; i < 3; ++i)
+// Call after psObj is added to the start of list.
+static void objCurrentIdIndexAdd(void const *list, BASE_OBJECT *psObj, int player)
+{
+	BASE_OBJECT **head = objCurrentHead(list, player);
+	if (head == NULL || !objCurrentIdIndexValid)
 	{
-		psObj = NULL;
-		switch (i)
+		return;
+	}
+	if (psObj->psNext != *head)
+	{
+		objCurrentIdIndexValid = false;  // The list was replaced behind our back.
+		return;
+	}
+	*head = psObj;
+	objCurrentIdIndex.insert(psObj->id, psObj);
+}
+
+// Call before psObj is removed from list.
+static void objCurrentIdIndexRemove(void const *list, BASE_OBJECT *psObj, int player)
+{
+	BASE_OBJECT **head = objCurrentHead(list, player);
+	if (head == NULL || !objCurrentIdIndexValid)
+	{
+		return;
+	}
+	BASE_OBJECT *listHead = objCurrentListHead(head - objCurrentHeads);
+	if (listHead != *head)
+	{
+		objCurrentIdIndexValid = false;  // The list was replaced behind our back.
+		return;
+	}
+	*head = listHead == psObj ? (BASE_OBJECT *)psObj->psNext : listHead;
+	objCurrentIdIndex.remove(psObj->id, psObj);
+}
+
+static void objCurrentIdIndexUpdate()
+{
+	for (unsigned index = 0; index < MAX_PLAYERS + 1 && objCurrentIdIndexValid; ++index)
+	{
+		objCurrentIdIndexValid = objCurrentHeads[index] == objCurrentListHead(index);
+	}
+	if (objCurrentIdIndexValid)
+	{
+		return;
+	}
+
+	objCurrentIdIndex.clear();
+	for (unsigned index = 0; index < MAX_PLAYERS + 1; ++index)
+	{
+		objCurrentHeads[index] = objCurrentListHead(index);
+		for (BASE_OBJECT *psObj = objCurrentHeads[index]; psObj != NULL; psObj = psObj->psNext)
 		{
-		case 0:
-			switch (type)
-			{
-			case OBJ_DROID: psObj = apsDroidLists[player]; break;
-			case OBJ_STRUCTURE: psObj = apsStructLists[player]; break;
-			case OBJ_FEATURE: psObj= apsFeatureLists[0];
-			default: break;
-			}
-			break;
-		case 1:
-			switch (type)
-			{
-			case OBJ_DROID: psObj = mission.apsDroidLists[player]; break;
-			case OBJ_STRUCTURE: psObj = mission.apsStructLists[player]; break;
-			case OBJ_FEATURE: psObj = mission.apsFeatureLists[0]; break;
-			default: break;
-			}
-			break;
-		case 2:
-			if (player == 0 && type == OBJ_DROID)
-			{
-				psObj = apsLimboDroids[0];
-			}
-			break;
+			objCurrentIdIndex.insert(psObj->id, psObj);
 		}
+	}
+	objCurrentIdIndexValid = true;
+}
 
-		while (psObj)
+void objIdIndexInsert(BASE_OBJECT *psObj)
+{
+	objIdIndex.insert(psObj->id, psObj);
+}
+
+void objIdIndexRemove(BASE_OBJECT *psObj)
+{
+	objIdIndex.remove(psObj->id, psObj);
+	objCurrentIdIndex.remove(psObj->id, psObj);  // In case it is deleted while still in a list, such as by releaseAllObjectsInList.
+}
+
+void setObjectId(BASE_OBJECT *psObj, uint32_t id)
+{
+	int inCurrentList = objCurrentIdIndex.remove(psObj->id, psObj);
+	objIdIndex.remove(psObj->id, psObj);
+	psObj->id = id;
+	objIdIndex.insert(psObj->id, psObj);
+	if (inCurrentList)
+	{
+		objCurrentIdIndex.insert(psObj->id, psObj);
+	}
+}
+
+BASE_OBJECT *findObjectById(uint32_t id, OBJECT_TYPE type)
+{
+	for (QMultiHash<uint32_t, BASE_OBJECT *>::const_iterator i = objIdIndex.constFind(id); i != objIdIndex.constEnd() && i.key() == id; ++i)
+	{
+		BASE_OBJECT *psObj = i.value();
+		if (!isDead(psObj) && (type == OBJ_NUM_TYPES || psObj->type == type))
 		{
-			if (psObj->id == id)
-			{
-				return psObj;
-			}
-			// if transporter check any droids in the grp
-			if ((psObj->type == OBJ_DROID) && ((((DROID*)psObj)->droidType == DROID_TRANSPORTER || ((DROID*)psObj)->droidType == DROID_SUPERTRANSPORTER)))
-			{
-				for(psTrans = ((DROID*)psObj)->psGroup->psList; psTrans != NULL; psTrans = psTrans->psGrpNext)
-				{
-					if (psTrans->id == id)
-					{
-						return (BASE_OBJECT*)psTrans;
-					}
-				}
-			}
-			psObj = psObj->psNext;
+			return psObj;
 		}
 	}
-	ASSERT(false, "failed to find id %d for player %d", id, player);
+	return NULL;
+}
 
+BASE_OBJECT *findCurrentObjectById(uint32_t id, OBJECT_TYPE type)
+{
+	objCurrentIdIndexUpdate();
+	for (QMultiHash<uint32_t, BASE_OBJECT *>::const_iterator i = objCurrentIdIndex.constFind(id); i != objCurrentIdIndex.constEnd() && i.key() == id; ++i)
+	{
+		if (i.value()->type == type)
+		{
+			return i.value();
+		}
+	}
 	return NULL;
 }
 
 // Find a base object from it's id
-BASE_OBJECT *getBaseObjFromId(UDWORD id)
+BASE_OBJECT *getBaseObjFromData(unsigned id, unsigned player, OBJECT_TYPE type)
 {
-	unsigned int i;
-	UDWORD			player;
-	BASE_OBJECT		*psObj;
-	DROID			*psTrans;
+	BASE_OBJECT *psObj = findObjectById(id, type);
 
-	for(i = 0; i < 7; ++i)
+	// Features are all owned by the feature player, but were looked up as player 0.
+	if (psObj != NULL && (type == OBJ_FEATURE || psObj->player == player))
 	{
-		for(player = 0; player < MAX_PLAYERS; ++player)
-		{
-			switch (i)
-			{
-				case 0:
-					psObj=(BASE_OBJECT *)apsDroidLists[player];
-					break;
-				case 1:
-					psObj=(BASE_OBJECT *)apsStructLists[player];
-					break;
-				case 2:
-					if (player == 0)
-					{
-						psObj=(BASE_OBJECT *)apsFeatureLists[0];
-					}
-					else
-					{
-						psObj = NULL;
-					}
-					break;
-				case 3:
-					psObj=(BASE_OBJECT *)mission.apsDroidLists[player];
-					break;
-				case 4:
-					psObj=(BASE_OBJECT *)mission.apsStructLists[player];
-					break;
-				case 5:
-					if (player == 0)
-					{
-						psObj=(BASE_OBJECT *)mission.apsFeatureLists[0];
-					}
-					else
-					{
-						psObj = NULL;
-					}
-					break;
-				case 6:
-					if (player == 0)
-					{
-						psObj=(BASE_OBJECT *)apsLimboDroids[0];
-					}
-					else
-					{
-						psObj = NULL;
-					}
-					break;
-				default:
-					psObj = NULL;
-					break;
-			}
-
-			while (psObj)
-			{
-				if (psObj->id == id)
-				{
-					return psObj;
-				}
-				// if transporter check any droids in the grp
-				if ((psObj->type == OBJ_DROID) && ((((DROID*)psObj)->droidType == DROID_TRANSPORTER || ((DROID*)psObj)->droidType == DROID_SUPERTRANSPORTER)))
-				{
-					for(psTrans = ((DROID*)psObj)->psGroup->psList; psTrans != NULL; psTrans = psTrans->psGrpNext)
-					{
-						if (psTrans->id == id)
-						{
-							return (BASE_OBJECT*)psTrans;
-						}
-					}
-				}
-				psObj = psObj->psNext;
-			}
-		}
+		return psObj;
 	}
-	ASSERT(!"couldn't find a BASE_OBJ with ID", "getBaseObjFromId() failed for id %d", id);
+	ASSERT(false, "failed to find id %d for player %d", id, player);
 
 	return NULL;
 }
 
+// Find a base object from it's id
+BASE_OBJECT *getBaseObjFromId(UDWORD id)
+{
+	BASE_OBJECT *psObj = findObjectById(id);
+
+	ASSERT(psObj != NULL, "getBaseObjFromId() failed for id %d", id);
+
+	return psObj;
+}
+
 UDWORD getRepairIdFromFlag(FLAG_POSITION *psFlag)
 {
 	unsigned int i;
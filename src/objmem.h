@@ -102,6 +102,21 @@ extern void removeFlagPosition(FLAG_POSITION *psDel);
 extern void freeAllFlagPositions(void);
 extern void freeAllAssemblyPoints(void);
 
+/// Keep the index used by findObjectById up to date. Called when constructing and deleting objects.
+void objIdIndexInsert(BASE_OBJECT *psObj);
+void objIdIndexRemove(BASE_OBJECT *psObj);
+
+/// Changes the id of an existing object, such as when loading a savegame. Don't assign psObj->id directly, or the object can't be found.
+void setObjectId(BASE_OBJECT *psObj, uint32_t id);
+
+/// Find an object which isn't dead from its id, in constant time. Also finds objects in the mission and limbo lists and in transporters.
+/// If type isn't OBJ_NUM_TYPES, only finds objects of that type. Returns NULL if there is no such object.
+BASE_OBJECT *findObjectById(uint32_t id, OBJECT_TYPE type = OBJ_NUM_TYPES);
+
+/// Find a droid in apsDroidLists or a feature in apsFeatureLists[0] from its id, without searching the lists. Type must be OBJ_DROID or OBJ_FEATURE.
+/// Returns NULL if there is no such object in those lists.
+BASE_OBJECT *findCurrentObjectById(uint32_t id, OBJECT_TYPE type);
+
 // Find a base object from it's id
 extern BASE_OBJECT *getBaseObjFromData(unsigned id, unsigned player, OBJECT_TYPE type);
 extern BASE_OBJECT *getBaseObjFromId(UDWORD id);
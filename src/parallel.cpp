@@ -0,0 +1,186 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 1999-2004  Eidos Interactive
+	Copyright (C) 2005-2013  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/**
+ * @file parallel.cpp
+ * A pool of worker threads, for splitting up work on the game state which doesn't depend on the order it is done in.
+ */
+
+#include "lib/framework/frame.h"
+#include "lib/framework/math_ext.h"
+#include "lib/framework/wzapp.h"
+
+#include "parallel.h"
+#include "warzoneconfig.h"
+
+#include <QtCore/QThread>
+
+static std::vector<WZ_THREAD *> parallelWorkers;
+static WZ_MUTEX         *parallelMutex = NULL;
+static WZ_SEMAPHORE     *parallelSemaphore = NULL;      // Posted to wake up workers.
+static WZ_SEMAPHORE     *parallelDoneSemaphore = NULL;  // Posted when the last chunk is done, if the main thread is waiting.
+static bool             parallelQuit = false;
+
+// The current parallelFor. Protected by parallelMutex.
+static ParallelFunc     parallelJobFunc = NULL;
+static void             *parallelJobData = NULL;
+static unsigned         parallelJobCount = 0;
+static unsigned         parallelJobChunkSize = 1;
+static unsigned         parallelJobNext = 0;             // Next item to hand out.
+static unsigned         parallelJobRunning = 0;          // Number of chunks being worked on.
+static bool             parallelWaiting = false;         // Main thread is waiting on parallelDoneSemaphore.
+
+/** Does chunks of the current job until there are none left. Must be called with parallelMutex locked. */
+static void parallelWork(unsigned thread)
+{
+	while (parallelJobNext < parallelJobCount)
+	{
+		unsigned begin = parallelJobNext;
+		unsigned end = std::min(begin + parallelJobChunkSize, parallelJobCount);
+		parallelJobNext = end;
+		++parallelJobRunning;
+
+		wzMutexUnlock(parallelMutex);
+		parallelJobFunc(parallelJobData, begin, end, thread);
+		wzMutexLock(parallelMutex);
+
+		--parallelJobRunning;
+	}
+	if (parallelJobRunning == 0 && parallelWaiting)
+	{
+		parallelWaiting = false;
+		wzSemaphorePost(parallelDoneSemaphore);
+	}
+}
+
+/** This runs in separate threads, one per worker. */
+static int parallelThreadFunc(void *data)
+{
+	unsigned thread = (unsigned)(uintptr_t)data;
+
+	wzMutexLock(parallelMutex);
+	while (!parallelQuit)
+	{
+		parallelWork(thread);
+
+		wzMutexUnlock(parallelMutex);
+		wzSemaphoreWait(parallelSemaphore);  // Go to sleep until needed.
+		wzMutexLock(parallelMutex);
+	}
+	wzMutexUnlock(parallelMutex);
+	return 0;
+}
+
+bool parallelInitialise(void)
+{
+	ASSERT(parallelWorkers.empty(), "parallelInitialise already called, without calling parallelShutdown.");
+
+	// Results must not depend on the number of threads, so this can differ between players.
+	int numThreads = war_getWorkerThreads();
+	if (numThreads <= 0)
+	{
+		numThreads = QThread::idealThreadCount();
+	}
+	numThreads = clip(numThreads, 1, PARALLEL_MAX_THREADS);
+	debug(LOG_INFO, "Using %d threads for game state updates.", numThreads);
+
+	parallelQuit = false;
+	parallelMutex = wzMutexCreate();
+	parallelSemaphore = wzSemaphoreCreate(0);
+	parallelDoneSemaphore = wzSemaphoreCreate(0);
+	for (int i = 1; i < numThreads; ++i)  // Thread 0 is the main thread.
+	{
+		parallelWorkers.push_back(wzThreadCreate(parallelThreadFunc, (void *)(uintptr_t)i));
+		wzThreadStart(parallelWorkers.back());
+	}
+
+	return true;
+}
+
+void parallelShutdown(void)
+{
+	if (parallelMutex == NULL)
+	{
+		return;
+	}
+
+	wzMutexLock(parallelMutex);
+	parallelQuit = true;
+	wzMutexUnlock(parallelMutex);
+	for (unsigned i = 0; i < parallelWorkers.size(); ++i)
+	{
+		wzSemaphorePost(parallelSemaphore);  // Wake up threads.
+	}
+	for (unsigned i = 0; i < parallelWorkers.size(); ++i)
+	{
+		wzThreadJoin(parallelWorkers[i]);
+	}
+	parallelWorkers.clear();
+	wzMutexDestroy(parallelMutex);
+	parallelMutex = NULL;
+	wzSemaphoreDestroy(parallelSemaphore);
+	parallelSemaphore = NULL;
+	wzSemaphoreDestroy(parallelDoneSemaphore);
+	parallelDoneSemaphore = NULL;
+}
+
+unsigned parallelThreads(void)
+{
+	return parallelWorkers.size() + 1;
+}
+
+void parallelFor(unsigned count, unsigned chunkSize, ParallelFunc func, void *data)
+{
+	chunkSize = std::max(chunkSize, 1u);
+
+	if (parallelWorkers.empty() || count <= chunkSize)
+	{
+		// Not worth waking anyone up.
+		for (unsigned begin = 0; begin < count; begin += chunkSize)
+		{
+			func(data, begin, std::min(begin + chunkSize, count), 0);
+		}
+		return;
+	}
+
+	wzMutexLock(parallelMutex);
+	ASSERT(parallelJobNext >= parallelJobCount && parallelJobRunning == 0, "parallelFor is not reentrant.");
+	parallelJobFunc = func;
+	parallelJobData = data;
+	parallelJobCount = count;
+	parallelJobChunkSize = chunkSize;
+	parallelJobNext = 0;
+	unsigned wake = std::min<unsigned>(parallelWorkers.size(), (count + chunkSize - 1)/chunkSize - 1);
+	for (unsigned i = 0; i < wake; ++i)
+	{
+		wzSemaphorePost(parallelSemaphore);  // Wake up threads.
+	}
+
+	parallelWork(0);
+	if (parallelJobRunning != 0)
+	{
+		parallelWaiting = true;
+		wzMutexUnlock(parallelMutex);
+		wzSemaphoreWait(parallelDoneSemaphore);  // Wait for the workers to finish their last chunks.
+		wzMutexLock(parallelMutex);
+	}
+	parallelJobFunc = NULL;
+	parallelJobData = NULL;
+	wzMutexUnlock(parallelMutex);
+}
@@ -0,0 +1,46 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 1999-2004  Eidos Interactive
+	Copyright (C) 2005-2013  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Splits work on the game state between a pool of worker threads.
+ */
+
+#ifndef __INCLUDED_SRC_PARALLEL_H__
+#define __INCLUDED_SRC_PARALLEL_H__
+
+#define PARALLEL_MAX_THREADS 16  ///< Maximum number of threads working on a parallelFor, including the calling thread.
+
+/// Work function for parallelFor. Handles items [begin, end). thread is in [0, parallelThreads()), and no two calls
+/// with the same thread run at the same time, so it can be used to index per-thread scratch space.
+typedef void (*ParallelFunc)(void *data, unsigned begin, unsigned end, unsigned thread);
+
+/// Starts the worker threads. Calling parallelFor without starting the threads runs everything in the calling thread.
+bool parallelInitialise(void);
+/// Stops the worker threads.
+void parallelShutdown(void);
+
+/// Number of threads which may work on a parallelFor, including the calling thread.
+unsigned parallelThreads(void);
+
+/// Calls func on chunks of [0, count) from the worker threads and the calling thread, and returns once all items are done.
+/// The chunks may be done in any order, so func must not depend on the order, if the results are to be synchronised.
+/// Not reentrant, must only be called from the main thread.
+void parallelFor(unsigned count, unsigned chunkSize, ParallelFunc func, void *data);
+
+#endif // __INCLUDED_SRC_PARALLEL_H__
@@ -50,6 +50,18 @@ static uint64_t expand(uint32_t x)
 	return r;
 }
 
+// Inverse of expand, compacts bit pattern ?a?b ?c?d ?e?f ?g?h to abcd efgh.
+static uint32_t compact(uint64_t r)
+{
+	r &= 0x5555555555555555ULL;
+	r = (r | r>>1)  & 0x3333333333333333ULL;
+	r = (r | r>>2)  & 0x0F0F0F0F0F0F0F0FULL;
+	r = (r | r>>4)  & 0x00FF00FF00FF00FFULL;
+	r = (r | r>>8)  & 0x0000FFFF0000FFFFULL;
+	r = (r | r>>16) & 0x00000000FFFFFFFFULL;
+	return r;
+}
+
 // Returns v with highest set bit and all higher bits set, and all following bits 0. Example: 0000 0110 1001 1100 -> 1111 1100 0000 0000.
 static uint32_t findSplit(uint32_t v)
 {
@@ -82,9 +94,31 @@ void PointTree::insert(void *pointData, int32_t x, int32_t y)
 	points.push_back(Point(interleave(x, y), pointData));
 }
 
+struct PointTreeEraseFunction
+{
+	PointTreeEraseFunction(std::vector<void *> const &pointData_) : pointData(pointData_) {}
+	bool operator ()(std::pair<uint64_t, void *> const &point) const
+	{
+		return std::binary_search(pointData.begin(), pointData.end(), point.second);
+	}
+	std::vector<void *> const &pointData;
+};
+
+void PointTree::erase(std::vector<void *> const &pointData)
+{
+	// remove_if is stable, so the remaining points stay sorted.
+	Vector::iterator sortedEnd = std::remove_if(points.begin(), points.begin() + sortedSize, PointTreeEraseFunction(pointData));
+	Vector::iterator end = std::remove_if(points.begin() + sortedSize, points.end(), PointTreeEraseFunction(pointData));
+	size_t newSortedSize = sortedEnd - points.begin();
+	end = std::copy(points.begin() + sortedSize, end, sortedEnd);
+	points.erase(end, points.end());
+	sortedSize = newSortedSize;
+}
+
 void PointTree::clear()
 {
 	points.clear();
+	sortedSize = 0;
 }
 
 static bool pointTreeSortFunction(std::pair<uint64_t, void *> const &a, std::pair<uint64_t, void *> const &b)
@@ -92,9 +126,33 @@ static bool pointTreeSortFunction(std::pair<uint64_t, void *> const &a, std::pai
 	return a.first < b.first;  // Sort only by position, not by pointer address, even if two units are in the same place.
 }
 
-void PointTree::sort()
+struct PointTreeSortFunction
+{
+	PointTreeSortFunction(PointTree::TieBreak tieBreak_) : tieBreak(tieBreak_) {}
+	bool operator ()(std::pair<uint64_t, void *> const &a, std::pair<uint64_t, void *> const &b) const
+	{
+		if (a.first != b.first)
+		{
+			return a.first < b.first;
+		}
+		return tieBreak != NULL && tieBreak(a.second, b.second);
+	}
+	PointTree::TieBreak tieBreak;
+};
+
+void PointTree::sort(TieBreak tieBreak)
 {
-	std::stable_sort(points.begin(), points.end(), pointTreeSortFunction);  // Stable sort to avoid unspecified behaviour when two objects are in exactly the same place.
+	// Points inserted since the last sort are sorted on their own, then merged, so that adding a few points to a large tree is cheap.
+	PointTreeSortFunction sortFunction(tieBreak);
+	std::stable_sort(points.begin() + sortedSize, points.end(), sortFunction);  // Stable sort to avoid unspecified behaviour when two objects are in exactly the same place.
+	if (sortedSize != 0 && sortedSize != points.size())
+	{
+		// Also stable, with the new points first, so they go before old points in the same place.
+		size_t newSize = points.size() - sortedSize;
+		std::rotate(points.begin(), points.begin() + sortedSize, points.end());
+		std::inplace_merge(points.begin(), points.begin() + newSize, points.end(), sortFunction);
+	}
+	sortedSize = points.size();
 }
 
 //#define DUMP_IMAGE  // All x and y coordinates must be in range -500 to 499, if dumping an image.
@@ -128,8 +186,8 @@ static unsigned current(std::vector<unsigned> &filterData, unsigned i)
 	return ret;
 }
 
-template<bool IsFiltered>
-PointTree::ResultVector &PointTree::queryMaybeFilter(Filter &filter, int32_t minXo, int32_t minYo, int32_t maxXo, int32_t maxYo)
+template<bool IsFiltered, bool WantIndices>
+void PointTree::queryMaybeFilter(ResultVector &results, IndexVector &filteredIndices, Filter &filter, int32_t minXo, int32_t minYo, int32_t maxXo, int32_t maxYo) const
 {
 	uint64_t minX = expandX(minXo);
 	uint64_t maxX = expandX(maxXo);
@@ -225,10 +283,10 @@ PointTree::ResultVector &PointTree::queryMaybeFilter(Filter &filter, int32_t min
 		--numRanges;
 	}
 
-	lastQueryResults.clear();
-	if (IsFiltered)
+	results.clear();
+	if (WantIndices)
 	{
-		lastFilteredQueryIndices.clear();
+		filteredIndices.clear();
 	}
 	for (int r = 0; r != numRanges; ++r)
 	{
@@ -242,10 +300,10 @@ PointTree::ResultVector &PointTree::queryMaybeFilter(Filter &filter, int32_t min
 			uint64_t py = points[i].first & 0x5555555555555555ULL;
 			if (px >= minX && px <= maxX && py >= minY && py <= maxY)  // Only add point if it's at least in the desired square.
 			{
-				lastQueryResults.push_back(points[i].second);
-				if (IsFiltered)
+				results.push_back(points[i].second);
+				if (WantIndices)
 				{
-					lastFilteredQueryIndices.push_back(i);
+					filteredIndices.push_back(i);
 				}
 #ifdef DUMP_IMAGE
 				if (doDump)
@@ -266,31 +324,82 @@ PointTree::ResultVector &PointTree::queryMaybeFilter(Filter &filter, int32_t min
 		fclose(f);
 	}
 #endif //DUMP_IMAGE
+}
 
+PointTree::ResultVector &PointTree::query(int32_t x, int32_t y, uint32_t x2, uint32_t y2)
+{
+	query(lastQueryResults, x, y, x2, y2);
 	return lastQueryResults;
 }
 
-PointTree::ResultVector &PointTree::query(int32_t x, int32_t y, uint32_t x2, uint32_t y2)
+PointTree::ResultVector &PointTree::query(int32_t x, int32_t y, uint32_t radius)
+{
+	query(lastQueryResults, x, y, radius);
+	return lastQueryResults;
+}
+
+PointTree::ResultVector &PointTree::query(Filter &filter, int32_t x, int32_t y, uint32_t radius)
+{
+	query(lastQueryResults, lastFilteredQueryIndices, filter, x, y, radius);
+	return lastQueryResults;
+}
+
+void PointTree::query(ResultVector &results, int32_t x, int32_t y, uint32_t x2, uint32_t y2) const
 {
 	Filter unused;
-	return queryMaybeFilter<false>(unused, x, y, x2, y2);
+	IndexVector unusedIndices;
+	queryMaybeFilter<false, false>(results, unusedIndices, unused, x, y, x2, y2);
 }
 
-PointTree::ResultVector &PointTree::query(int32_t x, int32_t y, uint32_t radius)
+void PointTree::query(ResultVector &results, IndexVector &indices, int32_t x, int32_t y, int32_t x2, int32_t y2) const
+{
+	Filter unused;
+	queryMaybeFilter<false, true>(results, indices, unused, x, y, x2, y2);
+}
+
+void PointTree::query(ResultVector &results, IndexVector &indices, int32_t x, int32_t y, uint32_t radius) const
 {
 	Filter unused;
 	int32_t minXo = x - radius;
 	int32_t maxXo = x + radius;
 	int32_t minYo = y - radius;
 	int32_t maxYo = y + radius;
-	return queryMaybeFilter<false>(unused, minXo, minYo, maxXo, maxYo);
+	queryMaybeFilter<false, true>(results, indices, unused, minXo, minYo, maxXo, maxYo);
 }
 
-PointTree::ResultVector &PointTree::query(Filter &filter, int32_t x, int32_t y, uint32_t radius)
+void PointTree::query(ResultVector &results, std::vector<Vector2i> &positions, IndexVector &indices, int32_t x, int32_t y, int32_t x2, int32_t y2) const
+{
+	Filter unused;
+	queryMaybeFilter<false, true>(results, indices, unused, x, y, x2, y2);
+	positions.resize(indices.size());
+	for (unsigned n = 0; n < indices.size(); ++n)
+	{
+		positions[n] = position(indices[n]);
+	}
+}
+
+Vector2i PointTree::position(unsigned index) const
+{
+	uint64_t key = points[index].first;
+	return Vector2i(compact(key>>1) - 0x80000000u, compact(key) - 0x80000000u);
+}
+
+void PointTree::query(ResultVector &results, int32_t x, int32_t y, uint32_t radius) const
+{
+	Filter unused;
+	IndexVector unusedIndices;
+	int32_t minXo = x - radius;
+	int32_t maxXo = x + radius;
+	int32_t minYo = y - radius;
+	int32_t maxYo = y + radius;
+	queryMaybeFilter<false, false>(results, unusedIndices, unused, minXo, minYo, maxXo, maxYo);
+}
+
+void PointTree::query(ResultVector &results, IndexVector &filteredIndices, Filter &filter, int32_t x, int32_t y, uint32_t radius) const
 {
 	int32_t minXo = x - radius;
 	int32_t maxXo = x + radius;
 	int32_t minYo = y - radius;
 	int32_t maxYo = y + radius;
-	return queryMaybeFilter<true>(filter, minXo, minYo, maxXo, maxYo);
+	queryMaybeFilter<true, true>(results, filteredIndices, filter, minXo, minYo, maxXo, maxYo);
 }
@@ -21,6 +21,7 @@
 #define _point_tree_h
 
 #include "lib/framework/types.h"
+#include "lib/framework/vector.h"
 
 #include <vector>
 
@@ -45,9 +46,16 @@ public:
 		Data data;
 	};
 
+	PointTree() : sortedSize(0) {}
+
 	void insert(void *pointData, int32_t x, int32_t y);                       ///< Inserts a point into the point tree.
+	void erase(std::vector<void *> const &pointData);                         ///< Erases all points whose data is in pointData, which must be sorted. Keeps the PointTree sorted.
 	void clear();                                                             ///< Clears the PointTree.
-	void sort();                                                              ///< Must be done between inserting and querying, to get meaningful results.
+	/// Must be done between inserting and querying, to get meaningful results. Only sorts points inserted since the last sort.
+	/// Points in the same place are ordered by tieBreak if given, then points inserted since the last sort go before older points,
+	/// and otherwise the insertion order is kept.
+	typedef bool (*TieBreak)(void const *a, void const *b);
+	void sort(TieBreak tieBreak = NULL);
 	/// Returns all points less than or equal to radius from (x, y), possibly plus some extra nearby points.
 	/// (More specifically, returns all objects in a square with edge length 2*radius.)
 	/// Note: Not thread safe, because it modifies lastQueryResults.
@@ -59,6 +67,23 @@ public:
 	/// Returns all points which have not been filtered away within given rectangle. See function above on thread safety.
 	ResultVector &query(int32_t x, int32_t y, uint32_t x2, uint32_t y2);
 
+	/// Reentrant versions of the above, which write to results and filteredIndices instead of lastQueryResults and lastFilteredQueryIndices.
+	/// Safe to call from several threads at once, as long as the PointTree isn't modified meanwhile, and no two threads use the same filter.
+	void query(ResultVector &results, int32_t x, int32_t y, uint32_t radius) const;
+	void query(ResultVector &results, IndexVector &filteredIndices, Filter &filter, int32_t x, int32_t y, uint32_t radius) const;
+	void query(ResultVector &results, int32_t x, int32_t y, uint32_t x2, uint32_t y2) const;
+	/// Like the unfiltered versions above, but also return the index of each point, for sortKey.
+	void query(ResultVector &results, IndexVector &indices, int32_t x, int32_t y, uint32_t radius) const;
+	void query(ResultVector &results, IndexVector &indices, int32_t x, int32_t y, int32_t x2, int32_t y2) const;
+	/// Points are stored and returned sorted by this key, so query results from several PointTrees can be merged into the order a single PointTree would have given.
+	uint64_t sortKey(unsigned index) const { return points[index].first; }
+	/// Number of points. Once sorted, indices from 0 to size() - 1 give all points, in the order queries return them.
+	unsigned size() const { return points.size(); }
+	void *data(unsigned index) const { return points[index].second; }
+	Vector2i position(unsigned index) const;  ///< Where the point was inserted.
+	/// Returns all points within given rectangle, and the positions they were inserted at. Uses indices as scratch space. See function above on thread safety.
+	void query(ResultVector &results, std::vector<Vector2i> &positions, IndexVector &indices, int32_t x, int32_t y, int32_t x2, int32_t y2) const;
+
 	ResultVector lastQueryResults;
 	IndexVector lastFilteredQueryIndices;
 
@@ -66,10 +91,11 @@ private:
 	typedef std::pair<uint64_t, void *> Point;
 	typedef std::vector<Point> Vector;
 
-	template<bool IsFiltered>
-	ResultVector &queryMaybeFilter(Filter &filter, int32_t minXo, int32_t maxXo, int32_t minYo, int32_t maxYo);
+	template<bool IsFiltered, bool WantIndices>
+	void queryMaybeFilter(ResultVector &results, IndexVector &filteredIndices, Filter &filter, int32_t minXo, int32_t maxXo, int32_t minYo, int32_t maxYo) const;
 
 	Vector points;
+	size_t sortedSize;  ///< Number of points at the start of points which are already sorted.
 };
 
 #endif //_point_tree_h
@@ -68,6 +68,10 @@
 #define HOMINGINDIRECT_HEIGHT_MIN 200
 #define HOMINGINDIRECT_HEIGHT_MAX 450
 
+/* we want a delay between Las-Sats firing and actually hitting in multiPlayer
+magic number but that's how long the audio countdown message lasts! */
+#define LAS_SAT_DELAY 4
+
 static int experienceGain[MAX_PLAYERS];
 
 struct INTERVAL
@@ -87,6 +91,41 @@ static std::vector<PROJECTILE *> psProjectileList;
 /* The next projectile to give out in the proj_First / proj_Next methods */
 static ProjectileIterator psProjectileNext;
 
+/* Objects which projectiles in flight might hit are bucketed by where they were put in the grid, in squares of this size */
+#define PROJ_TARGET_BUCKET_SIZE (TILE_UNITS*2)
+
+/// An object in the grid which projectiles in flight might hit.
+struct ProjectileTarget
+{
+	BASE_OBJECT *psObj;
+	Vector2i gridPos;  ///< Where the object was put in the grid, droids have moved since.
+	unsigned order;    ///< Index in gridAllObjects, to give the same order as gridStartIterate.
+};
+
+/// Where a projectile moves to this tick, and what it could hit there. All projectiles in flight are moved, and what they could hit is
+/// found, before any of them hits anything, see proj_UpdateAll. So this is kept together for all of them, in the order of psProjectileList.
+struct ProjectileFlight
+{
+	WEAPON_STATS    *psStats;
+	BASE_OBJECT     *psDest;          ///< Target it was moved towards, or NULL. Homing projectiles need moving again if it is destroyed first.
+	Spacetime       prevSpacetime;    ///< Where it was at the start of the tick.
+	Vector3i        pos;              ///< Where it moved to.
+	Rotation        rot;
+	Vector3i        dst;              ///< Homing projectiles change their destination as they move.
+	uint32_t        time;
+	int32_t         currentDistance;
+	bool            moved;            ///< False unless in flight, and allowed to move.
+	bool            targetsFound;     ///< Whether what it could hit at pos is in projectileCandidates.
+	unsigned        targetsBegin, targetsEnd;
+};
+
+static std::vector<ProjectileFlight> projectileFlights;
+static std::vector<ProjectileTarget> projectileTargets;      ///< Everything in the grid, with the targets in each bucket contiguous.
+static std::vector<unsigned> projectileTargetBucketStart;    ///< Index of the first target in each bucket, with one extra entry for the end of the last bucket.
+static int projectileTargetBucketsX, projectileTargetBucketsY;
+static bool projectileTargetsValid = false;                  ///< Targets are only bucketed in ticks where a projectile is in flight.
+static std::vector<ProjectileTarget> projectileCandidates;   ///< What each projectile in flight could hit, see ProjectileFlight.
+
 /***************************************************************************/
 
 // the last unit that did damage - used by script functions
@@ -236,6 +275,13 @@ proj_GetNext( void )
 
 /***************************************************************************/
 
+unsigned proj_Count(void)
+{
+	return psProjectileList.size();
+}
+
+/***************************************************************************/
+
 /*
  * Relates the quality of the attacker to the quality of the victim.
  * The value returned satisfies the following inequality: 0.5 <= ret/65536 <= 2.0
@@ -672,32 +718,19 @@ static int32_t collisionXYZ(Vector3i v1, Vector3i v2, ObjectShape shape, int32_t
 	return -1;
 }
 
-static void proj_InFlightFunc(PROJECTILE *psProj)
+// Works out where psProj moves to this tick, if flying towards psDest, without changing psProj.
+static void proj_Move(PROJECTILE const *psProj, BASE_OBJECT *psDest, ProjectileFlight &flight)
 {
-	/* we want a delay between Las-Sats firing and actually hitting in multiPlayer
-	magic number but that's how long the audio countdown message lasts! */
-	const unsigned int LAS_SAT_DELAY = 4;
-	BASE_OBJECT *closestCollisionObject = NULL;
-	Spacetime closestCollisionSpacetime;
-	memset(&closestCollisionSpacetime, 0, sizeof(Spacetime));  // Squelch uninitialised warning.
-
-	CHECK_PROJECTILE(psProj);
-
+	WEAPON_STATS *psStats = flight.psStats;
 	int timeSoFar = gameTime - psProj->born;
 
-	psProj->time = gameTime;
-	int deltaProjectileTime = psProj->time - psProj->prevSpacetime.time;
-
-	WEAPON_STATS *psStats = psProj->psWStats;
-	ASSERT_OR_RETURN( , psStats != NULL, "Invalid weapon stats pointer");
-
-	/* we want a delay between Las-Sats firing and actually hitting in multiPlayer
-	magic number but that's how long the audio countdown message lasts! */
-	if (bMultiPlayer && psStats->weaponSubClass == WSC_LAS_SAT &&
-	    (unsigned)timeSoFar < LAS_SAT_DELAY * GAME_TICKS_PER_SEC)
-	{
-		return;
-	}
+	flight.psDest = psDest;
+	flight.pos = flight.prevSpacetime.pos;
+	flight.rot = flight.prevSpacetime.rot;
+	flight.dst = psProj->dst;
+	flight.time = gameTime;
+	flight.targetsFound = false;
+	int deltaProjectileTime = flight.time - flight.prevSpacetime.time;
 
 	/* Calculate movement vector: */
 	int32_t currentDistance = 0;
@@ -705,7 +738,7 @@ static void proj_InFlightFunc(PROJECTILE *psProj)
 	{
 		case MM_DIRECT:           // Go in a straight line.
 		{
-			Vector3i delta = psProj->dst - psProj->src;
+			Vector3i delta = flight.dst - psProj->src;
 			if (psStats->weaponSubClass == WSC_LAS_SAT)
 			{
 				// LASSAT doesn't have a z
@@ -713,93 +746,257 @@ static void proj_InFlightFunc(PROJECTILE *psProj)
 			}
 			int targetDistance = std::max(iHypot(removeZ(delta)), 1);
 			currentDistance = timeSoFar * psStats->flightSpeed / GAME_TICKS_PER_SEC;
-			psProj->pos = psProj->src + delta * currentDistance/targetDistance;
+			flight.pos = psProj->src + delta * currentDistance/targetDistance;
 			break;
 		}
 		case MM_INDIRECT:         // Ballistic trajectory.
 		{
-			Vector3i delta = psProj->dst - psProj->src;
+			Vector3i delta = flight.dst - psProj->src;
 			delta.z = (psProj->vZ - (timeSoFar * ACC_GRAVITY / (GAME_TICKS_PER_SEC * 2))) * timeSoFar / GAME_TICKS_PER_SEC; // '2' because we reach our highest point in the mid of flight, when "vZ is 0".
 			int targetDistance = std::max(iHypot(removeZ(delta)), 1);
 			currentDistance = timeSoFar * psProj->vXY / GAME_TICKS_PER_SEC;
-			psProj->pos = psProj->src + delta * currentDistance/targetDistance;
-			psProj->pos.z = psProj->src.z + delta.z;  // Use raw z value.
-			psProj->rot.pitch = iAtan2(psProj->vZ - (timeSoFar * ACC_GRAVITY / GAME_TICKS_PER_SEC), psProj->vXY);
+			flight.pos = psProj->src + delta * currentDistance/targetDistance;
+			flight.pos.z = psProj->src.z + delta.z;  // Use raw z value.
+			flight.rot.pitch = iAtan2(psProj->vZ - (timeSoFar * ACC_GRAVITY / GAME_TICKS_PER_SEC), psProj->vXY);
 			break;
 		}
 		case MM_HOMINGDIRECT:     // Fly towards target, even if target moves.
 		case MM_HOMINGINDIRECT:   // Fly towards target, even if target moves. Avoid terrain.
 		{
-			if (psProj->psDest != NULL)
+			if (psDest != NULL)
 			{
 				if (psStats->movementModel == MM_HOMINGDIRECT)
 				{
 					// If it's homing and has a target (not a miss)...
 					// Home at the centre of the part that was visible when firing.
-					psProj->dst = psProj->psDest->pos + Vector3i(0, 0, establishTargetHeight(psProj->psDest) - psProj->partVisible/2);
+					flight.dst = psDest->pos + Vector3i(0, 0, establishTargetHeight(psDest) - psProj->partVisible/2);
 				}
 				else
 				{
-					psProj->dst = psProj->psDest->pos + Vector3i(0, 0, establishTargetHeight(psProj->psDest)/2);
+					flight.dst = psDest->pos + Vector3i(0, 0, establishTargetHeight(psDest)/2);
 				}
-				DROID *targetDroid = castDroid(psProj->psDest);
+				DROID *targetDroid = castDroid(psDest);
 				if (targetDroid != NULL)
 				{
 					// Do target prediction.
-					Vector3i delta = psProj->dst - psProj->pos;
+					Vector3i delta = flight.dst - flight.pos;
 					int flightTime = iHypot(removeZ(delta)) * GAME_TICKS_PER_SEC / psStats->flightSpeed;
-					psProj->dst += Vector3i(iSinCosR(targetDroid->sMove.moveDir, std::min<int>(targetDroid->sMove.speed, psStats->flightSpeed*3/4)*flightTime / GAME_TICKS_PER_SEC), 0);
+					flight.dst += Vector3i(iSinCosR(targetDroid->sMove.moveDir, std::min<int>(targetDroid->sMove.speed, psStats->flightSpeed*3/4)*flightTime / GAME_TICKS_PER_SEC), 0);
 				}
-				psProj->dst.x = clip(psProj->dst.x, 0, world_coord(mapWidth) - 1);
-				psProj->dst.y = clip(psProj->dst.y, 0, world_coord(mapHeight) - 1);
+				flight.dst.x = clip(flight.dst.x, 0, world_coord(mapWidth) - 1);
+				flight.dst.y = clip(flight.dst.y, 0, world_coord(mapHeight) - 1);
 			}
 			if (psStats->movementModel == MM_HOMINGINDIRECT)
 			{
-				if (psProj->psDest == NULL)
+				if (psDest == NULL)
 				{
-					psProj->dst.z = map_Height(removeZ(psProj->pos)) - 1;  // Target missing, so just home in on the ground under where the target was.
+					flight.dst.z = map_Height(removeZ(flight.pos)) - 1;  // Target missing, so just home in on the ground under where the target was.
 				}
-				int horizontalTargetDistance = iHypot(removeZ(psProj->dst - psProj->pos));
-				int terrainHeight = std::max(map_Height(removeZ(psProj->pos)), map_Height(removeZ(psProj->pos) + iSinCosR(iAtan2(removeZ(psProj->dst - psProj->pos)), psStats->flightSpeed*2*deltaProjectileTime/GAME_TICKS_PER_SEC)));
+				int horizontalTargetDistance = iHypot(removeZ(flight.dst - flight.pos));
+				int terrainHeight = std::max(map_Height(removeZ(flight.pos)), map_Height(removeZ(flight.pos) + iSinCosR(iAtan2(removeZ(flight.dst - flight.pos)), psStats->flightSpeed*2*deltaProjectileTime/GAME_TICKS_PER_SEC)));
 				int desiredMinHeight = terrainHeight + std::min(horizontalTargetDistance/4, HOMINGINDIRECT_HEIGHT_MIN);
-				int desiredMaxHeight = std::max(psProj->dst.z, terrainHeight + HOMINGINDIRECT_HEIGHT_MAX);
-				int heightError = psProj->pos.z - clip(psProj->pos.z, desiredMinHeight, desiredMaxHeight);
-				psProj->dst.z -= horizontalTargetDistance*heightError*2/HOMINGINDIRECT_HEIGHT_MIN;
+				int desiredMaxHeight = std::max(flight.dst.z, terrainHeight + HOMINGINDIRECT_HEIGHT_MAX);
+				int heightError = flight.pos.z - clip(flight.pos.z, desiredMinHeight, desiredMaxHeight);
+				flight.dst.z -= horizontalTargetDistance*heightError*2/HOMINGINDIRECT_HEIGHT_MIN;
 			}
-			Vector3i delta = psProj->dst - psProj->pos;
+			Vector3i delta = flight.dst - flight.pos;
 			int targetDistance = std::max(iHypot(delta), 1);
-			if (psProj->psDest == NULL && targetDistance < 10000 && psStats->movementModel == MM_HOMINGDIRECT)
+			if (psDest == NULL && targetDistance < 10000 && psStats->movementModel == MM_HOMINGDIRECT)
 			{
-				psProj->dst = psProj->pos + delta*10;  // Target missing, so just keep going in a straight line.
+				flight.dst = flight.pos + delta*10;  // Target missing, so just keep going in a straight line.
 			}
 			currentDistance = timeSoFar * psStats->flightSpeed / GAME_TICKS_PER_SEC;
-			Vector3i step = quantiseFraction(delta * psStats->flightSpeed, GAME_TICKS_PER_SEC*targetDistance, psProj->time, psProj->prevSpacetime.time);
-			if (psStats->movementModel == MM_HOMINGINDIRECT && psProj->psDest != NULL)
+			Vector3i step = quantiseFraction(delta * psStats->flightSpeed, GAME_TICKS_PER_SEC*targetDistance, flight.time, flight.prevSpacetime.time);
+			if (psStats->movementModel == MM_HOMINGINDIRECT && psDest != NULL)
 			{
-				for (int tries = 0; tries < 10 && map_LineIntersect(psProj->prevSpacetime.pos, psProj->pos + step, iHypot(step)) < targetDistance - 1u; ++tries)
+				for (int tries = 0; tries < 10 && map_LineIntersect(flight.prevSpacetime.pos, flight.pos + step, iHypot(step)) < targetDistance - 1u; ++tries)
 				{
-					psProj->dst.z += iHypot(removeZ(psProj->dst - psProj->pos));  // Would collide with terrain this tick, change trajectory.
+					flight.dst.z += iHypot(removeZ(flight.dst - flight.pos));  // Would collide with terrain this tick, change trajectory.
 					// Recalculate delta, targetDistance and step.
-					delta = psProj->dst - psProj->pos;
+					delta = flight.dst - flight.pos;
 					targetDistance = std::max(iHypot(delta), 1);
-					step = quantiseFraction(delta * psStats->flightSpeed, GAME_TICKS_PER_SEC*targetDistance, psProj->time, psProj->prevSpacetime.time);
+					step = quantiseFraction(delta * psStats->flightSpeed, GAME_TICKS_PER_SEC*targetDistance, flight.time, flight.prevSpacetime.time);
 				}
 			}
-			psProj->pos += step;
-			psProj->rot.direction = iAtan2(removeZ(delta));
-			psProj->rot.pitch = iAtan2(delta.z, targetDistance);
+			flight.pos += step;
+			flight.rot.direction = iAtan2(removeZ(delta));
+			flight.rot.pitch = iAtan2(delta.z, targetDistance);
 			break;
 		}
 	}
+	flight.currentDistance = currentDistance;
+}
+
+static int proj_TargetBucket(int32_t coord, int numBuckets)
+{
+	int bucket = coord >= 0 ? coord/PROJ_TARGET_BUCKET_SIZE : -1 - (-1 - coord)/PROJ_TARGET_BUCKET_SIZE;  // Round down, even if negative.
+	return clip(bucket, 0, numBuckets - 1);
+}
+
+// Buckets everything in the grid by where it was put in the grid, keeping the grid order within each bucket. The grid doesn't change
+// while projectiles are updated, since objects which are destroyed or created only leave or join it at the next gridReset.
+static void proj_BucketTargets()
+{
+	std::vector<GridObject> const &objects = gridAllObjects();
+
+	// Counting sort by bucket.
+	projectileTargetBucketsX = world_coord(mapWidth)/PROJ_TARGET_BUCKET_SIZE + 1;
+	projectileTargetBucketsY = world_coord(mapHeight)/PROJ_TARGET_BUCKET_SIZE + 1;
+	static std::vector<unsigned> buckets;  // static to avoid allocations.
+	buckets.resize(objects.size());
+	projectileTargetBucketStart.assign(projectileTargetBucketsX*projectileTargetBucketsY + 1, 0);
+	for (unsigned n = 0; n < objects.size(); ++n)
+	{
+		buckets[n] = proj_TargetBucket(objects[n].gridPos.x, projectileTargetBucketsX) + proj_TargetBucket(objects[n].gridPos.y, projectileTargetBucketsY)*projectileTargetBucketsX;
+		++projectileTargetBucketStart[buckets[n] + 1];
+	}
+	for (unsigned bucket = 1; bucket < projectileTargetBucketStart.size(); ++bucket)
+	{
+		projectileTargetBucketStart[bucket] += projectileTargetBucketStart[bucket - 1];
+	}
+	static std::vector<unsigned> next;
+	next.assign(projectileTargetBucketStart.begin(), projectileTargetBucketStart.end() - 1);
+	projectileTargets.resize(objects.size());
+	for (unsigned n = 0; n < objects.size(); ++n)
+	{
+		ProjectileTarget target = {objects[n].psObj, objects[n].gridPos, n};
+		projectileTargets[next[buckets[n]]++] = target;
+	}
+	projectileTargetsValid = true;
+}
+
+static bool projectileTargetOrderLess(ProjectileTarget const &a, ProjectileTarget const &b)
+{
+	return a.order < b.order;
+}
+
+// Finds what the projectile could hit where it moved to, the same objects in the same order as gridStartIterate(pos, PROJ_NEIGHBOUR_RANGE).
+static void proj_FindTargets(ProjectileFlight &flight)
+{
+	if (!projectileTargetsValid)
+	{
+		proj_BucketTargets();
+	}
+
+	int32_t x = flight.pos.x, y = flight.pos.y;
+	const uint32_t radius = PROJ_NEIGHBOUR_RANGE;
+	int minBucketX = proj_TargetBucket(x - radius, projectileTargetBucketsX), maxBucketX = proj_TargetBucket(x + radius, projectileTargetBucketsX);
+	int minBucketY = proj_TargetBucket(y - radius, projectileTargetBucketsY), maxBucketY = proj_TargetBucket(y + radius, projectileTargetBucketsY);
+	flight.targetsBegin = projectileCandidates.size();
+	for (int bucketY = minBucketY; bucketY <= maxBucketY; ++bucketY)
+	{
+		for (int bucketX = minBucketX; bucketX <= maxBucketX; ++bucketX)
+		{
+			int bucket = bucketX + bucketY*projectileTargetBucketsX;
+			for (unsigned n = projectileTargetBucketStart[bucket]; n < projectileTargetBucketStart[bucket + 1]; ++n)
+			{
+				ProjectileTarget const &target = projectileTargets[n];
+				if (target.gridPos.x >= x - (int32_t)radius && target.gridPos.x <= x + (int32_t)radius && target.gridPos.y >= y - (int32_t)radius && target.gridPos.y <= y + (int32_t)radius
+				    && gridIsInRadius(target.psObj->pos.x - x, target.psObj->pos.y - y, radius))
+				{
+					projectileCandidates.push_back(target);
+				}
+			}
+		}
+	}
+	std::sort(projectileCandidates.begin() + flight.targetsBegin, projectileCandidates.end(), projectileTargetOrderLess);
+	flight.targetsEnd = projectileCandidates.size();
+	flight.targetsFound = true;
+}
+
+// Finds what all projectiles which moved could hit, going through them bucket by bucket, so that each bucket of targets is looked at
+// by all nearby projectiles together.
+static void proj_FindAllTargets(size_t numProjectiles)
+{
+	if (!projectileTargetsValid)
+	{
+		proj_BucketTargets();
+	}
+
+	static std::vector<std::pair<unsigned, unsigned> > order;  // Bucket and index of each projectile which moved. static to avoid allocations.
+	order.clear();
+	for (unsigned n = 0; n < numProjectiles; ++n)
+	{
+		ProjectileFlight const &flight = projectileFlights[n];
+		if (flight.moved)
+		{
+			unsigned bucket = proj_TargetBucket(flight.pos.x, projectileTargetBucketsX) + proj_TargetBucket(flight.pos.y, projectileTargetBucketsY)*projectileTargetBucketsX;
+			order.push_back(std::make_pair(bucket, n));
+		}
+	}
+	std::sort(order.begin(), order.end());
+	for (unsigned n = 0; n < order.size(); ++n)
+	{
+		proj_FindTargets(projectileFlights[order[n].second]);
+	}
+}
+
+// Records where psProj is at the start of the tick, and if it is in flight, moves it. Returns true if it moved.
+static bool proj_StartFlight(PROJECTILE *psProj, ProjectileFlight &flight)
+{
+
+	flight.moved = false;
+	flight.targetsFound = false;
+	flight.psStats = psProj->psWStats;
+	flight.prevSpacetime = getSpacetime(psProj);
+	if (psProj->state != PROJ_INFLIGHT || flight.psStats == NULL || !worldOnMap(psProj->pos.x, psProj->pos.y))
+	{
+		return false;  // Not moving, see PROJECTILE::update.
+	}
+	if (bMultiPlayer && flight.psStats->weaponSubClass == WSC_LAS_SAT && (unsigned)(gameTime - psProj->born) < LAS_SAT_DELAY * GAME_TICKS_PER_SEC)
+	{
+		return false;
+	}
+
+	// Dead targets are forgotten by PROJECTILE::update before moving.
+	proj_Move(psProj, psProj->psDest != NULL && !psProj->psDest->died ? psProj->psDest : NULL, flight);
+	flight.moved = true;
+	return true;
+}
+
+static void proj_InFlightFunc(PROJECTILE *psProj, ProjectileFlight &flight)
+{
+	BASE_OBJECT *closestCollisionObject = NULL;
+	Spacetime closestCollisionSpacetime;
+	memset(&closestCollisionSpacetime, 0, sizeof(Spacetime));  // Squelch uninitialised warning.
+
+	CHECK_PROJECTILE(psProj);
+
+	int timeSoFar = gameTime - psProj->born;
+
+	psProj->time = gameTime;
+
+	WEAPON_STATS *psStats = psProj->psWStats;
+	ASSERT_OR_RETURN( , psStats != NULL, "Invalid weapon stats pointer");
+
+	/* we want a delay between Las-Sats firing and actually hitting in multiPlayer
+	magic number but that's how long the audio countdown message lasts! */
+	if (bMultiPlayer && psStats->weaponSubClass == WSC_LAS_SAT &&
+	    (unsigned)timeSoFar < LAS_SAT_DELAY * GAME_TICKS_PER_SEC)
+	{
+		return;
+	}
+
+	if (!flight.moved || flight.psDest != psProj->psDest)
+	{
+		// The target was destroyed by an earlier projectile this tick, so homing projectiles fly elsewhere.
+		proj_Move(psProj, psProj->psDest, flight);
+	}
+	psProj->pos = flight.pos;
+	psProj->rot = flight.rot;
+	psProj->dst = flight.dst;
+	int32_t currentDistance = flight.currentDistance;
 
 	closestCollisionSpacetime.time = 0xFFFFFFFF;
 
 	/* Check nearby objects for possible collisions */
-	static GridList gridList;  // static to avoid allocations.
-	gridList = gridStartIterate(psProj->pos.x, psProj->pos.y, PROJ_NEIGHBOUR_RANGE);
-	for (GridIterator gi = gridList.begin(); gi != gridList.end(); ++gi)
+	if (!flight.targetsFound)
+	{
+		proj_FindTargets(flight);
+	}
+	for (unsigned n = flight.targetsBegin; n < flight.targetsEnd; ++n)
 	{
-		BASE_OBJECT *psTempObj = *gi;
+		BASE_OBJECT *psTempObj = projectileCandidates[n].psObj;
 		CHECK_OBJECT(psTempObj);
 
 		if (std::find(psProj->psDamaged.begin(), psProj->psDamaged.end(), psTempObj) != psProj->psDamaged.end())
@@ -1256,7 +1453,7 @@ static void proj_PostImpactFunc( PROJECTILE *psObj )
 
 /***************************************************************************/
 
-void PROJECTILE::update()
+void PROJECTILE::update(ProjectileFlight &flight)
 {
 	PROJECTILE *psObj = this;
 
@@ -1290,7 +1487,7 @@ void PROJECTILE::update()
 	switch (psObj->state)
 	{
 		case PROJ_INFLIGHT:
-			proj_InFlightFunc(psObj);
+			proj_InFlightFunc(psObj, flight);
 			if (psObj->state != PROJ_IMPACT)
 			{
 				break;
@@ -1320,10 +1517,29 @@ void PROJECTILE::update()
 // iterate through all projectiles and update their status
 void proj_UpdateAll()
 {
-	std::vector<PROJECTILE *> psProjectileListOld = psProjectileList;
+	// Penetrating projectiles may add to psProjectileList, the new ones are first updated next tick.
+	size_t numProjectiles = psProjectileList.size();
 
-	// Update all projectiles. Penetrating projectiles may add to psProjectileList.
-	std::for_each(psProjectileListOld.begin(), psProjectileListOld.end(), std::mem_fun(&PROJECTILE::update));
+	// Move all projectiles in flight, then find what each of them could hit, with the projectiles and the grid bucketed together.
+	// Neither depends on the damage done by other projectiles, except that homing projectiles are moved again if their target is destroyed first.
+	projectileFlights.resize(numProjectiles);
+	projectileCandidates.clear();
+	projectileTargetsValid = false;
+	bool anyMoved = false;
+	for (size_t n = 0; n < numProjectiles; ++n)
+	{
+		anyMoved = proj_StartFlight(psProjectileList[n], projectileFlights[n]) || anyMoved;
+	}
+	if (anyMoved)
+	{
+		proj_FindAllTargets(numProjectiles);
+	}
+
+	// Update all projectiles in order, since the damage done by one can change what the next one hits.
+	for (size_t n = 0; n < numProjectiles; ++n)
+	{
+		psProjectileList[n]->update(projectileFlights[n]);
+	}
 
 	// Remove and free dead projectiles.
 	psProjectileList.erase(std::remove_if(psProjectileList.begin(), psProjectileList.end(), std::mem_fun(&PROJECTILE::deleteIfDead)), psProjectileList.end());
@@ -52,6 +52,7 @@ bool	proj_Shutdown(void);	///< Shut down projectile subsystem.
 
 PROJECTILE *proj_GetFirst(void);	///< Get first projectile in the list.
 PROJECTILE *proj_GetNext(void);		///< Get next projectile in the list.
+unsigned proj_Count(void);		///< Number of projectiles in the list.
 
 void	proj_FreeAllProjectiles(void);	///< Free all projectiles in the list.
 
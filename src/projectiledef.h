@@ -38,11 +38,16 @@ enum PROJ_STATE
 	PROJ_INACTIVE,
 };
 
+struct ProjectileFlight;
+
 struct PROJECTILE : public SIMPLE_OBJECT
 {
 	PROJECTILE(uint32_t id, unsigned player) : SIMPLE_OBJECT(OBJ_PROJECTILE, id, player) {}
 
-	void            update();
+	static void *operator new(size_t size);  ///< Projectiles are allocated from a pool, see objmem.cpp.
+	static void operator delete(void *projectile);
+
+	void            update(ProjectileFlight &flight);  ///< See proj_UpdateAll.
 	bool            deleteIfDead() { if (died == 0 || died >= gameTime - deltaGameTime) return false; delete this; return true; }
 
 
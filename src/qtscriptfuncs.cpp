@@ -804,7 +804,7 @@ bool writeLabels(const char *filename)
 {
 	int c[4]; // make unique, incremental section names
 	memset(c, 0, sizeof(c));
-	WzConfig ini(filename);
+	WzConfig ini(filename, WzConfig::ReadAndWrite, WzConfig::BinaryFileInBackground);
 	for (LABELMAP::const_iterator i = labels.constBegin(); i != labels.constEnd(); i++)
 	{
 		QString key = i.key();
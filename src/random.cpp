@@ -21,6 +21,7 @@
 #include "lib/netplay/netplay.h"
 
 static MersenneTwister gamePseudorandomNumberGenerator;
+static uint32_t gamePseudorandomSeed = 0;
 
 MersenneTwister::MersenneTwister(uint32_t seed)
 	: offset(624)
@@ -80,6 +81,12 @@ void MersenneTwister::generate()
 void gameSRand(uint32_t seed)
 {
 	gamePseudorandomNumberGenerator = MersenneTwister(seed);
+	gamePseudorandomSeed = seed;
+}
+
+uint32_t gameSRandSeed()
+{
+	return gamePseudorandomSeed;
 }
 
 uint32_t gameRandU32()
@@ -0,0 +1,229 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2013  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/**
+ * @file replay.cpp
+ * Saves the settings needed to start the same game again, next to the game queue messages recorded by the netplay library.
+ *
+ * Playback starts the game the way a client does on receiving NET_FIREUP, except that the settings come from the file,
+ * and the game queue messages are then fed from the file instead of from the network.
+ */
+
+#include "lib/framework/frame.h"
+#include "lib/gamelib/gtime.h"
+#include "lib/netplay/netplay.h"
+#include "lib/netplay/netreplay.h"
+
+#include "replay.h"
+#include "ai.h"
+#include "multiint.h"
+#include "multiplay.h"
+#include "random.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QDataStream>
+
+static const qint32 replaySettingsVersion = 2;
+
+static char *replayRecordFile = NULL;
+static char *replayPlaybackFile = NULL;
+
+void replaySetRecordFile(const char *fileName)
+{
+	free(replayRecordFile);
+	replayRecordFile = fileName != NULL ? strdup(fileName) : NULL;
+}
+
+void replaySetPlaybackFile(const char *fileName)
+{
+	free(replayPlaybackFile);
+	replayPlaybackFile = fileName != NULL ? strdup(fileName) : NULL;
+}
+
+const char *replayGetPlaybackFile()
+{
+	return replayPlaybackFile;
+}
+
+void replayStartRecording()
+{
+	if (replayRecordFile == NULL || !bMultiPlayer || NETreplayIsLoading())
+	{
+		return;  // Campaign games do not go through the game queues, and a replay being played back is already recorded.
+	}
+
+	QByteArray bytes;
+	QDataStream out(&bytes, QIODevice::WriteOnly);
+	out << replaySettingsVersion;
+	out << quint32(gameSRandSeed());
+
+	out << quint8(game.type) << QByteArray(game.map) << QByteArray(reinterpret_cast<const char *>(game.hash.bytes), game.hash.Bytes);
+	out << quint8(game.maxPlayers) << QByteArray(game.name) << quint32(game.power) << quint8(game.base) << quint8(game.alliance);
+	out << game.scavengers << game.mapHasScavengers << game.isMapMod;
+	for (unsigned i = 0; i < MAX_PLAYERS; ++i)
+	{
+		out << quint8(game.skDiff[i]);
+	}
+	for (unsigned i = 0; i < MAX_PLAYERS; ++i)
+	{
+		for (unsigned j = 0; j < MAX_PLAYERS; ++j)
+		{
+			out << quint8(alliances[i][j]);
+		}
+	}
+	out << quint32(ingame.numStructureLimits);
+	for (unsigned i = 0; i < ingame.numStructureLimits; ++i)
+	{
+		out << quint32(ingame.pStructureLimits[i].id) << quint32(ingame.pStructureLimits[i].limit);
+	}
+	out << quint8(ingame.flags);
+
+	for (unsigned i = 0; i < MAX_PLAYERS; ++i)
+	{
+		PLAYER const &p = NetPlay.players[i];
+		out << QByteArray(p.name) << qint32(p.position) << qint32(p.colour) << p.allocated << qint32(p.team) << qint8(p.ai) << qint8(p.difficulty);
+	}
+	out << quint32(selectedPlayer) << quint32(NetPlay.hostPlayer) << NetPlay.isHost;
+
+	NETreplaySaveStart(replayRecordFile, std::vector<uint8_t>(bytes.begin(), bytes.end()));
+}
+
+static void readString(QDataStream &in, char *dest, size_t size)
+{
+	QByteArray str;
+	in >> str;
+	strlcpy(dest, str.constData(), size);
+}
+
+bool replayStartPlayback()
+{
+	std::vector<uint8_t> settings;
+	if (replayPlaybackFile == NULL || !NETreplayLoadStart(replayPlaybackFile, settings))
+	{
+		return false;
+	}
+
+	if (settings.empty())
+	{
+		debug(LOG_ERROR, "\"%s\" has no settings.", replayPlaybackFile);
+		NETreplayLoadStop();
+		return false;
+	}
+	QByteArray bytes(reinterpret_cast<const char *>(&settings[0]), settings.size());
+	QDataStream in(bytes);
+	qint32 version = 0;
+	quint32 seed = 0;
+	quint8 u8 = 0;
+	quint32 u32 = 0;
+	qint32 i32 = 0;
+	qint8 i8 = 0;
+	in >> version;
+	if (version != replaySettingsVersion)
+	{
+		debug(LOG_ERROR, "Unsupported replay settings version %d.", version);
+		NETreplayLoadStop();
+		return false;
+	}
+	in >> seed;
+
+	in >> u8; game.type = u8;
+	readString(in, game.map, sizeof(game.map));
+	QByteArray hash;
+	in >> hash;
+	memset(game.hash.bytes, 0, game.hash.Bytes);
+	memcpy(game.hash.bytes, hash.constData(), std::min<size_t>(hash.size(), game.hash.Bytes));
+	in >> u8; game.maxPlayers = u8;
+	readString(in, game.name, sizeof(game.name));
+	in >> u32; game.power = u32;
+	in >> u8; game.base = u8;
+	in >> u8; game.alliance = u8;
+	in >> game.scavengers >> game.mapHasScavengers >> game.isMapMod;
+	for (unsigned i = 0; i < MAX_PLAYERS; ++i)
+	{
+		in >> u8; game.skDiff[i] = u8;
+	}
+	for (unsigned i = 0; i < MAX_PLAYERS; ++i)
+	{
+		for (unsigned j = 0; j < MAX_PLAYERS; ++j)
+		{
+			in >> u8; alliances[i][j] = u8;
+		}
+	}
+
+	free(ingame.pStructureLimits);
+	ingame.pStructureLimits = NULL;
+	in >> u32; ingame.numStructureLimits = u32;
+	if (in.status() != QDataStream::Ok || ingame.numStructureLimits > (unsigned)settings.size())
+	{
+		ingame.numStructureLimits = 0;  // Corrupt, avoid allocating nonsense.
+	}
+	if (ingame.numStructureLimits)
+	{
+		ingame.pStructureLimits = (MULTISTRUCTLIMITS *)malloc(ingame.numStructureLimits * sizeof(MULTISTRUCTLIMITS));
+	}
+	for (unsigned i = 0; i < ingame.numStructureLimits; ++i)
+	{
+		in >> u32; ingame.pStructureLimits[i].id = u32;
+		in >> u32; ingame.pStructureLimits[i].limit = u32;
+	}
+	in >> u8; ingame.flags = u8;
+
+	for (unsigned i = 0; i < MAX_PLAYERS; ++i)
+	{
+		PLAYER &p = NetPlay.players[i];
+		readString(in, p.name, sizeof(p.name));
+		in >> i32; p.position = i32;
+		in >> i32; p.colour = i32;
+		in >> p.allocated;
+		in >> i32; p.team = i32;
+		in >> i8; p.ai = i8;
+		in >> i8; p.difficulty = i8;
+		setPlayerName(i, "");  // Use the recorded names.
+		ingame.JoiningInProgress[i] = false;
+	}
+	in >> u32; selectedPlayer = u32;
+	in >> u32; NetPlay.hostPlayer = u32;
+	in >> NetPlay.isHost;
+	realSelectedPlayer = selectedPlayer;
+
+	if (in.status() != QDataStream::Ok || selectedPlayer >= MAX_PLAYERS || game.maxPlayers > MAX_PLAYERS)
+	{
+		debug(LOG_ERROR, "\"%s\" has corrupt settings.", replayPlaybackFile);
+		NETreplayLoadStop();
+		return false;
+	}
+
+	if (!startGameWithoutFrontend(seed))
+	{
+		NETreplayLoadStop();
+		return false;
+	}
+	debug(LOG_INFO, "Playing back \"%s\" on map %s as player %u.", replayPlaybackFile, game.map, selectedPlayer);
+	return true;
+}
+
+void replayStop()
+{
+	NETreplaySaveStop();
+	NETreplayLoadStop();
+}
+
+bool replayFinished()
+{
+	return NETreplayHasEnded() && !checkPlayerGameTime(NET_ALL_PLAYERS);
+}
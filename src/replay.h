@@ -0,0 +1,41 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2013  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Records skirmish and multiplayer games to replay files, and plays them back.
+ */
+
+#ifndef __INCLUDED_SRC_REPLAY_H__
+#define __INCLUDED_SRC_REPLAY_H__
+
+/// File to record the next game to, set from the command line. NULL to not record.
+void replaySetRecordFile(const char *fileName);
+/// File to play back instead of showing the title screen, set from the command line. NULL to not play back.
+void replaySetPlaybackFile(const char *fileName);
+const char *replayGetPlaybackFile();
+
+/// Starts recording, if a record file was set. Call when the game starts, after the random seed is known.
+void replayStartRecording();
+/// Loads the settings from the playback file, and starts the game. Returns false if the file could not be loaded.
+bool replayStartPlayback();
+/// Stops recording or playing back. Does nothing if not recording or playing back.
+void replayStop();
+/// True if playing back, and the replay has no more messages for the game to continue with.
+bool replayFinished();
+
+#endif // __INCLUDED_SRC_REPLAY_H__
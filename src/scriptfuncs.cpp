@@ -5981,6 +5981,7 @@ bool scrResetPlayerVisibility(void)
 	}
 
 	clustResetVisibility(player);
+	aiInvalidateTargetCandidates();
 
 	return true;
 }
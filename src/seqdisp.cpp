@@ -240,7 +240,8 @@ static bool seq_StartFullScreenVideo(QString videoName, QString audioName, VIDEO
 		seq_SetUserResolution();
 	}
 
-	if (!seq_Play(aVideoName.toUtf8().constData()))
+	// When headless, carry on as if the video were missing.
+	if (isHeadless() || !seq_Play(aVideoName.toUtf8().constData()))
 	{
 		seq_Shutdown();
 		return false;
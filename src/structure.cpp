@@ -67,6 +67,7 @@
 #include "group.h"
 #include "transporter.h"
 #include "fpath.h"
+#include "astar.h"
 #include "mission.h"
 #include "levels.h"
 #include "console.h"
@@ -174,6 +175,7 @@ static void auxStructureNonblocking(STRUCTURE *psStructure)
 			auxClearAll(b.map.x + i, b.map.y + j, AUXBITS_BLOCKING | AUXBITS_OUR_BUILDING | AUXBITS_NONPASSABLE);
 		}
 	}
+	fpathBlockingTilesChanged(b);
 }
 
 static void auxStructureBlocking(STRUCTURE *psStructure)
@@ -188,6 +190,7 @@ static void auxStructureBlocking(STRUCTURE *psStructure)
 			auxSetAll(b.map.x + i, b.map.y + j, AUXBITS_BLOCKING | AUXBITS_NONPASSABLE);
 		}
 	}
+	fpathBlockingTilesChanged(b);
 }
 
 static void auxStructureOpenGate(STRUCTURE *psStructure)
@@ -201,6 +204,7 @@ static void auxStructureOpenGate(STRUCTURE *psStructure)
 			auxClearAll(b.map.x + i, b.map.y + j, AUXBITS_BLOCKING);
 		}
 	}
+	fpathBlockingTilesChanged(b);
 }
 
 static void auxStructureClosedGate(STRUCTURE *psStructure)
@@ -215,6 +219,7 @@ static void auxStructureClosedGate(STRUCTURE *psStructure)
 			auxSetAll(b.map.x + i, b.map.y + j, AUXBITS_BLOCKING);
 		}
 	}
+	fpathBlockingTilesChanged(b);
 }
 
 bool IsStatExpansionModule(STRUCTURE_STATS const *psStats)
@@ -1457,6 +1462,7 @@ STRUCTURE* buildStructureDir(STRUCTURE_STATS *pStructureType, UDWORD x, UDWORD y
 				}
 			}
 		}
+		fpathBlockingTilesChanged(StructureBounds(map, size));
 
 		switch (pStructureType->type)
 		{
@@ -4480,6 +4486,7 @@ static void removeStructFromMap(STRUCTURE *psStruct)
 			auxClearBlocking(b.map.x + i, b.map.y + j, AIR_BLOCKED);
 		}
 	}
+	fpathBlockingTilesChanged(b);
 }
 
 // remove a structure from a game without any visible effects
@@ -4507,8 +4514,7 @@ bool removeStruct(STRUCTURE *psDel, bool bDestroy)
 		HOW MUCH IS THERE && NOT RES EXTRACTORS */
 		if (psDel->pStructureType->type == REF_RESOURCE_EXTRACTOR)
 		{
-			FEATURE *psOil = buildFeature(oilResFeature, psDel->pos.x, psDel->pos.y, false);
-			memcpy(psOil->seenThisTick, psDel->visible, sizeof(psOil->seenThisTick));
+			buildFeature(oilResFeature, psDel->pos.x, psDel->pos.y, false);
 			resourceFound = true;
 		}
 	}
@@ -6032,7 +6038,7 @@ void hqReward(UBYTE losingPlayer, UBYTE rewardPlayer)
 			MAPTILE *psTile = mapTile(x, y);
 			if (TEST_TILE_VISIBLE(losingPlayer, psTile))
 			{
-				psTile->tileExploredBits |= alliancebits[rewardPlayer];
+				mapTileVision(psTile)->tileExploredBits |= alliancebits[rewardPlayer];
 			}
 		}
 	}
@@ -6066,6 +6072,7 @@ void hqReward(UBYTE losingPlayer, UBYTE rewardPlayer)
 			}
 		}
 	}
+	aiInvalidateTargetCandidates();
 }
 
 
@@ -6958,6 +6965,7 @@ STRUCTURE * giftSingleStructure(STRUCTURE *psStructure, UBYTE attackPlayer, bool
 			//since the structure isn't being rebuilt, the visibility code needs to be adjusted
 			//make sure this structure is visible to selectedPlayer
 			psStructure->visible[attackPlayer] = UINT8_MAX;
+			aiInvalidateTargetCandidates();  // Also changed its player.
 			triggerEventObjectTransfer(psStructure, attackPlayer);
 		}
 		intNotifyResearchButton(prevState);
@@ -243,6 +243,9 @@ struct STRUCTURE : public BASE_OBJECT
 	STRUCTURE(uint32_t id, unsigned player);
 	~STRUCTURE();
 
+	static void *operator new(size_t size);  ///< Structures are allocated from a pool, see objmem.cpp.
+	static void operator delete(void *structure);
+
 	STRUCTURE_STATS     *pStructureType;            /* pointer to the structure stats for this type of building */
 	STRUCT_STATES       status;                     /* defines whether the structure is being built, doing nothing or performing a function */
 	int32_t             currentBuildPts;            /* the build points currently assigned to this structure */
@@ -670,6 +670,11 @@ bool initTerrain(void)
 	int decalSize;
 	int maxSectorSizeIndices, maxSectorSizeVertices;
 	bool decreasedSize = false;
+
+	if (isHeadless())
+	{
+		return true;  // Nothing to draw the terrain with, and markTileDirty() ignores the terrain until it is initialised.
+	}
 	
 	// this information is useful to prevent crashes with buggy opengl implementations
 	glGetIntegerv(GL_MAX_ELEMENTS_VERTICES, &GLmaxElementsVertices);
@@ -1014,6 +1019,10 @@ bool initTerrain(void)
 /// free all memory and opengl buffers used by the terrain renderer
 void shutdownTerrain(void)
 {
+	if (isHeadless())
+	{
+		return;
+	}
 	ASSERT_OR_RETURN( ,sectors, "trying to shutdown terrain when it didn't need it!");
 	glDeleteBuffers(1, &geometryVBO);
 	glDeleteBuffers(1, &geometryIndexVBO);
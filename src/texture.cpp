@@ -127,7 +127,14 @@ bool texLoad(const char *fileName)
 	mipmap_max = MIPMAP_MAX;
 	mipmap_levels = MIPMAP_LEVELS;
 
-	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &glval);
+	if (isHeadless())
+	{
+		glval = mipmap_max * TILES_IN_PAGE_COLUMN;
+	}
+	else
+	{
+		glGetIntegerv(GL_MAX_TEXTURE_SIZE, &glval);
+	}
 
 	while (glval < mipmap_max * TILES_IN_PAGE_COLUMN)
 	{
@@ -173,6 +180,11 @@ bool texLoad(const char *fileName)
 	} while (k >= 3 && j + 6 < size);
 	free(buffer);
 
+	if (isHeadless())
+	{
+		return true;  // The tiles are only ever drawn.
+	}
+
 	/* Now load the actual tiles */
 
 	i = mipmap_max; // i is used to keep track of the tile dimensions
@@ -0,0 +1,210 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 1999-2004  Eidos Interactive
+	Copyright (C) 2005-2013  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/**
+ * @file tickprofile.cpp
+ * Records how long each stage of the game state update takes, in a ring buffer of recent ticks.
+ */
+
+#include "lib/framework/frame.h"
+#include "lib/gamelib/gtime.h"
+
+#include "tickprofile.h"
+#include "objmem.h"
+#include "projectile.h"
+
+#include <QtCore/QElapsedTimer>
+#include <errno.h>
+
+uint32_t tickProfileAllocations = 0;
+
+static const char *tickStageNames[TICK_STAGE_COUNT] =
+{
+	"scripts",
+	"abandoned",
+	"grid",
+	"visibility",
+	"map",
+	"fpath",
+	"cluster",
+	"commanders",
+	"callbacks",
+	"power",
+	"droids",
+	"structures",
+	"projectiles",
+	"features",
+	"objmem",
+};
+
+static QElapsedTimer    tickTimer;
+static TICK_PROFILE     tickHistory[TICK_PROFILE_HISTORY];
+static unsigned         tickHistoryNext = 0;     // Where the next tick goes.
+static unsigned         tickHistoryCount = 0;
+static TICK_PROFILE     tickCurrent;
+static int64_t          tickStart;
+static int64_t          stageStart[TICK_STAGE_COUNT];
+static uint32_t         stageStartAllocs[TICK_STAGE_COUNT];
+static char             *tickDumpFile = NULL;
+
+static int64_t tickProfileMicroseconds()
+{
+	if (!tickTimer.isValid())
+	{
+		tickTimer.start();
+	}
+	return tickTimer.nsecsElapsed() / 1000;
+}
+
+void tickProfileReset()
+{
+	tickHistoryNext = 0;
+	tickHistoryCount = 0;
+}
+
+void tickProfileBeginTick()
+{
+	memset(&tickCurrent, 0, sizeof(tickCurrent));
+	tickStart = tickProfileMicroseconds();
+}
+
+void tickProfileEndTick()
+{
+	int droids, structures, features;
+	objCount(&droids, &structures, &features);
+
+	tickCurrent.gameTime = gameTime;
+	tickCurrent.totalTime = tickProfileMicroseconds() - tickStart;
+	tickCurrent.droids = droids;
+	tickCurrent.structures = structures;
+	tickCurrent.features = features;
+	tickCurrent.projectiles = proj_Count();
+
+	tickHistory[tickHistoryNext] = tickCurrent;
+	tickHistoryNext = (tickHistoryNext + 1) % TICK_PROFILE_HISTORY;
+	tickHistoryCount = std::min(tickHistoryCount + 1, (unsigned)TICK_PROFILE_HISTORY);
+}
+
+void tickProfileBegin(TICK_STAGE stage)
+{
+	stageStart[stage] = tickProfileMicroseconds();
+	stageStartAllocs[stage] = tickProfileAllocations;
+}
+
+void tickProfileEnd(TICK_STAGE stage)
+{
+	tickCurrent.stageTime[stage] += tickProfileMicroseconds() - stageStart[stage];
+	tickCurrent.stageAllocs[stage] += tickProfileAllocations - stageStartAllocs[stage];
+}
+
+const char *tickProfileStageName(TICK_STAGE stage)
+{
+	ASSERT_OR_RETURN("", stage < TICK_STAGE_COUNT, "Bad stage %d", (int)stage);
+	return tickStageNames[stage];
+}
+
+unsigned tickProfileCount()
+{
+	return tickHistoryCount;
+}
+
+TICK_PROFILE const &tickProfileGet(unsigned index)
+{
+	ASSERT(index < tickHistoryCount, "Only have %u ticks, not %u.", tickHistoryCount, index);
+	return tickHistory[(tickHistoryNext + TICK_PROFILE_HISTORY - tickHistoryCount + index) % TICK_PROFILE_HISTORY];
+}
+
+static void tickProfileDumpCSV(FILE *file)
+{
+	fprintf(file, "gameTime, total");
+	for (int stage = 0; stage < TICK_STAGE_COUNT; ++stage)
+	{
+		fprintf(file, ", %s", tickStageNames[stage]);
+	}
+	for (int stage = 0; stage < TICK_STAGE_COUNT; ++stage)
+	{
+		fprintf(file, ", %s allocs", tickStageNames[stage]);
+	}
+	fprintf(file, ", droids, structures, features, projectiles\n");
+
+	for (unsigned n = 0; n < tickHistoryCount; ++n)
+	{
+		TICK_PROFILE const &tick = tickProfileGet(n);
+		fprintf(file, "%u, %u", tick.gameTime, tick.totalTime);
+		for (int stage = 0; stage < TICK_STAGE_COUNT; ++stage)
+		{
+			fprintf(file, ", %u", tick.stageTime[stage]);
+		}
+		for (int stage = 0; stage < TICK_STAGE_COUNT; ++stage)
+		{
+			fprintf(file, ", %u", tick.stageAllocs[stage]);
+		}
+		fprintf(file, ", %u, %u, %u, %u\n", tick.droids, tick.structures, tick.features, tick.projectiles);
+	}
+}
+
+static void tickProfileDumpJSON(FILE *file)
+{
+	fprintf(file, "{\"units\": \"microseconds\", \"ticks\": [");
+	for (unsigned n = 0; n < tickHistoryCount; ++n)
+	{
+		TICK_PROFILE const &tick = tickProfileGet(n);
+		fprintf(file, "%s\n{\"gameTime\": %u, \"total\": %u, \"stages\": {", n == 0 ? "" : ",", tick.gameTime, tick.totalTime);
+		for (int stage = 0; stage < TICK_STAGE_COUNT; ++stage)
+		{
+			fprintf(file, "%s\"%s\": {\"time\": %u, \"allocs\": %u}", stage == 0 ? "" : ", ", tickStageNames[stage], tick.stageTime[stage], tick.stageAllocs[stage]);
+		}
+		fprintf(file, "}, \"droids\": %u, \"structures\": %u, \"features\": %u, \"projectiles\": %u}", tick.droids, tick.structures, tick.features, tick.projectiles);
+	}
+	fprintf(file, "\n]}\n");
+}
+
+bool tickProfileDump(const char *fileName)
+{
+	FILE *file = fopen(fileName, "w");
+	if (file == NULL)
+	{
+		debug(LOG_ERROR, "Could not open \"%s\" for writing: %s", fileName, strerror(errno));
+		return false;
+	}
+
+	size_t len = strlen(fileName);
+	if (len >= 5 && strcmp(fileName + len - 5, ".json") == 0)
+	{
+		tickProfileDumpJSON(file);
+	}
+	else
+	{
+		tickProfileDumpCSV(file);
+	}
+	fclose(file);
+	debug(LOG_INFO, "Wrote %u ticks of profiling data to \"%s\".", tickHistoryCount, fileName);
+	return true;
+}
+
+void tickProfileSetDumpFile(const char *fileName)
+{
+	free(tickDumpFile);
+	tickDumpFile = fileName != NULL ? strdup(fileName) : NULL;
+}
+
+const char *tickProfileGetDumpFile()
+{
+	return tickDumpFile;
+}
@@ -0,0 +1,94 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 1999-2004  Eidos Interactive
+	Copyright (C) 2005-2013  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Measures how long each stage of the game state update takes, for finding out what makes ticks slow.
+ */
+
+#ifndef __INCLUDED_SRC_TICKPROFILE_H__
+#define __INCLUDED_SRC_TICKPROFILE_H__
+
+#include <stdio.h>
+
+/// Stages of gameStateUpdate.
+enum TICK_STAGE
+{
+	TICK_SCRIPTS,           ///< eventProcessTriggers and updateScripts.
+	TICK_ABANDONED,         ///< handleAbandonedStructures.
+	TICK_GRID,              ///< gridReset.
+	TICK_VISIBILITY,        ///< processVisibility.
+	TICK_MAP,               ///< mapUpdate.
+	TICK_FPATH,             ///< fpathUpdate.
+	TICK_CLUSTER,           ///< clusterUpdate.
+	TICK_COMMANDERS,        ///< cmdDroidUpdate and driveUpdate.
+	TICK_CALLBACKS,         ///< fireWaitingCallbacks.
+	TICK_POWER,             ///< updatePlayerPower.
+	TICK_DROIDS,            ///< droidUpdate and missionDroidUpdate.
+	TICK_STRUCTURES,        ///< structureUpdate.
+	TICK_PROJECTILES,       ///< proj_UpdateAll.
+	TICK_FEATURES,          ///< featureUpdate.
+	TICK_OBJMEM,            ///< objmemUpdate.
+	TICK_STAGE_COUNT
+};
+
+#define TICK_PROFILE_HISTORY 600  ///< Number of ticks remembered, one minute of game time.
+
+/// Times and counts for a single game tick.
+struct TICK_PROFILE
+{
+	uint32_t gameTime;                         ///< Game time at the end of the tick.
+	uint32_t totalTime;                        ///< Microseconds spent in gameStateUpdate.
+	uint32_t stageTime[TICK_STAGE_COUNT];      ///< Microseconds spent in each stage.
+	uint32_t stageAllocs[TICK_STAGE_COUNT];    ///< Game objects allocated in each stage.
+	uint32_t droids, structures, features, projectiles;  ///< Number of objects at the end of the tick.
+};
+
+/// Number of game objects allocated so far. Incremented when constructing droids, structures, features and projectiles.
+extern uint32_t tickProfileAllocations;
+
+void tickProfileReset();                   ///< Forget all recorded ticks.
+void tickProfileBeginTick();               ///< Call at the start of gameStateUpdate.
+void tickProfileEndTick();                 ///< Call at the end of gameStateUpdate.
+void tickProfileBegin(TICK_STAGE stage);   ///< Start timing a stage. A stage may be timed several times per tick, which adds up.
+void tickProfileEnd(TICK_STAGE stage);     ///< Stop timing a stage.
+
+/// Times a stage for the rest of the current scope.
+class TickProfileScope
+{
+public:
+	TickProfileScope(TICK_STAGE stage_) : stage(stage_) { tickProfileBegin(stage); }
+	~TickProfileScope() { tickProfileEnd(stage); }
+
+private:
+	TICK_STAGE stage;
+};
+
+const char *tickProfileStageName(TICK_STAGE stage);
+/// Number of recorded ticks, at most TICK_PROFILE_HISTORY.
+unsigned tickProfileCount();
+/// Returns a recorded tick, 0 is the oldest.
+TICK_PROFILE const &tickProfileGet(unsigned index);
+
+/// Write all recorded ticks to a file, as JSON if the file name ends in ".json", otherwise as CSV.
+bool tickProfileDump(const char *fileName);
+/// File to dump to when a game ends, set from the command line. NULL to not dump.
+void tickProfileSetDumpFile(const char *fileName);
+const char *tickProfileGetDumpFile();
+
+#endif // __INCLUDED_SRC_TICKPROFILE_H__
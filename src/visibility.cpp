@@ -37,6 +37,7 @@
 #include "geometry.h"
 #include "hci.h"
 #include "mapgrid.h"
+#include "pointtree.h"
 #include "cluster.h"
 #include "research.h"
 #include "scriptextern.h"
@@ -47,6 +48,7 @@
 #include "multiplay.h"
 
 #include "wavecast.h"
+#include "parallel.h"
 
 // rate to change visibility level
 static const int VIS_LEVEL_INC = 255 * 2;
@@ -103,18 +105,19 @@ void visUpdateLevel(void)
 
 static inline void updateTileVis(MAPTILE *psTile)
 {
+	MAPTILE_VISION *psVision = mapTileVision(psTile);
 	int i;
 
 	for (i = 0; i < MAX_PLAYERS; i++)
 	{
 		/// The definition of whether a player can see something on a given tile or not
-		if (psTile->watchers[i] > 0 || (psTile->sensors[i] > 0 && !(psTile->jammerBits & ~alliancebits[i])))
+		if (psVision->watchers[i] > 0 || (psVision->sensors[i] > 0 && !(psVision->jammerBits & ~alliancebits[i])))
 		{
-			psTile->sensorBits |= (1 << i);         // mark it as being seen
+			psVision->sensorBits |= (1 << i);         // mark it as being seen
 		}
 		else
 		{
-			psTile->sensorBits &= ~(1 << i);        // mark as hidden
+			psVision->sensorBits &= ~(1 << i);        // mark as hidden
 		}
 	}
 }
@@ -134,8 +137,8 @@ uint32_t addSpotter(int x, int y, int player, int radius, bool radar, uint32_t e
 			continue;
 		}
 		MAPTILE *psTile = mapTile(mapX, mapY);
-		psTile->tileExploredBits |= alliancebits[player];
-		uint8_t *visionType = (!radar) ? psTile->watchers : psTile->sensors;
+		mapTileVision(psTile)->tileExploredBits |= alliancebits[player];
+		uint8_t *visionType = (!radar) ? mapTileVision(psTile)->watchers : mapTileVision(psTile)->sensors;
 		if (visionType[player] < UBYTE_MAX)
 		{
 			TILEPOS tilePos = {uint8_t(mapX), uint8_t(mapY), uint8_t(radar)};
@@ -203,7 +206,7 @@ SPOTTER::~SPOTTER()
 	{
 		const TILEPOS pos = watchedTiles[i];
 		MAPTILE *psTile = mapTile(pos.x, pos.y);
-		uint8_t *visionType = (pos.type == 0) ? psTile->watchers : psTile->sensors;
+		uint8_t *visionType = (pos.type == 0) ? mapTileVision(psTile)->watchers : mapTileVision(psTile)->sensors;
 		ASSERT(visionType[player] > 0, "Not watching watched tile (%d, %d)", (int)pos.x, (int)pos.y);
 		visionType[player]--;
 		updateTileVis(psTile);
@@ -222,7 +225,8 @@ static inline void visMarkTile(const BASE_OBJECT *psObj, int mapX, int mapY, MAP
 	const int ydiff = map_coord(psObj->pos.y) - mapY;
 	const int distSq = xdiff * xdiff + ydiff * ydiff;
 	const bool inRange = (distSq < 16);
-	uint8_t *visionType = inRange ? psTile->watchers : psTile->sensors;
+	MAPTILE_VISION *psVision = mapTileVision(psTile);
+	uint8_t *visionType = inRange ? psVision->watchers : psVision->sensors;
 
 	if (visionType[rayPlayer] < UBYTE_MAX && *lastRecordTilePos < MAX_SEEN_TILES)
 	{
@@ -231,8 +235,8 @@ static inline void visMarkTile(const BASE_OBJECT *psObj, int mapX, int mapY, MAP
 		visionType[rayPlayer]++;                        // we observe this tile
 		if (objJammerPower(psObj) > 0)                  // we are a jammer object
 		{
-			psTile->jammers[rayPlayer]++;
-			psTile->jammerBits |= (1 << rayPlayer); // mark it as being jammed
+			psVision->jammers[rayPlayer]++;
+			psVision->jammerBits |= (1 << rayPlayer); // mark it as being jammed
 		}
 		updateTileVis(psTile);
 		recordTilePos[*lastRecordTilePos] = tilePos;    // record having seen it
@@ -320,7 +324,7 @@ static void doWaveTerrain(const BASE_OBJECT *psObj, TILEPOS *recordTilePos, int
 		if (seen)
 		{
 			// Can see this tile.
-			psTile->tileExploredBits |= alliancebits[rayPlayer];                            // Share exploration with allies too
+			mapTileVision(psTile)->tileExploredBits |= alliancebits[rayPlayer];                            // Share exploration with allies too
 			visMarkTile(psObj, mapX, mapY, psTile, recordTilePos, lastRecordTilePos);   // Mark this tile as seen by our sensor
 		}
 	}
@@ -336,9 +340,10 @@ void visRemoveVisibility(BASE_OBJECT *psObj)
 			const TILEPOS pos = psObj->watchedTiles[i];
 			// FIXME: the mapTile might have been swapped out, see swapMissionPointers()
 			MAPTILE *psTile = mapTile(pos.x, pos.y);
+			MAPTILE_VISION *psVision = mapTileVision(psTile);
 
 			ASSERT(pos.type < 2, "Invalid visibility type %d", (int)pos.type);
-			uint8_t *visionType = (pos.type == 0) ? psTile->sensors : psTile->watchers;
+			uint8_t *visionType = (pos.type == 0) ? psVision->sensors : psVision->watchers;
 			if (visionType[psObj->player] == 0 && game.type == CAMPAIGN)	// hack
 			{
 				continue;
@@ -348,11 +353,11 @@ void visRemoveVisibility(BASE_OBJECT *psObj)
 			if (objJammerPower(psObj) > 0)                  // we are a jammer object
 			{
 				// No jammers in campaign, no need for special hack
-				ASSERT(psTile->jammers[psObj->player] > 0, "Not jamming watched tile (%d, %d)", (int)pos.x, (int)pos.y);
-				psTile->jammers[psObj->player]--;
-				if (psTile->jammers[psObj->player] == 0)
+				ASSERT(psVision->jammers[psObj->player] > 0, "Not jamming watched tile (%d, %d)", (int)pos.x, (int)pos.y);
+				psVision->jammers[psObj->player]--;
+				if (psVision->jammers[psObj->player] == 0)
 				{
-					psTile->jammerBits &= ~(1 << psObj->player);
+					psVision->jammerBits &= ~(1 << psObj->player);
 				}
 			}
 			updateTileVis(psTile);
@@ -416,7 +421,7 @@ void revealAll(UBYTE player)
 		for(j=0; j<mapHeight; j++)
 		{
 			psTile = mapTile(i,j);
-			psTile->tileExploredBits |= alliancebits[player];
+			mapTileVision(psTile)->tileExploredBits |= alliancebits[player];
 		}
 	}
 	
@@ -495,7 +500,8 @@ int visibleObject(const BASE_OBJECT* psViewer, const BASE_OBJECT* psTarget, bool
 	}
 
 	MAPTILE *psTile = mapTile(map_coord(psTarget->pos.x), map_coord(psTarget->pos.y));
-	bool jammed = psTile->jammerBits & ~alliancebits[psViewer->player];
+	const MAPTILE_VISION *psVision = mapTileVision(psTile);
+	bool jammed = psVision->jammerBits & ~alliancebits[psViewer->player];
 
 	// Special rule for VTOLs, as they are not affected by ECM
 	if (((psTarget->type == OBJ_DROID && isVtolDroid((DROID *)psTarget))
@@ -505,12 +511,12 @@ int visibleObject(const BASE_OBJECT* psViewer, const BASE_OBJECT* psTarget, bool
 		return UBYTE_MAX;
 	}
 	// Show objects hidden by ECM jamming with radar blips
-	else if (psTile->watchers[psViewer->player] == 0 && psTile->sensors[psViewer->player] > 0 && jammed)
+	else if (psVision->watchers[psViewer->player] == 0 && psVision->sensors[psViewer->player] > 0 && jammed)
 	{
 		return UBYTE_MAX / 2;
 	}
 	// Show objects that are seen directly or with unjammed sensors
-	else if (psTile->watchers[psViewer->player] > 0 || (psTile->sensors[psViewer->player] > 0 && !jammed))
+	else if (psVision->watchers[psViewer->player] > 0 || (psVision->sensors[psViewer->player] > 0 && !jammed))
 	{
 		return UBYTE_MAX;
 	}
@@ -568,6 +574,17 @@ bool hasSharedVision(unsigned viewer, unsigned ally)
 	return viewer == ally || (bMultiPlayer && alliancesSharedVision(game.alliance) && aiCheckAlliances(viewer, ally));
 }
 
+static std::vector<BASE_OBJECT *> visSeenStatics;  // Structures and features seen this tick, whose seenThisTick is reset at the end of processVisibility.
+
+static inline void raiseSeenThisTick(BASE_OBJECT *psObj, int player, int val)
+{
+	if (psObj->seenThisTick[player] == 0 && val > 0 && psObj->type != OBJ_DROID)
+	{
+		visSeenStatics.push_back(psObj);  // May be added once for each player, which doesn't matter.
+	}
+	psObj->seenThisTick[player] = MAX(psObj->seenThisTick[player], val);
+}
+
 static void setSeenBy(BASE_OBJECT *psObj, unsigned viewer, int val /*= UBYTE_MAX*/)
 {
 	//forward out vision to our allies
@@ -576,7 +593,7 @@ static void setSeenBy(BASE_OBJECT *psObj, unsigned viewer, int val /*= UBYTE_MAX
 	{
 		if (hasSharedVision(viewer, ally))
 		{
-			psObj->seenThisTick[ally] = MAX(psObj->seenThisTick[ally], val);
+			raiseSeenThisTick(psObj, ally, val);
 		}
 	}
 }
@@ -589,7 +606,7 @@ static void setSeenByInstantly(BASE_OBJECT *psObj, unsigned viewer, int val /*=
 	{
 		if (hasSharedVision(viewer, ally))
 		{
-			psObj->seenThisTick[ally] = MAX(psObj->seenThisTick[ally], val);
+			raiseSeenThisTick(psObj, ally, val);
 			psObj->visible[ally] = MAX(psObj->visible[ally], val);
 		}
 	}
@@ -636,36 +653,83 @@ static void processVisibilitySelf(BASE_OBJECT *psObj)
 	}
 }
 
-// Calculate which objects we can see. Better to call after processVisibilitySelf, since that check is cheaper.
-static void processVisibilityVision(BASE_OBJECT *psViewer)
+/// An object which a viewer can see, and how well.
+struct VisionResult
+{
+	BASE_OBJECT *psObj;
+	int val;
+};
+
+static std::vector<BASE_OBJECT *> visViewers;               // Objects to process vision for, in the order they must be applied.
+static std::vector<std::vector<VisionResult> > visResults;  // visResults[n] is what visViewers[n] can see.
+static GridQuery visGridQueries[PARALLEL_MAX_THREADS];
+
+// Find which objects psViewer can see. Doesn't change anything, so can be called for several viewers at once.
+static void processVisibilityVisionFind(BASE_OBJECT *psViewer, GridQuery &query, std::vector<VisionResult> &results)
 {
+	results.clear();
 	if (psViewer->type == OBJ_FEATURE)
 	{
 		return;
 	}
 
-	// get all the objects from the grid the droid is in
-	// Will give inconsistent results if hasSharedVision is not an equivalence relation.
-	static GridList gridList;  // static to avoid allocations.
-	gridList = gridStartIterateUnseen(psViewer->pos.x, psViewer->pos.y, objSensorRange(psViewer), psViewer->player);
+	GridList const &gridList = gridStartIterate(query, psViewer->pos.x, psViewer->pos.y, objSensorRange(psViewer));
 	for (GridIterator gi = gridList.begin(); gi != gridList.end(); ++gi)
 	{
 		BASE_OBJECT *psObj = *gi;
 
-		int val = visibleObject(psViewer, psObj, false);
+		// Already fully seen, so gridStartIterateUnseen would skip it. Nothing writes seenThisTick until all viewers are done.
+		if (psObj->seenThisTick[psViewer->player] == UINT8_MAX)
+		{
+			continue;
+		}
 
-		// If we've got ranged line of sight...
+		int val = visibleObject(psViewer, psObj, false);
 		if (val > 0)
 		{
-			// Tell system that this side can see this object
-			setSeenBy(psObj, psViewer->player, val);
+			VisionResult result = {psObj, val};
+			results.push_back(result);
+		}
+	}
+}
 
-			// This looks like some kind of weird hack.
-			if(psObj->type != OBJ_FEATURE && psObj->visible[psViewer->player] <= 0)
-			{
-				// features are not in the cluster system
-				clustObjectSeen(psObj, psViewer);
-			}
+static void processVisibilityVisionFindChunk(void *, unsigned begin, unsigned end, unsigned thread)
+{
+	for (unsigned n = begin; n < end; ++n)
+	{
+		processVisibilityVisionFind(visViewers[n], visGridQueries[thread], visResults[n]);
+	}
+}
+
+// Calculate which objects we can see. Better to call after processVisibilitySelf, since that check is cheaper.
+// Applies the results of processVisibilityVisionFind, giving the same results as looking at the objects from gridStartIterateUnseen one at a time.
+static void processVisibilityVision(BASE_OBJECT *psViewer, std::vector<VisionResult> &results)
+{
+	// Will give inconsistent results if hasSharedVision is not an equivalence relation.
+	// Drop objects which other viewers have fully seen by now, as gridStartIterateUnseen would have done when starting with this viewer.
+	std::vector<VisionResult>::iterator w = results.begin(), i;
+	for (i = w; i != results.end(); ++i)
+	{
+		if (i->psObj->seenThisTick[psViewer->player] < UINT8_MAX)
+		{
+			*w = *i;
+			++w;
+		}
+	}
+	results.erase(w, i);
+
+	for (i = results.begin(); i != results.end(); ++i)
+	{
+		BASE_OBJECT *psObj = i->psObj;
+
+		// Tell system that this side can see this object
+		setSeenBy(psObj, psViewer->player, i->val);
+
+		// This looks like some kind of weird hack.
+		if(psObj->type != OBJ_FEATURE && psObj->visible[psViewer->player] <= 0)
+		{
+			// features are not in the cluster system
+			clustObjectSeen(psObj, psViewer);
 		}
 	}
 }
@@ -751,8 +815,67 @@ static void processVisibilityLevel(BASE_OBJECT *psObj)
 	}
 }
 
+// Radar detectors see active radars as blips, from much further away than they can see anything else.
+static void processVisibilityRadarDetectors()
+{
+	static std::vector<BASE_OBJECT *> detectors;  // static to avoid allocations.
+	static PointTree radars;
+	static PointTree::ResultVector results;
+
+	detectors.clear();
+	for (BASE_OBJECT *psObj = apsSensorList[0]; psObj != NULL; psObj = psObj->psNextFunc)
+	{
+		if (objRadarDetector(psObj))
+		{
+			detectors.push_back(psObj);
+		}
+	}
+	if (detectors.empty())
+	{
+		return;  // Usually the case, so don't bother finding the radars.
+	}
+
+	radars.clear();
+	for (BASE_OBJECT *psTarget = apsSensorList[0]; psTarget != NULL; psTarget = psTarget->psNextFunc)
+	{
+		if (objActiveRadar(psTarget))
+		{
+			radars.insert(psTarget, psTarget->pos.x, psTarget->pos.y);
+		}
+	}
+	radars.sort();
+
+	// Only ever raises visible[] to UBYTE_MAX / 2, so the order doesn't matter.
+	for (unsigned n = 0; n < detectors.size(); ++n)
+	{
+		BASE_OBJECT *psObj = detectors[n];
+		int range = objSensorRange(psObj) * 10;
+		radars.query(results, psObj->pos.x, psObj->pos.y, range);
+		for (PointTree::ResultVector::const_iterator i = results.begin(); i != results.end(); ++i)
+		{
+			BASE_OBJECT *psTarget = static_cast<BASE_OBJECT *>(*i);
+			if (psObj != psTarget && psTarget->visible[psObj->player] < UBYTE_MAX / 2
+			    && iHypot(removeZ(psTarget->pos - psObj->pos)) < range)
+			{
+				psTarget->visible[psObj->player] = UBYTE_MAX / 2;
+			}
+		}
+	}
+}
+
 void processVisibility()
 {
+	// Structures and features were reset at the end of the last call, or are new, so only droids, which may have been moved between lists, need resetting.
+	for (int player = 0; player < MAX_PLAYERS; ++player)
+	{
+		for (DROID *psDroid = apsDroidLists[player]; psDroid != NULL; psDroid = psDroid->psNext)
+		{
+			if (!psDroid->died)
+			{
+				memset(psDroid->seenThisTick, 0, sizeof(psDroid->seenThisTick));
+			}
+		}
+	}
 	updateSpotters();
 	for (int player = 0; player < MAX_PLAYERS; ++player)
 	{
@@ -766,6 +889,9 @@ void processVisibility()
 			}
 		}
 	}
+
+	// Line of sight checks are the slow part, and only read the game state, so do them in parallel, then apply the results in order.
+	visViewers.clear();
 	for (int player = 0; player < MAX_PLAYERS; ++player)
 	{
 		BASE_OBJECT *lists[] = {apsDroidLists[player], apsStructLists[player]};
@@ -774,25 +900,20 @@ void processVisibility()
 		{
 			for (BASE_OBJECT *psObj = lists[list]; psObj != NULL; psObj = psObj->psNext)
 			{
-				processVisibilityVision(psObj);
+				visViewers.push_back(psObj);
 			}
 		}
 	}
-	for (BASE_OBJECT *psObj = apsSensorList[0]; psObj != NULL; psObj = psObj->psNextFunc)
+	if (visResults.size() < visViewers.size())
 	{
-		if (objRadarDetector(psObj))
-		{
-			for (BASE_OBJECT *psTarget = apsSensorList[0]; psTarget != NULL; psTarget = psTarget->psNextFunc)
-			{
-				if (psObj != psTarget && psTarget->visible[psObj->player] < UBYTE_MAX / 2
-				    && objActiveRadar(psTarget)
-				    && iHypot(removeZ(psTarget->pos - psObj->pos)) < objSensorRange(psObj) * 10)
-				{
-					psTarget->visible[psObj->player] = UBYTE_MAX / 2;
-				}
-			}
-		}
+		visResults.resize(visViewers.size());
+	}
+	parallelFor(visViewers.size(), 16, processVisibilityVisionFindChunk, NULL);
+	for (unsigned n = 0; n < visViewers.size(); ++n)
+	{
+		processVisibilityVision(visViewers[n], visResults[n]);
 	}
+	processVisibilityRadarDetectors();
 	for (int player = 0; player < MAX_PLAYERS; ++player)
 	{
 		BASE_OBJECT *lists[] = {apsDroidLists[player], apsStructLists[player], apsFeatureLists[player]};
@@ -805,6 +926,15 @@ void processVisibility()
 			}
 		}
 	}
+
+	// Nothing else reads seenThisTick, and nothing is freed during processVisibility, so the pointers are still valid.
+	for (unsigned n = 0; n < visSeenStatics.size(); ++n)
+	{
+		memset(visSeenStatics[n]->seenThisTick, 0, sizeof(visSeenStatics[n]->seenThisTick));
+	}
+	visSeenStatics.clear();
+
+	aiInvalidateTargetCandidates();  // Which objects players can fully see has changed.
 }
 
 void	setUnderTilesVis(BASE_OBJECT *psObj,UDWORD player)
@@ -842,7 +972,7 @@ MAPTILE		*psTile;
 			psTile = mapTile(mapX+i,mapY+j);
 			if (psTile)
 			{
-				psTile->tileExploredBits |= alliancebits[player];
+				mapTileVision(psTile)->tileExploredBits |= alliancebits[player];
 			}
 		}
 	}
@@ -51,6 +51,8 @@ struct WARZONE_GLOBALS
 	UDWORD		height;
 	int8_t		SPcolor;
 	int			MPcolour;
+	int			pathfindThreads;
+	int			workerThreads;
 	FSAA_LEVEL  fsaa;
 	bool		Fullscreen;
 	bool		soundEnabled;
@@ -90,6 +92,8 @@ void war_SetDefaultStates(void)//Sets all states
 	war_SetMusicEnabled(true);
 	war_SetSPcolor(0);		//default color is green
 	war_setMPcolour(-1);            // Default color is random.
+	war_setPathfindThreads(0);      // Default is to pick from the number of cores.
+	war_setWorkerThreads(0);        // Default is to pick from the number of cores.
 }
 
 void war_SetSPcolor(int color)
@@ -117,6 +121,26 @@ int war_getMPcolour()
 	return warGlobs.MPcolour;
 }
 
+void war_setPathfindThreads(int threads)
+{
+	warGlobs.pathfindThreads = threads;
+}
+
+int war_getPathfindThreads()
+{
+	return warGlobs.pathfindThreads;
+}
+
+void war_setWorkerThreads(int threads)
+{
+	warGlobs.workerThreads = threads;
+}
+
+int war_getWorkerThreads()
+{
+	return warGlobs.workerThreads;
+}
+
 void war_setFullscreen(bool b)
 {
 	warGlobs.Fullscreen = b;
@@ -81,6 +81,10 @@ void war_setMPcolour(int colour);
 int war_getMPcolour();
 void war_setScanlineMode(SCANLINE_MODE mode);
 SCANLINE_MODE war_getScanlineMode(void);
+void war_setPathfindThreads(int threads);
+int war_getPathfindThreads();
+void war_setWorkerThreads(int threads);
+int war_getWorkerThreads();
 
 /**
  * Enable or disable sound initialization
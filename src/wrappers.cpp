@@ -34,6 +34,7 @@
 #include "lib/sound/audio.h"
 #include "lib/framework/wzapp.h"
 
+#include "benchmark.h"
 #include "frontend.h"
 #include "keyedit.h"
 #include "keymap.h"
@@ -41,6 +42,7 @@
 #include "multiint.h"
 #include "multilimit.h"
 #include "multistat.h"
+#include "replay.h"
 #include "warzoneconfig.h"
 #include "wrappers.h"
 
@@ -153,6 +155,22 @@ TITLECODE titleLoop(void)
 			NETinit(true);
 			joinGame(iptoconnect, 0);
 		}
+		else if (benchmarkWantsSkirmish())
+		{
+			if (!benchmarkStartSkirmish())
+			{
+				debug(LOG_FATAL, "Could not start the benchmark.");
+				exit(EXIT_FAILURE);
+			}
+		}
+		else if (replayGetPlaybackFile() != NULL)
+		{
+			if (!replayStartPlayback())
+			{
+				debug(LOG_FATAL, "Could not play back \"%s\".", replayGetPlaybackFile());
+				exit(EXIT_FAILURE);
+			}
+		}
 		else
 		{
 			changeTitleMode(TITLE);			// normal game, run main title screen.
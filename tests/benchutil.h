@@ -0,0 +1,53 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2013  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Helpers shared by the benchmark programs in tests/.
+ */
+
+#ifndef __INCLUDED_BENCHUTIL_H__
+#define __INCLUDED_BENCHUTIL_H__
+
+#include <stdio.h>
+#include <time.h>
+#include <algorithm>
+
+/// State of nextRandom(). Set it before a run, so that every run does the same work.
+static uint32_t randomState = 12345;
+
+/// Same generator on every platform, unlike rand().
+static inline uint32_t nextRandom()
+{
+	randomState = randomState*1103515245 + 12345;
+	return randomState >> 16;
+}
+
+static inline double elapsedSeconds(clock_t start)
+{
+	return double(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/// Prints "<bench>: <what> in <seconds> s (<ns> ns/<unit>)" and returns the nanoseconds for each of count units.
+static inline double reportTime(char const *bench, char const *what, double seconds, uint64_t count, char const *unit)
+{
+	double ns = seconds*1e9/std::max<uint64_t>(count, 1);
+	printf("%s: %s in %.3f s (%.1f ns/%s)\n", bench, what, seconds, ns, unit);
+	return ns;
+}
+
+#endif // __INCLUDED_BENCHUTIL_H__
@@ -0,0 +1,195 @@
+#include "lib/framework/wzglobal.h"
+#include "lib/framework/types.h"
+#include "lib/framework/frame.h"
+#include "lib/netplay/netqueue.h"
+#include "benchutil.h"
+
+// --- dummy rendering library implementation ----
+
+void wzToggleFullscreen()
+{
+}
+
+bool wzIsFullscreen()
+{
+	return false;
+}
+
+void wzFatalDialog(char const*)
+{
+}
+
+int wzGetTicks()
+{
+	return 1;
+}
+
+void inputInitialise()
+{
+}
+
+// --- end linking hacks ---
+
+// Pushes messages through a sending and a receiving NetQueue, the way a game queue is flushed over the network and read back by the other clients.
+// Message sizes follow a game: mostly droid orders and sync messages of a few dozen bytes, with the occasional large message, such as a file chunk.
+
+static const unsigned numTicks = 20000;
+static const unsigned maxMessagesPerTick = 64;
+
+static unsigned messageSize()
+{
+	uint32_t r = nextRandom() % 1000;
+	if (r == 0)
+	{
+		return 4096;          // File chunk.
+	}
+	if (r < 50)
+	{
+		return 200 + r*4;     // Research and structure lists.
+	}
+	return 8 + r % 56;        // Orders and sync messages.
+}
+
+// Every message in checkBothCursors is different, so a slot which is reused too early is noticed when its message is read.
+static NetMessage checkMessage(unsigned seq)
+{
+	NetMessage message(seq % 200);
+	MessageWriter writer(message);
+	for (unsigned i = 0; i < 4; ++i)
+	{
+		writer.byte(seq >> i*8);
+	}
+	unsigned size = seq % 97 == 0 ? 66000 : seq % 61;  // Sometimes bigger than the slots keep, so popOldMessages releases it.
+	for (unsigned i = 0; i < size; ++i)
+	{
+		writer.byte(seq + i);
+	}
+	return message;
+}
+
+static bool isCheckMessage(NetMessage const &message, unsigned seq)
+{
+	NetMessage expected = checkMessage(seq);
+	return message.type == expected.type && message.data == expected.data;
+}
+
+// A client's own game queue is both read by the game and sent over the network, so a message may only be recycled once both cursors
+// have passed it. Moves the two cursors independently, so that either can be far behind the other, and checks every message read.
+static bool checkBothCursors()
+{
+	NetQueue queue;
+	unsigned pushed = 0, gameRead = 0, netRead = 0;
+	for (unsigned step = 0; step < 20000; ++step)
+	{
+		unsigned burst = nextRandom() % 32;
+		switch (nextRandom() % 3)
+		{
+			case 0:
+				for (unsigned n = 0; n < burst && pushed - std::min(gameRead, netRead) < 2000; ++n)
+				{
+					queue.pushMessage(checkMessage(pushed++));
+				}
+				break;
+			case 1:
+				for (unsigned n = 0; n < burst && queue.haveMessage(); ++n)
+				{
+					if (!isCheckMessage(queue.getMessage(), gameRead++))
+					{
+						return false;
+					}
+					queue.popMessage();
+				}
+				break;
+			case 2:
+				for (unsigned n = 0; n < burst && queue.numMessagesForNet() != 0; ++n)
+				{
+					if (!isCheckMessage(queue.getMessageForNet(), netRead++))
+					{
+						return false;
+					}
+					queue.popMessageForNet();
+				}
+				break;
+		}
+	}
+	return true;
+}
+
+int main(void)
+{
+	NetQueuePair pair;
+	NetQueue gameQueue;
+	gameQueue.setWillNeverGetMessages();
+	NetMessage message;
+	std::vector<uint8_t> wire;
+	uint64_t messages = 0, bytes = 0;
+	uint32_t checksumSent = 0, checksumReceived = 0;
+
+	clock_t start = clock();
+	for (unsigned tick = 0; tick < numTicks; ++tick)
+	{
+		// Serialise this tick's messages.
+		unsigned count = nextRandom() % maxMessagesPerTick;
+		for (unsigned n = 0; n < count; ++n)
+		{
+			message = NetMessage(n % 200);
+			MessageWriter writer(message);
+			unsigned size = messageSize();
+			for (unsigned i = 0; i < size; ++i)
+			{
+				writer.byte(tick + i);
+			}
+			checksumSent = checksumSent*31 + message.type + size;
+			gameQueue.pushMessage(message);
+			bytes += size;
+		}
+		messages += count;
+
+		// Flush to the network.
+		wire.clear();
+		while (gameQueue.numMessagesForNet() != 0)
+		{
+			gameQueue.getMessageForNet().rawDataAppendToVector(wire);
+			gameQueue.popMessageForNet();
+		}
+
+		// Receive in two pieces, so that messages get split between calls.
+		size_t half = wire.size()/2;
+		if (!wire.empty())
+		{
+			pair.receive.writeRawData(&wire[0], half);
+			pair.receive.writeRawData(&wire[half], wire.size() - half);
+		}
+
+		// Deserialise.
+		while (pair.receive.haveMessage())
+		{
+			const NetMessage &received = pair.receive.getMessage();
+			checksumReceived = checksumReceived*31 + received.type + received.data.size();
+			if (!received.data.empty() && received.data[0] != uint8_t(tick))
+			{
+				fprintf(stderr, "netqueuebench: Message contents corrupted.\n");
+				return 1;
+			}
+			pair.receive.popMessage();
+		}
+	}
+	double seconds = elapsedSeconds(start);
+
+	if (checksumSent != checksumReceived)
+	{
+		fprintf(stderr, "netqueuebench: Received messages do not match sent messages.\n");
+		return 1;
+	}
+
+	if (!checkBothCursors())
+	{
+		fprintf(stderr, "netqueuebench: Message recycled before both the game and the network had read it.\n");
+		return 1;
+	}
+
+	char what[100];
+	snprintf(what, sizeof(what), "%llu messages, %llu bytes", (unsigned long long)messages, (unsigned long long)bytes);
+	reportTime("netqueuebench", what, seconds, messages, "message");
+	return 0;
+}
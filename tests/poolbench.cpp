@@ -0,0 +1,216 @@
+#include "lib/framework/wzglobal.h"
+#include "lib/framework/types.h"
+#include "lib/framework/frame.h"
+#include "lib/framework/objectpool.h"
+#include "benchutil.h"
+
+#include <string.h>
+
+// --- dummy rendering library implementation ----
+
+void wzToggleFullscreen()
+{
+}
+
+bool wzIsFullscreen()
+{
+	return false;
+}
+
+void wzFatalDialog(char const*)
+{
+}
+
+int wzGetTicks()
+{
+	return 1;
+}
+
+void inputInitialise()
+{
+}
+
+// --- end linking hacks ---
+
+// Creates and destroys objects the way a battle does, with the system allocator and with an ObjectPool.
+// Most of the churn is short lived projectiles, with droids dying and being replaced now and then, while structures and features stay.
+
+static const unsigned numTicks = 20000;
+static const unsigned maxLive = 4000;
+
+struct Projectile
+{
+	uint32_t id;
+	char data[156];
+};
+
+struct Droid
+{
+	uint32_t id;
+	char data[1020];
+};
+
+struct PooledProjectile : public Projectile
+{
+	static void *operator new(size_t size);
+	static void operator delete(void *object);
+};
+
+struct PooledDroid : public Droid
+{
+	static void *operator new(size_t size);
+	static void operator delete(void *object);
+};
+
+static ObjectPool projectilePool("projectiles", sizeof(PooledProjectile), 1024);
+static ObjectPool droidPool("droids", sizeof(PooledDroid));
+
+void *PooledProjectile::operator new(size_t size) { return projectilePool.allocate(size); }
+void PooledProjectile::operator delete(void *object) { projectilePool.free(object); }
+void *PooledDroid::operator new(size_t size) { return droidPool.allocate(size); }
+void PooledDroid::operator delete(void *object) { droidPool.free(object); }
+
+/// Runs the battle, returning false if an object was overwritten while alive.
+template <typename PROJ, typename DROID>
+static bool battle(char const *name, double *nsPerObject)
+{
+	static PROJ *projectiles[maxLive];
+	static DROID *droids[maxLive/8];
+	const unsigned numDroids = maxLive/8;
+	uint64_t objects = 0;
+	bool ok = true;
+
+	randomState = 12345;
+	memset(projectiles, 0, sizeof(projectiles));
+	memset(droids, 0, sizeof(droids));
+
+	clock_t start = clock();
+	for (unsigned tick = 0; tick < numTicks; ++tick)
+	{
+		// Fire and detonate.
+		for (unsigned n = 0; n < 64; ++n)
+		{
+			unsigned slot = nextRandom() % maxLive;
+			if (projectiles[slot] != NULL)
+			{
+				ok = ok && projectiles[slot]->id == slot;
+				delete projectiles[slot];
+				projectiles[slot] = NULL;
+			}
+			else
+			{
+				projectiles[slot] = new PROJ;
+				projectiles[slot]->id = slot;
+				projectiles[slot]->data[0] = tick;
+				++objects;
+			}
+		}
+
+		// Kill a droid and build a new one.
+		unsigned slot = nextRandom() % numDroids;
+		if (droids[slot] != NULL)
+		{
+			ok = ok && droids[slot]->id == slot;
+			delete droids[slot];
+		}
+		droids[slot] = new DROID;
+		droids[slot]->id = slot;
+		droids[slot]->data[0] = tick;
+		++objects;
+	}
+	for (unsigned n = 0; n < maxLive; ++n)
+	{
+		ok = ok && (projectiles[n] == NULL || projectiles[n]->id == n);
+		delete projectiles[n];
+	}
+	for (unsigned n = 0; n < numDroids; ++n)
+	{
+		ok = ok && (droids[n] == NULL || droids[n]->id == n);
+		delete droids[n];
+	}
+	double seconds = elapsedSeconds(start);
+
+	char what[100];
+	snprintf(what, sizeof(what), "%-6s %llu objects created and destroyed", name, (unsigned long long)objects);
+	*nsPerObject = reportTime("poolbench", what, seconds, objects, "object");
+	return ok;
+}
+
+struct PooledShell
+{
+	uint32_t id;
+	char data[60];
+
+	static void *operator new(size_t size);
+	static void operator delete(void *object);
+};
+
+/// A class derived from a pooled one, without a pool of its own, so too big for the pool's slots.
+struct PooledBigShell : public PooledShell
+{
+	char more[256];
+};
+
+static ObjectPool shellPool("shells", sizeof(PooledShell), 4);
+
+void *PooledShell::operator new(size_t size) { return shellPool.allocate(size); }
+void PooledShell::operator delete(void *object) { shellPool.free(object); }
+
+/// Returns false if an object too big for its pool did not get all the memory it asked for.
+static bool oversizedObject()
+{
+	bool wasEnabled = assertEnabled;
+	assertEnabled = false;  // The pool asserts, since this is a bug, but must not crash in release builds.
+
+	PooledBigShell *big = new PooledBigShell;
+	memset(big->more, 0xAA, sizeof(big->more));
+	PooledShell *shells[4];
+	for (unsigned n = 0; n < ARRAY_SIZE(shells); ++n)
+	{
+		shells[n] = new PooledShell;
+		shells[n]->id = n;
+	}
+	bool ok = shellPool.liveCount() == 1 + ARRAY_SIZE(shells);
+	for (unsigned n = 0; n < sizeof(big->more); ++n)
+	{
+		ok = ok && big->more[n] == char(0xAA);
+	}
+	delete big;
+	for (unsigned n = 0; n < ARRAY_SIZE(shells); ++n)
+	{
+		ok = ok && shells[n]->id == n;
+		delete shells[n];
+	}
+
+	assertEnabled = wasEnabled;
+	return ok;
+}
+
+int main(void)
+{
+	double systemTime, poolTime;
+	bool ok = battle<Projectile, Droid>("system", &systemTime);
+	ok = battle<PooledProjectile, PooledDroid>("pool", &poolTime) && ok;
+	if (!ok)
+	{
+		fprintf(stderr, "poolbench: Objects were overwritten while alive.\n");
+		return 1;
+	}
+	if (!oversizedObject())
+	{
+		fprintf(stderr, "poolbench: Object too big for its pool was not allocated correctly.\n");
+		return 1;
+	}
+
+	for (ObjectPool *pool = ObjectPool::first(); pool != NULL; pool = pool->next())
+	{
+		printf("poolbench: %-12s %6u live  %6u peak  %6u slots\n", pool->name(), pool->liveCount(), pool->peakCount(), pool->capacity());
+		if (pool->liveCount() != 0)
+		{
+			fprintf(stderr, "poolbench: Objects leaked from the %s pool.\n", pool->name());
+			return 1;
+		}
+	}
+	printf("poolbench: pool is %.2fx the speed of the system allocator\n", systemTime/std::max(poolTime, 1e-3));
+	return 0;
+}
@@ -0,0 +1,261 @@
+#include "lib/framework/wzglobal.h"
+#include "lib/framework/types.h"
+#include "lib/framework/frame.h"
+#include "lib/framework/wzconfig.h"
+#include "lib/framework/wzfs.h"
+#include "lib/framework/wzapp.h"
+
+#include "src/console.h" // HACK
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+// --- console dummy implementations, as in ivis_linktest ---
+
+#define MAX_CONSOLE_TMP_STRING_LENGTH	(255)
+char ConsoleString[MAX_CONSOLE_TMP_STRING_LENGTH];
+
+bool addConsoleMessage(const char *Text, CONSOLE_TEXT_JUSTIFICATION jusType, SDWORD player)
+{
+	return true;
+}
+
+// --- misc dummy implementations ---
+
+UDWORD realTime; // from gtime
+
+bool bMultiPlayer; // FIXME, really should not access this from ivis lib
+
+void addDumpInfo(const char *inbuffer)
+{
+}
+
+void mainLoop(void)
+{
+}
+
+// --- end linking hacks ---
+
+// Checks that the binary and the compressed binary formats load exactly what the INI format does, using a few objects with the same keys
+// as droid.ini. With --bench, also compares saving and loading a late game sized savegame file in each format, and writing it compressed
+// in the background. Links the backend library for its thread support, which the background writer uses.
+
+class PhysicsEngineHandler : public QAbstractFileEngineHandler
+{
+public:
+	QAbstractFileEngine *create(const QString &fileName) const
+	{
+		if (fileName.toLower().startsWith("wz::"))
+		{
+			QString newPath = fileName;
+			return new PhysicsFileSystem(newPath.remove(0, 4));
+		}
+		return NULL;
+	}
+};
+
+static const int checkObjects = 50;
+static const int benchObjects = 8*600;  // 8 players with 600 objects each.
+
+static const char *intKeys[] = {"id", "player", "health", "born", "experience", "order", "action", "secondaryOrder", "moveStatus", "pathIndex", "ammo/0", "lastFired/0"};
+static const char *stringKeys[] = {"name", "body", "propulsion", "weapon/1"};
+static const char *vector3iKeys[] = {"position", "rotation"};
+static const char *vector2iKeys[] = {"orderPosition", "actionPosition", "moveDestination", "pathNode/0", "pathNode/1", "pathNode/2", "pathNode/3", "pathNode/4", "pathNode/5", "pathNode/6", "pathNode/7"};
+
+static void writeObjects(const char *fileName, WzConfig::fileFormat format, int numObjects)
+{
+	WzConfig ini(fileName, WzConfig::ReadAndWrite, format);
+	for (int i = 0; i < numObjects; ++i)
+	{
+		ini.beginGroup("droid_" + QString("%1").arg(i, 10, 10, QLatin1Char('0')));
+		ini.setValue("id", 10000 + i);
+		ini.setValue("player", i % 8);
+		ini.setValue("name", "Heavy Cannon Python Tracks");
+		ini.setVector3i("position", Vector3i(i*37 % 16384, i*91 % 16384, 256));
+		ini.setVector3i("rotation", Vector3i(i % 65536, 0, -i));
+		ini.setValue("health", 1200 - i % 100);
+		ini.setValue("born", 100000 + i);
+		ini.setValue("experience", i*3);
+		ini.setValue("order", 2);
+		ini.setVector2i("orderPosition", Vector2i(i % 128, i % 64));
+		ini.setValue("action", 1);
+		ini.setVector2i("actionPosition", Vector2i(i % 128, i % 64));
+		ini.setValue("secondaryOrder", 0x2403);
+		ini.setValue("moveStatus", 1);
+		ini.setValue("pathIndex", 3);
+		for (int n = 0; n < 8; ++n)
+		{
+			ini.setVector2i("pathNode/" + QString::number(n), Vector2i(n*128, -n*256));
+		}
+		ini.setVector2i("moveDestination", Vector2i(i % 4096, i % 2048));
+		ini.setValue("body", "Python");
+		ini.setValue("propulsion", "tracked01");
+		ini.setValue("weapon/1", "Cannon375mmMk1");
+		ini.setValue("ammo/0", 1);
+		ini.setValue("lastFired/0", 99000 + i);
+		ini.setValue("onMission", i % 2 == 0);
+		ini.endGroup();
+	}
+}
+
+/// Returns one line per object, with all of its values, read the way the game reads them.
+static QStringList readObjects(const char *fileName)
+{
+	WzConfig ini(fileName, WzConfig::ReadOnly);
+	QStringList groups = ini.childGroups();
+	QStringList objects;
+	for (int i = 0; i < groups.size(); ++i)
+	{
+		ini.beginGroup(groups[i]);
+		QString line = groups[i];
+		for (unsigned n = 0; n < ARRAY_SIZE(intKeys); ++n)
+		{
+			line += QString(" %1=%2").arg(intKeys[n]).arg(ini.value(intKeys[n]).toInt());
+		}
+		for (unsigned n = 0; n < ARRAY_SIZE(stringKeys); ++n)
+		{
+			line += QString(" %1=%2").arg(stringKeys[n]).arg(ini.value(stringKeys[n]).toString());
+		}
+		for (unsigned n = 0; n < ARRAY_SIZE(vector3iKeys); ++n)
+		{
+			Vector3i v = ini.vector3i(vector3iKeys[n]);
+			line += QString(" %1=%2,%3,%4").arg(vector3iKeys[n]).arg(v.x).arg(v.y).arg(v.z);
+		}
+		for (unsigned n = 0; n < ARRAY_SIZE(vector2iKeys); ++n)
+		{
+			Vector2i v = ini.vector2i(vector2iKeys[n]);
+			line += QString(" %1=%2,%3").arg(vector2iKeys[n]).arg(v.x).arg(v.y);
+		}
+		line += QString(" onMission=%1").arg(ini.value("onMission").toBool());
+		objects.push_back(line);
+		ini.endGroup();
+	}
+	return objects;
+}
+
+static long long fileSize(const char *fileName)
+{
+	long long size = -1;
+	PHYSFS_file *fileHandle = PHYSFS_openRead(fileName);
+	if (fileHandle != NULL)
+	{
+		size = PHYSFS_fileLength(fileHandle);
+		PHYSFS_close(fileHandle);
+	}
+	return size;
+}
+
+static void benchmark(const char *name, const char *fileName, WzConfig::fileFormat format)
+{
+	QElapsedTimer timer;
+	timer.start();
+	writeObjects(fileName, format, benchObjects);
+	qint64 saveTime = timer.restart();  // Time the main loop would pause for.
+	WzConfig::waitForBackgroundWrites();
+	qint64 backgroundTime = timer.restart();
+	readObjects(fileName);
+	qint64 loadTime = timer.elapsed();
+
+	printf("savebench: %-10s save %5lld ms (+%5lld ms in background), load %5lld ms, %8lld bytes\n", name, (long long)saveTime, (long long)backgroundTime, (long long)loadTime, fileSize(fileName));
+}
+
+static bool checkRoundTrip()
+{
+	writeObjects("savebench.ini", WzConfig::IniFile, checkObjects);
+	writeObjects("savebench.wzb", WzConfig::BinaryFile, checkObjects);
+	writeObjects("savebench.wzz", WzConfig::BinaryFileInBackground, checkObjects);
+	if (!WzConfig::waitForBackgroundWrites())
+	{
+		fprintf(stderr, "savebench: Could not write the compressed binary file.\n");
+		return false;
+	}
+
+	QStringList ini = readObjects("savebench.ini");
+	if (ini.size() != checkObjects)
+	{
+		fprintf(stderr, "savebench: Read %d objects from the INI file, wrote %d.\n", ini.size(), checkObjects);
+		return false;
+	}
+	const char *binaryFiles[] = {"savebench.wzb", "savebench.wzz"};
+	for (unsigned n = 0; n < ARRAY_SIZE(binaryFiles); ++n)
+	{
+		QStringList binary = readObjects(binaryFiles[n]);
+		for (int i = 0; i < std::max(ini.size(), binary.size()); ++i)
+		{
+			QString a = i < ini.size()? ini[i] : QString("(missing)");
+			QString b = i < binary.size()? binary[i] : QString("(missing)");
+			if (a != b)
+			{
+				fprintf(stderr, "savebench: %s differs from the INI file:\n  ini:    %s\n  binary: %s\n", binaryFiles[n], a.toUtf8().constData(), b.toUtf8().constData());
+				return false;
+			}
+		}
+	}
+	printf("savebench: %d objects load the same from INI, binary and compressed binary files\n", checkObjects);
+	return true;
+}
+
+static bool checkBackgroundFiles()
+{
+	QByteArray data("raw savebench data");
+	WzConfig::saveFileInBackground("savebench.raw", data);
+	WzConfig::saveFileInBackground("savebench-missing/savebench.raw", data);  // The directory does not exist, so this fails.
+	if (WzConfig::waitForBackgroundWrites())
+	{
+		fprintf(stderr, "savebench: A failed background write was not reported.\n");
+		return false;
+	}
+	if (!WzConfig::waitForBackgroundWrites())
+	{
+		fprintf(stderr, "savebench: A failed background write was reported twice.\n");
+		return false;
+	}
+
+	QByteArray read;
+	PHYSFS_file *fileHandle = PHYSFS_openRead("savebench.raw");
+	if (fileHandle != NULL)
+	{
+		read.resize(PHYSFS_fileLength(fileHandle));
+		if (PHYSFS_read(fileHandle, read.data(), read.size(), 1) != 1)
+		{
+			read.clear();
+		}
+		PHYSFS_close(fileHandle);
+	}
+	if (read != data)
+	{
+		fprintf(stderr, "savebench: The background file holds \"%s\", wrote \"%s\".\n", read.constData(), data.constData());
+		return false;
+	}
+	printf("savebench: Background files are written as is, and failures are reported once\n");
+	return true;
+}
+
+int realmain(int argc, char **argv)
+{
+	QCoreApplication app(argc, argv);
+	PhysicsEngineHandler engine;
+
+	PHYSFS_init(argv[0]);
+	PHYSFS_setWriteDir(".");
+	PHYSFS_addToSearchPath(".", 1);
+
+	bool ok = checkRoundTrip() && checkBackgroundFiles();
+	if (ok && argc > 1 && strcmp(argv[1], "--bench") == 0)
+	{
+		benchmark("ini", "savebench.ini", WzConfig::IniFile);
+		benchmark("binary", "savebench.wzb", WzConfig::BinaryFile);
+		benchmark("background", "savebench.wzz", WzConfig::BinaryFileInBackground);
+	}
+	WzConfig::shutdownBackgroundWrites();
+
+	PHYSFS_delete("savebench.raw");
+	PHYSFS_delete("savebench.ini");
+	PHYSFS_delete("savebench.wzb");
+	PHYSFS_delete("savebench.wzz");
+	PHYSFS_deinit();
+	return ok? 0 : 1;
+}
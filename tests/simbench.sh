@@ -0,0 +1,83 @@
+#!/bin/sh
+# Runs the scenarios in $SIMBENCH_SCENARIOS (default simbench/) without rendering, as fast as possible, and writes a JSON report for each to $SIMBENCH_OUTPUT.
+# Fails if a scenario runs slower than its MinTicksPerSecond, has fewer objects than its MinObjects, or the game fails.
+# If $SIMBENCH_BASELINE names a directory of reports from an earlier run, also fails if the ticks per second of any scenario dropped
+# by more than $SIMBENCH_THRESHOLD percent.
+
+srcdir=${srcdir:-.}
+top_srcdir=${top_srcdir:-$srcdir/..}
+top_builddir=${top_builddir:-..}
+SIMBENCH_SCENARIOS=${SIMBENCH_SCENARIOS:-$srcdir/simbench}
+SIMBENCH_OUTPUT=${SIMBENCH_OUTPUT:-simbench-results}
+SIMBENCH_THRESHOLD=${SIMBENCH_THRESHOLD:-15}
+
+game="$top_builddir/src/warzone2100"
+if [ ! -x "$game" ]; then
+	echo "simbench: $game not built, skipping."
+	exit 77
+fi
+
+mkdir -p "$SIMBENCH_OUTPUT" "$SIMBENCH_OUTPUT/config" || exit 1
+
+# Reads a numeric value from a report, which has one key per line.
+value() {
+	sed -n "s/^\"$2\": *\([-0-9.]*\),*$/\1/p" "$1"
+}
+
+# Succeeds if $1 is a non-negative number, with at most one decimal point.
+isNumber() {
+	case $1 in
+		''|.|*[!0-9.]*|*.*.*) return 1 ;;
+	esac
+	return 0
+}
+
+status=0
+for scenario in "$SIMBENCH_SCENARIOS"/*.ini; do
+	name=$(basename "$scenario" .ini)
+	report="$SIMBENCH_OUTPUT/$name.json"
+	rm -f "$report"
+
+	"$game" --headless=fast --nosound --datadir="$top_builddir/data" --configdir="$SIMBENCH_OUTPUT/config" \
+		--benchmark="$scenario" --benchmark-report="$report" > "$SIMBENCH_OUTPUT/$name.log" 2>&1
+	if [ ! -f "$report" ]; then
+		echo "simbench: $name: FAILED, no report, see $SIMBENCH_OUTPUT/$name.log"
+		status=1
+		continue
+	fi
+
+	tps=$(value "$report" ticksPerSecond)
+	minTps=$(value "$report" minTicksPerSecond)
+	objects=$(value "$report" warmupObjects)
+	minObjects=$(value "$report" minObjects)
+	rss=$(value "$report" peakRSSKiB)
+	if ! isNumber "$tps" || ! isNumber "$minTps" || ! isNumber "$objects" || ! isNumber "$minObjects"; then
+		echo "simbench: $name: FAILED, malformed report $report"
+		status=1
+		continue
+	fi
+	echo "simbench: $name: $tps ticks/s (want $minTps), $objects objects, peak RSS $rss KiB"
+
+	if awk -v tps="$tps" -v minTps="$minTps" 'BEGIN { exit !(tps < minTps) }'; then
+		echo "simbench: $name: FAILED, $tps ticks/s is below the floor of $minTps ticks/s"
+		status=1
+	fi
+	if awk -v objects="$objects" -v minObjects="$minObjects" 'BEGIN { exit !(objects < minObjects) }'; then
+		echo "simbench: $name: FAILED, only $objects objects after warmup, want $minObjects"
+		status=1
+	fi
+
+	baseline="$SIMBENCH_BASELINE/$name.json"
+	if [ -n "$SIMBENCH_BASELINE" ] && [ -f "$baseline" ]; then
+		old=$(value "$baseline" ticksPerSecond)
+		if ! isNumber "$old"; then
+			echo "simbench: $name: FAILED, malformed baseline $baseline"
+			status=1
+		elif awk -v new="$tps" -v old="$old" -v threshold="$SIMBENCH_THRESHOLD" 'BEGIN { exit !(new < old*(1 - threshold/100)) }'; then
+			echo "simbench: $name: FAILED, $tps ticks/s is more than $SIMBENCH_THRESHOLD% below the baseline $old ticks/s"
+			status=1
+		fi
+	fi
+done
+
+exit $status